@@ -41,29 +41,44 @@ public class AssetMetaExplorerBridge : ModuleRules
             Path.Combine(ModuleDirectory, "Private", "ThirdParty", "LibWebP", "include")
         });
 
-        PublicAdditionalLibraries.AddRange(new string[]
-        {
-            Path.Combine(ModuleDirectory, "Private", "ThirdParty", "LibWebP", "lib", "libwebp.lib"),
-            Path.Combine(ModuleDirectory, "Private", "ThirdParty", "LibWebP", "lib", "libwebpmux.lib"),
-            Path.Combine(ModuleDirectory, "Private", "ThirdParty", "LibWebP", "lib", "libwebpdemux.lib")
-        });
-
-        // BLAKE3: We only need a stable hash, not maximum SIMD throughput.
-        // The bundled sources currently include the portable implementation but not
-        // the optional SIMD translation units (sse2/sse41/avx2/avx512). On MSVC this
-        // can lead to unresolved externals from blake3_dispatch.c.
-        // Force the portable path by disabling SIMD dispatch.
+        string WebPLibDir = Path.Combine(ModuleDirectory, "Private", "ThirdParty", "LibWebP", "lib");
         if (Target.Platform == UnrealTargetPlatform.Win64)
         {
-            PrivateDefinitions.AddRange(new string[]
+            PublicAdditionalLibraries.AddRange(new string[]
+            {
+                Path.Combine(WebPLibDir, "libwebp.lib"),
+                Path.Combine(WebPLibDir, "libwebpmux.lib"),
+                Path.Combine(WebPLibDir, "libwebpdemux.lib")
+            });
+        }
+        else if (Target.Platform == UnrealTargetPlatform.Linux || Target.Platform == UnrealTargetPlatform.LinuxArm64)
+        {
+            // Static libwebp built with -fPIC (see README, "Headless export").
+            // Order matters for the GNU linker: mux/demux before webp, sharpyuv last.
+            string LinuxLibDir = Path.Combine(WebPLibDir, "Linux", Target.Architecture.LinuxName);
+            PublicAdditionalLibraries.AddRange(new string[]
             {
-                "BLAKE3_NO_SSE2",
-                "BLAKE3_NO_SSE41",
-                "BLAKE3_NO_AVX2",
-                "BLAKE3_NO_AVX512"
+                Path.Combine(LinuxLibDir, "libwebpmux.a"),
+                Path.Combine(LinuxLibDir, "libwebpdemux.a"),
+                Path.Combine(LinuxLibDir, "libwebp.a"),
+                Path.Combine(LinuxLibDir, "libsharpyuv.a")
             });
         }
 
+        // BLAKE3: We only need a stable hash, not maximum SIMD throughput.
+        // The bundled sources currently include the portable implementation but not
+        // the optional SIMD translation units (sse2/sse41/avx2/avx512/neon). Without
+        // them blake3_dispatch.c leaves unresolved externals (MSVC, and GCC/Clang on
+        // Linux x64/arm64). Force the portable path on every platform.
+        PrivateDefinitions.AddRange(new string[]
+        {
+            "BLAKE3_NO_SSE2",
+            "BLAKE3_NO_SSE41",
+            "BLAKE3_NO_AVX2",
+            "BLAKE3_NO_AVX512",
+            "BLAKE3_USE_NEON=0"
+        });
+
         // Some engine versions warn on deprecated material APIs; treat warnings normally.
         bUseUnity = false;
     }
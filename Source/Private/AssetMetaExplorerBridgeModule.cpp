@@ -28,23 +28,53 @@ void FAssetMetaExplorerBridgeModule::StartupModule()
     // aeb /Game/SomeFolder  OR  aeb /Game/SomeAsset.SomeAsset
     GAssetSnapshotExportCmd = IConsoleManager::Get().RegisterConsoleCommand(
         TEXT("aeb"),
-        TEXT("Exports asset snapshot builds (zip with meta.json + preview images). Usage: aeb <AssetOrFolderPath> [TypeFilter] [-i ExcludeTypes] [-exit]"),
+        TEXT("Exports asset snapshot builds (zip with meta.json + preview images). Usage: aeb <AssetOrFolderPath> [TypeFilter] [-i ExcludeTypes] [--resume] [--shard=i/N] [--coordinator[=Port]] [-exit] | aeb --merge[=BatchKey] | aeb --worker=http://host:port [-exit]"),
         FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
         {
             if (Args.Num() < 1)
             {
-                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Usage: aeb <AssetOrFolderPath> [TypeFilter] [-exit]"));
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Usage: aeb <AssetOrFolderPath> [TypeFilter] [--resume] [-exit]"));
                 UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Example folder: aeb /Game/byHans1"));
                 UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Example asset : aeb /Game/Props/SM_Box.SM_Box"));
                 UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Exclude types : aeb /Game -i \"Material,MaterialInstance\""));
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Resume batch  : aeb /Game/byHans1 --resume"));
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Shard 3 of 8  : aeb /Game/byHans1 --shard=2/8   (then: aeb --merge)"));
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("Work queue    : aeb /Game/byHans1 --coordinator   (workers: aeb --worker=http://host:9090 -exit)"));
                 UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("TypeFilter examples: animation, mesh, staticmesh, skeletalmesh, material, blueprint, niagara"));
                 return;
             }
 
+            if (Args[0].StartsWith(TEXT("--merge")) || Args[0].StartsWith(TEXT("-merge")))
+            {
+                FString BatchKey;
+                Args[0].Split(TEXT("="), nullptr, &BatchKey);
+                const int32 Merged = UAssetSnapshotBPLibrary::MergeShardManifests(BatchKey);
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb merge finished. Wrote %d manifest(s) to %s/_manifests"), Merged, *UAssetSnapshotBPLibrary::GetDefaultExportRoot());
+                return;
+            }
+
+            if (Args[0].StartsWith(TEXT("--worker")) || Args[0].StartsWith(TEXT("-worker")))
+            {
+                FString CoordinatorUrl;
+                if (!Args[0].Split(TEXT("="), nullptr, &CoordinatorUrl) && Args.Num() > 1)
+                {
+                    CoordinatorUrl = Args[1];
+                }
+                FAssetSnapshotExportSummary Summary;
+                const int32 Count = UAssetSnapshotBPLibrary::RunExportWorkerNative(CoordinatorUrl, &Summary);
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb worker finished. Exported %d build(s) (skipped %d, failed %d)."), Count, Summary.Skipped, Summary.Failed);
+                if (Args.Contains(TEXT("-exit")) || Args.Contains(TEXT("--exit")))
+                {
+                    FPlatformMisc::RequestExit(false);
+                }
+                return;
+            }
+
             const FString InPath = Args[0];
             FString TypeFilter;
             FString ExcludeFilter;
             bool bExitAfter = false;
+            FAssetSnapshotExportOptions Options;
             for (int32 Index = 1; Index < Args.Num(); ++Index)
             {
                 const FString Arg = Args[Index];
@@ -75,6 +105,38 @@ void FAssetMetaExplorerBridgeModule::StartupModule()
                     continue;
                 }
 
+                if (Arg == TEXT("-shard") || Arg == TEXT("--shard") || Arg.StartsWith(TEXT("-shard=")) || Arg.StartsWith(TEXT("--shard=")))
+                {
+                    FString Spec;
+                    if (!Arg.Split(TEXT("="), nullptr, &Spec) && Index + 1 < Args.Num())
+                    {
+                        Spec = Args[++Index];
+                    }
+                    if (!Options.SetShardFromString(Spec))
+                    {
+                        UE_LOG(LogAssetMetaExplorerBridge, Error, TEXT("Invalid shard '%s' (expected i/N with 0 <= i < N)."), *Spec);
+                        return;
+                    }
+                    continue;
+                }
+
+                if (Arg == TEXT("-coordinator") || Arg == TEXT("--coordinator") || Arg.StartsWith(TEXT("-coordinator=")) || Arg.StartsWith(TEXT("--coordinator=")))
+                {
+                    FString PortStr;
+                    Options.bCoordinator = true;
+                    if (Arg.Split(TEXT("="), nullptr, &PortStr))
+                    {
+                        Options.CoordinatorPort = FCString::Atoi(*PortStr);
+                    }
+                    continue;
+                }
+
+                if (Arg == TEXT("-resume") || Arg == TEXT("--resume"))
+                {
+                    Options.bResume = true;
+                    continue;
+                }
+
                 if (Arg == TEXT("-exit") || Arg == TEXT("--exit"))
                 {
                     bExitAfter = true;
@@ -87,13 +149,40 @@ void FAssetMetaExplorerBridgeModule::StartupModule()
                 }
             }
 
-            const int32 Count = UAssetSnapshotBPLibrary::ExportPathBuilds(InPath, TypeFilter, ExcludeFilter);
-            UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb finished. Exported %d build(s). Output: %s (plus per-top-folder subdirs)"), Count, *UAssetSnapshotBPLibrary::GetDefaultExportRoot());
+            auto ReportFinished = [bExitAfter](const FAssetSnapshotExportSummary& Summary)
+            {
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb finished. Exported %d build(s). Output: %s (plus per-top-folder subdirs)"), Summary.Exported, *UAssetSnapshotBPLibrary::GetDefaultExportRoot());
+                if (!Summary.JournalPath.IsEmpty())
+                {
+                    UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb journal: %s (skipped %d, failed %d, resumed %d)"), *Summary.JournalPath, Summary.Skipped, Summary.Failed, Summary.Resumed);
+                }
+                if (!Summary.ManifestPath.IsEmpty())
+                {
+                    UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb manifest: %s (batch key %s)"), *Summary.ManifestPath, *Summary.BatchKey);
+                }
+
+                if (bExitAfter)
+                {
+                    UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb -exit requested. Closing editor."));
+                    FPlatformMisc::RequestExit(false);
+                }
+            };
 
-            if (bExitAfter)
+            // A coordinator keeps serving from the editor tick; it reports when its queue is done.
+            if (Options.bCoordinator)
+            {
+                Options.OnCoordinatorFinished = ReportFinished;
+            }
+            FAssetSnapshotExportSummary Summary;
+            UAssetSnapshotBPLibrary::ExportPathBuildsNative(InPath, TypeFilter, ExcludeFilter, Options, &Summary);
+            if (Options.bCoordinator && UAssetSnapshotBPLibrary::IsWorkCoordinatorRunning())
+            {
+                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb coordinator: serving the work queue in the background."));
+                return;
+            }
+            if (!Options.bCoordinator || Summary.ManifestPath.IsEmpty())
             {
-                UE_LOG(LogAssetMetaExplorerBridge, Display, TEXT("aeb -exit requested. Closing editor."));
-                FPlatformMisc::RequestExit(false);
+                ReportFinished(Summary);
             }
         }),
         ECVF_Default);
@@ -120,7 +209,8 @@ void FAssetMetaExplorerBridgeModule::StartupModule()
             *Settings->ImportBaseUrl,
             Settings->ImportListenPort);
     }
-    ListenPort = Settings ? Settings->ImportListenPort : 0;
+    // Commandlets (farm exports) never serve imports; several may run on one host.
+    ListenPort = (Settings && !IsRunningCommandlet()) ? Settings->ImportListenPort : 0;
     if (ListenPort > 0)
     {
         HttpRouter = FHttpServerModule::Get().GetHttpRouter(ListenPort);
@@ -258,6 +348,15 @@ void FAssetMetaExplorerBridgeModule::StartupModule()
         }
     }
 
+    // Background sender for the upload outbox (uploads/events journaled while the backend was down).
+    OutboxTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+        FTickerDelegate::CreateLambda([](float DeltaTime)
+        {
+            UAssetSnapshotBPLibrary::PumpUploadOutbox();
+            return true;
+        }),
+        2.0f);
+
     UE_LOG(LogAssetMetaExplorerBridge, Log, TEXT("AssetMetaExplorerBridge module started."));
 }
 
@@ -268,6 +367,12 @@ void FAssetMetaExplorerBridgeModule::ShutdownModule()
         SettingsModule->UnregisterSettings("Editor", "Plugins", "Asset Meta Explorer Bridge");
     }
 
+    if (OutboxTickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(OutboxTickerHandle);
+        OutboxTickerHandle.Reset();
+    }
+
     if (GAssetSnapshotExportCmd)
     {
         IConsoleManager::Get().UnregisterConsoleObject(GAssetSnapshotExportCmd);
@@ -15,14 +15,20 @@
 #include "CanvasTypes.h"
 #include "CanvasItem.h"
 #include "RHI.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
 #include "webp/encode.h"
+#include "webp/mux.h"
 // UE5: IStreamingManager lives in ContentStreaming.h (the old Streaming/StreamingManager.h path no longer exists)
 #include "ContentStreaming.h"
 #include "PhysicsEngine/BodySetup.h"
 #include "HAL/FileManager.h"
 #include "JsonObjectConverter.h"
 #include "Kismet/GameplayStatics.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Materials/MaterialInstanceDynamic.h"
 #include "Materials/MaterialInterface.h"
+#include "MaterialShared.h"
 #include "Math/RotationMatrix.h"
 #include "Modules/ModuleManager.h"
 #include "Misc/DateTime.h"
@@ -40,13 +46,38 @@
 #include "Rendering/SkeletalMeshRenderData.h"
 #include "Serialization/JsonSerializer.h"
 #include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
 #include "UObject/SoftObjectPath.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/GCObject.h"
+#include "UObject/ObjectKey.h"
 #include "UObject/UObjectGlobals.h"
 #include "AssetSnapshotSettings.h"
 
 #if WITH_EDITOR
 #include "Editor.h"
 #include "AssetCompilingManager.h"
+#include "ShaderCompiler.h"
+#include "SkinnedAssetCompiler.h"
+#include "StaticMeshCompiler.h"
+#include "TextureCompiler.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionCustom.h"
+#include "Materials/MaterialExpressionDynamicParameter.h"
+#include "Materials/MaterialExpressionMaterialAttributeLayers.h"
+#include "Materials/MaterialExpressionMaterialFunctionCall.h"
+#include "Materials/MaterialExpressionPanner.h"
+#include "Materials/MaterialExpressionRotator.h"
+#include "Materials/MaterialExpressionTime.h"
+#include "Materials/MaterialFunctionInterface.h"
 #endif
 
 // Optional types
@@ -64,6 +95,13 @@
 
 #include "blake3.h"
 
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#define ASSETSNAPSHOT_WITH_SSE2 1
+#else
+#define ASSETSNAPSHOT_WITH_SSE2 0
+#endif
+
 DEFINE_LOG_CATEGORY_STATIC(LogAssetSnapshot, Log, All);
 
 static int32 GAssetSnapshotExportBatchId = 0;
@@ -93,6 +131,160 @@ namespace AssetSnapshot
         return Url;
     }
 
+    // ============================================================================
+    // BACKEND CIRCUIT BREAKER (reset per export batch, shared by all backend calls)
+    // ============================================================================
+    // Closed:   requests pass; N consecutive failures trip the breaker.
+    // Open:     requests are short-circuited until the probe time is reached.
+    // HalfOpen: a single probe request is let through; success closes the breaker,
+    //           failure re-opens it with a doubled probe delay.
+    // ============================================================================
+    enum class EBackendCircuitState : uint8
+    {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    struct FBackendCircuitBreaker
+    {
+        EBackendCircuitState State = EBackendCircuitState::Closed;
+        int32 ConsecutiveFailures = 0;
+        int32 Failures = 0;
+        int32 Successes = 0;
+        int32 Trips = 0;
+        int32 ShortCircuited = 0;
+        double BackoffSec = 0.0;
+        double NextProbeSec = 0.0;
+    };
+
+    static FBackendCircuitBreaker GBackendBreaker;
+    static FCriticalSection GBackendBreakerLock;
+
+    static const TCHAR* BackendCircuitStateToString(EBackendCircuitState State)
+    {
+        switch (State)
+        {
+        case EBackendCircuitState::Open: return TEXT("open");
+        case EBackendCircuitState::HalfOpen: return TEXT("half-open");
+        default: return TEXT("closed");
+        }
+    }
+
+    static void ResetBackendBreaker()
+    {
+        FScopeLock Lock(&GBackendBreakerLock);
+        GBackendBreaker = FBackendCircuitBreaker();
+    }
+
+    // Returns false when the call must be skipped (breaker open, or a probe is already running:
+    // half-open admits nothing until the probe reports). Every allowed request must end in
+    // BackendRecordResult, so call this right before sending.
+    static bool BackendAllowRequest(const TCHAR* What)
+    {
+        FScopeLock Lock(&GBackendBreakerLock);
+        if (GBackendBreaker.State == EBackendCircuitState::Closed)
+        {
+            return true;
+        }
+
+        const double Now = FPlatformTime::Seconds();
+        if (GBackendBreaker.State == EBackendCircuitState::Open && Now >= GBackendBreaker.NextProbeSec)
+        {
+            GBackendBreaker.State = EBackendCircuitState::HalfOpen;
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Backend circuit: probing with %s"), What);
+            return true;
+        }
+
+        ++GBackendBreaker.ShortCircuited;
+        return false;
+    }
+
+    // Hands back a probe admitted by BackendAllowRequest that was never sent, so
+    // the next caller can probe instead of waiting on a result that never comes.
+    static void BackendReleaseProbe()
+    {
+        FScopeLock Lock(&GBackendBreakerLock);
+        if (GBackendBreaker.State == EBackendCircuitState::HalfOpen)
+        {
+            GBackendBreaker.State = EBackendCircuitState::Open;
+        }
+    }
+
+    // True while BackendAllowRequest would refuse everything: open before the
+    // probe time, or half-open with the probe still outstanding.
+    static bool IsBackendBlocked()
+    {
+        FScopeLock Lock(&GBackendBreakerLock);
+        return GBackendBreaker.State == EBackendCircuitState::HalfOpen
+            || (GBackendBreaker.State == EBackendCircuitState::Open && FPlatformTime::Seconds() < GBackendBreaker.NextProbeSec);
+    }
+
+    static void BackendRecordResult(bool bReachable)
+    {
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        const int32 Threshold = Settings ? FMath::Max(1, Settings->BackendFailureThreshold) : 3;
+        const double BaseBackoff = Settings ? FMath::Max(0.1, (double)Settings->BackendProbeBackoffSeconds) : 5.0;
+        const double MaxBackoff = Settings ? FMath::Max(BaseBackoff, (double)Settings->BackendProbeBackoffMaxSeconds) : 300.0;
+
+        FScopeLock Lock(&GBackendBreakerLock);
+        FBackendCircuitBreaker& B = GBackendBreaker;
+        if (bReachable)
+        {
+            ++B.Successes;
+            B.ConsecutiveFailures = 0;
+            if (B.State != EBackendCircuitState::Closed)
+            {
+                UE_LOG(LogAssetSnapshot, Log, TEXT("Backend circuit: closed (server reachable again)"));
+            }
+            B.State = EBackendCircuitState::Closed;
+            B.BackoffSec = 0.0;
+            return;
+        }
+
+        ++B.Failures;
+        ++B.ConsecutiveFailures;
+        if (B.State == EBackendCircuitState::HalfOpen)
+        {
+            B.BackoffSec = FMath::Min(MaxBackoff, B.BackoffSec * 2.0);
+            B.State = EBackendCircuitState::Open;
+            B.NextProbeSec = FPlatformTime::Seconds() + B.BackoffSec;
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Backend circuit: probe failed, next probe in %.0fs"), B.BackoffSec);
+        }
+        else if (B.State == EBackendCircuitState::Closed && B.ConsecutiveFailures >= Threshold)
+        {
+            B.BackoffSec = BaseBackoff;
+            B.State = EBackendCircuitState::Open;
+            B.NextProbeSec = FPlatformTime::Seconds() + B.BackoffSec;
+            ++B.Trips;
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Backend circuit: open after %d consecutive failures; skipping backend calls, next probe in %.0fs"), B.ConsecutiveFailures, B.BackoffSec);
+        }
+    }
+
+    // Transport errors, timeouts and 5xx count as failures; any other answer means the server is up.
+    static bool IsBackendReachable(FHttpResponsePtr Resp, bool bSucceeded)
+    {
+        return bSucceeded && Resp.IsValid() && Resp->GetResponseCode() > 0 && Resp->GetResponseCode() < 500;
+    }
+
+    static double GetBackendNextProbeSec()
+    {
+        FScopeLock Lock(&GBackendBreakerLock);
+        return GBackendBreaker.State == EBackendCircuitState::Closed ? 0.0 : GBackendBreaker.NextProbeSec;
+    }
+
+    static FString DescribeBackendBreaker()
+    {
+        FScopeLock Lock(&GBackendBreakerLock);
+        return FString::Printf(
+            TEXT("state=%s trips=%d failures=%d successes=%d short_circuited=%d"),
+            BackendCircuitStateToString(GBackendBreaker.State),
+            GBackendBreaker.Trips,
+            GBackendBreaker.Failures,
+            GBackendBreaker.Successes,
+            GBackendBreaker.ShortCircuited);
+    }
+
 
     struct FServerSettingsCache
     {
@@ -113,6 +305,10 @@ namespace AssetSnapshot
         FString ExportCheckPathTemplate = TEXT("/assets/exists?hash={hash}&hash_type=blake3");
         bool bUploadAfterExport = true;
         FString ExportUploadPathTemplate = TEXT("/assets/upload");
+        FString WebPPreset = TEXT("balanced");
+        int32 WebPQuality = 0;                // 0 = preset value
+        int32 WebPMethod = -1;                // -1 = preset value
+        int32 MaterialNearLossless = 0;       // 0 = lossy; 1..100 = lossless swatches at this near_lossless level
     };
 
     static FServerSettingsCache GServerSettings;
@@ -191,6 +387,11 @@ namespace AssetSnapshot
             return GServerSettings;
         }
 
+        if (!BackendAllowRequest(TEXT("/settings")))
+        {
+            return GServerSettings;
+        }
+
         const FString Url = NormalizeBaseUrl(BaseUrl) + TEXT("/settings");
         TSharedPtr<FEvent> DoneEvent = MakeShareable(
             FPlatformProcess::GetSynchEventFromPool(true),
@@ -210,6 +411,7 @@ namespace AssetSnapshot
                 {
                     return;
                 }
+                BackendRecordResult(IsBackendReachable(Resp, bSucceeded));
                 if (bSucceeded && Resp.IsValid() && EHttpResponseCodes::IsOk(Resp->GetResponseCode()))
                 {
                     *ResponseText = Resp->GetContentAsString();
@@ -231,6 +433,7 @@ namespace AssetSnapshot
         {
             bAbandoned->Store(true);
             Request->CancelRequest();
+            BackendRecordResult(false);
             UE_LOG(LogAssetSnapshot, Warning, TEXT("Server settings request timed out: %s"), *Url);
             return GServerSettings;
         }
@@ -262,6 +465,10 @@ namespace AssetSnapshot
         GServerSettings.ExportCheckPathTemplate = GetSettingString(Obj, TEXT("export_check_path_template"), TEXT("/assets/exists?hash={hash}&hash_type=blake3"));
         GServerSettings.bUploadAfterExport = ParseBoolSetting(GetSettingString(Obj, TEXT("export_upload_after_export"), TEXT("true")), true);
         GServerSettings.ExportUploadPathTemplate = GetSettingString(Obj, TEXT("export_upload_path_template"), TEXT("/assets/upload"));
+        GServerSettings.WebPPreset = GetSettingString(Obj, TEXT("export_webp_preset"), TEXT("balanced")).TrimStartAndEnd().ToLower();
+        GServerSettings.WebPQuality = ParseIntSetting(GetSettingString(Obj, TEXT("export_webp_quality"), TEXT("")), 0);
+        GServerSettings.WebPMethod = ParseIntSetting(GetSettingString(Obj, TEXT("export_webp_method"), TEXT("")), -1);
+        GServerSettings.MaterialNearLossless = ParseIntSetting(GetSettingString(Obj, TEXT("export_webp_material_near_lossless"), TEXT("0")), 0);
         GServerSettings.bAvailable = true;
         GServerSettings.LastFetchTimeSec = NowSec;
         return GServerSettings;
@@ -272,7 +479,7 @@ namespace AssetSnapshot
     static const float kDistancePadding = 1.15f;
     
     // ============================================================================
-    // SINGLE EXPORT WITH 1 SECOND PAUSE BEFORE SHOOTING
+    // FRAME COUNTS AND INTERVALS
     // ============================================================================
     // For 360° View (StaticMesh, SkeletalMesh):
     static const int32 kCapture360FramesToDiscardDefault = 0;
@@ -335,32 +542,30 @@ namespace AssetSnapshot
     }
     static const int32 kCapture360FramesTotal = 8;          // Total frames
     static const int32 kCapture360FramesToKeep = 5;         // Keep 5 frames (72 deg per frame)
-    static const float kCapture360FrameInterval = 0.2f;     // 0.2s between frames
-    static const float kCapture360PauseBeforeShoot = 1.0f; // 1 SECOND PAUSE before shooting!
-    // Strategy: 1s pause, then capture 5 frames (keep 5)
-    // Total: ~3.5 seconds (1s pause + 2.5s capture)
+    static const float kCapture360FrameInterval = 0.2f;     // 0.2s world time between frames
+    // Strategy: wait until ready (WaitForCaptureReady), then capture 5 frames (keep 5)
     
     // For Materials (animated materials, NO 360° rotation):
     static const int32 kCaptureMaterialFramesTotal = 5;     // Total frames
     static const int32 kCaptureMaterialFramesToKeep = 5;    // Keep 5 frames (animation)
-    static const float kCaptureMaterialFrameInterval = 0.5f; // 0.5s between frames
-    static const float kCaptureMaterialPauseBeforeShoot = 1.0f; // 1 SECOND PAUSE before shooting!
-    // Strategy: 1s pause, then capture 5 frames (keep 5)
-    // Total: ~3.5 seconds (1s pause + 2.5s capture)
+    static const float kCaptureMaterialFrameInterval = 0.5f; // 0.5s world time between frames
+    // Strategy: wait until ready (WaitForCaptureReady), then capture 5 frames (keep 5)
     // ============================================================================
     
     static const int32 kMaxAnimationFrames = 10;
     static const int32 kWarmupFrames = 60;
-    static const float kWarmupSeconds = 8.0f;
-    static const float kWarmupPauseSeconds = 6.0f;
     static const int32 kMinMaterialResolution = 1024;
     static const int32 kTexturePreviewResolution = 1024;
-    static const int32 kMaterialMinWebPBytes = 130000;
 
     struct FZipEntry
     {
         FString NameInZip;
         TArray<uint8> Data;
+        UE::Tasks::TTask<TArray<uint8>> PendingData;  // valid while Data is still being encoded on a worker
+        TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe> SourcePixels;  // square frame kept for animated packing
+        int32 SourceResolution = 0;
+        FIntRect CropRect;  // region of the square frame that was encoded; empty = whole frame
+        int32 CaptureStep = 0;  // capture step the frame was taken at; dropped duplicates leave gaps
     };
 
     struct FMaterialCaptureContext
@@ -368,8 +573,12 @@ namespace AssetSnapshot
         FPreviewScene Scene;
         UWorld* World = nullptr;
         UStaticMeshComponent* Comp = nullptr;
+        TArray<UStaticMeshComponent*> AtlasComps;  // extra spheres for atlas captures, hidden otherwise
+        TStrongObjectPtr<UMaterialInstanceDynamic> InstanceMid;  // shared by instances of one parent
         FVector ViewDir = FVector(1.f, 0.f, 0.f);
         float Distance = 0.f;
+        bool bAtlasVerified = false;  // first atlas compared against a lone capture
+        bool bAtlasDisabled = false;  // that comparison failed: no atlases for the rest of the batch
 
         FMaterialCaptureContext()
             : Scene(FPreviewScene::ConstructionValues())
@@ -379,6 +588,80 @@ namespace AssetSnapshot
 
     static FMaterialCaptureContext* GMaterialCaptureContext = nullptr;
 
+    // Persistent preview stages for the other capture paths: lights and sky
+    // capture are set up once per stage, each asset only adds its subject
+    // (components / spawned actors), which is removed again after the capture.
+    enum class ECaptureStageKind : uint8
+    {
+        StaticMesh,
+        SkeletalMesh,
+        Blueprint,
+        Niagara,
+        Anim,
+        Count
+    };
+
+    struct FCaptureStage
+    {
+        FPreviewScene Scene;
+        UWorld* World = nullptr;
+        int32 Uses = 0;
+        TArray<UActorComponent*> SubjectComponents;
+        TArray<TWeakObjectPtr<AActor>> SubjectActors;
+
+        FCaptureStage()
+            : Scene(FPreviewScene::ConstructionValues())
+        {
+        }
+
+        void AddSubject(UActorComponent* Comp)
+        {
+            Scene.AddComponent(Comp, FTransform::Identity);
+            SubjectComponents.Add(Comp);
+        }
+
+        void TrackActor(AActor* Actor)
+        {
+            SubjectActors.Add(Actor);
+        }
+
+        void ClearSubjects()
+        {
+            for (UActorComponent* Comp : SubjectComponents)
+            {
+                Scene.RemoveComponent(Comp);
+            }
+            SubjectComponents.Reset();
+            for (const TWeakObjectPtr<AActor>& Actor : SubjectActors)
+            {
+                if (Actor.IsValid())
+                {
+                    Actor->Destroy();
+                }
+            }
+            SubjectActors.Reset();
+        }
+    };
+
+    // One stage per kind, created on first use and kept for the batch.
+    struct FCaptureStagePool
+    {
+        TUniquePtr<FCaptureStage> Stages[(int32)ECaptureStageKind::Count];
+
+        ~FCaptureStagePool()
+        {
+            for (TUniquePtr<FCaptureStage>& Stage : Stages)
+            {
+                if (Stage)
+                {
+                    Stage->ClearSubjects();
+                }
+            }
+        }
+    };
+
+    static FCaptureStagePool* GCaptureStagePool = nullptr;
+
     static void WriteLE16(FArchive& Ar, uint16 V) { Ar.Serialize(&V, sizeof(V)); }
     static void WriteLE32(FArchive& Ar, uint32 V) { Ar.Serialize(&V, sizeof(V)); }
     static bool ReadLE16(FArchive& Ar, uint16& Out)
@@ -531,6 +814,45 @@ namespace AssetSnapshot
         return true;
     }
 
+    // Session cache for main-file hashes, validated by size and timestamp, so
+    // incremental re-runs do not re-read unchanged packages.
+    struct FFileHashCacheEntry
+    {
+        int64 Size = -1;
+        FDateTime Timestamp;
+        FString Hex;
+    };
+    static TMap<FString, FFileHashCacheEntry> GFileHashCache;
+
+    static bool Blake3HashFileCached(const FString& FileAbs, FString& OutHex)
+    {
+        const FFileStatData Stat = IFileManager::Get().GetStatData(*FileAbs);
+        if (!Stat.bIsValid || Stat.bIsDirectory)
+        {
+            return false;
+        }
+
+        if (const FFileHashCacheEntry* Cached = GFileHashCache.Find(FileAbs))
+        {
+            if (Cached->Size == Stat.FileSize && Cached->Timestamp == Stat.ModificationTime)
+            {
+                OutHex = Cached->Hex;
+                return true;
+            }
+        }
+
+        if (!Blake3HashFile(FileAbs, OutHex))
+        {
+            return false;
+        }
+
+        FFileHashCacheEntry& Entry = GFileHashCache.FindOrAdd(FileAbs);
+        Entry.Size = Stat.FileSize;
+        Entry.Timestamp = Stat.ModificationTime;
+        Entry.Hex = OutHex;
+        return true;
+    }
+
     static bool Sha256HashFile(const FString& FileAbs, FString& OutHex)
     {
         struct FSha256Ctx
@@ -763,2564 +1085,7621 @@ namespace AssetSnapshot
         return true;
     }
 
-    static bool EncodeWebPFromBGRA(const TArray<FColor>& Pixels, int32 Width, int32 Height, TArray<uint8>& OutBytes)
+    // ============================================================================
+    // WEBP ENCODER PRESETS
+    // ============================================================================
+    // The backend picks a preset (export_webp_preset): "fast" for bulk
+    // reindexing, "balanced" (the previous fixed quality 80 / method 4) or
+    // "quality" for hero assets. Quality and method can be overridden on top.
+    // Flat material swatches can be encoded near-lossless instead.
+    // ============================================================================
+    enum class EWebPContent : uint8
+    {
+        Scene,
+        MaterialSwatch
+    };
+
+    struct FWebPEncodeOptions
+    {
+        float Quality = 80.0f;
+        int32 Method = 4;
+        int32 ThreadLevel = 0;
+        bool bLossless = false;
+        int32 NearLossless = 100;  // libwebp: 100 = off, lower = more preprocessing
+        FString PresetName = TEXT("balanced");
+    };
+
+    // Resolve on the game thread (may refresh server settings); encode tasks take a copy.
+    static FWebPEncodeOptions GetWebPEncodeOptions(EWebPContent Content = EWebPContent::Scene)
     {
-        if (Pixels.Num() == 0 || Width <= 0 || Height <= 0)
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        const FServerSettingsCache& Server = GetServerSettingsCached(Settings ? Settings->ImportBaseUrl : FString());
+
+        FWebPEncodeOptions Options;
+        if (Server.WebPPreset == TEXT("fast"))
         {
-            return false;
+            Options.Quality = 75.0f;
+            Options.Method = 1;
+            Options.PresetName = TEXT("fast");
         }
-
-        const uint8* Raw = reinterpret_cast<const uint8*>(Pixels.GetData());
-        const int32 Stride = Width * 4;
-        uint8* Encoded = nullptr;
-        const size_t EncodedSize = WebPEncodeBGRA(Raw, Width, Height, Stride, 80.0f, &Encoded);
-        if (EncodedSize == 0 || Encoded == nullptr)
+        else if (Server.WebPPreset == TEXT("quality"))
         {
-            return false;
+            Options.Quality = 90.0f;
+            Options.Method = 6;
+            Options.ThreadLevel = 1;
+            Options.PresetName = TEXT("quality");
+        }
+        if (Server.WebPQuality > 0)
+        {
+            Options.Quality = (float)FMath::Clamp(Server.WebPQuality, 1, 100);
+        }
+        if (Server.WebPMethod >= 0)
+        {
+            Options.Method = FMath::Clamp(Server.WebPMethod, 0, 6);
+        }
+        if (Content == EWebPContent::MaterialSwatch && Server.MaterialNearLossless > 0)
+        {
+            Options.bLossless = true;
+            Options.NearLossless = FMath::Clamp(Server.MaterialNearLossless, 0, 100);
         }
+        return Options;
+    }
 
-        OutBytes.SetNumUninitialized((int32)EncodedSize);
-        FMemory::Memcpy(OutBytes.GetData(), Encoded, EncodedSize);
-        WebPFree(Encoded);
-        return true;
+    // libwebp writer callback: appends straight into the destination array.
+    static int WebPWriteToArray(const uint8_t* Data, size_t DataSize, const WebPPicture* Picture)
+    {
+        TArray<uint8>* Out = static_cast<TArray<uint8>*>(Picture->custom_ptr);
+        Out->Append(Data, (int32)DataSize);
+        return 1;
     }
 
-    static bool MakeBlackWebP(int32 Size, TArray<uint8>& OutWebP)
+    static bool MakeWebPConfig(const FWebPEncodeOptions& Options, WebPConfig& OutConfig)
     {
-        if (Size <= 0)
+        if (!WebPConfigInit(&OutConfig))
         {
             return false;
         }
-
-        TArray<FColor> Pixels;
-        Pixels.Init(FColor::Black, Size * Size);
-        return EncodeWebPFromBGRA(Pixels, Size, Size, OutWebP);
-    }
-
-    static void AddBlackPreview(
-        TArray<TSharedPtr<FJsonValue>>& PreviewFiles,
-        TArray<FZipEntry>& ZipEntries,
-        int32 Size)
-    {
-        TArray<uint8> WebP;
-        if (!MakeBlackWebP(Size, WebP))
+        OutConfig.quality = Options.Quality;
+        OutConfig.method = Options.Method;
+        OutConfig.thread_level = Options.ThreadLevel;
+        if (Options.bLossless)
         {
-            return;
+            OutConfig.lossless = 1;
+            OutConfig.near_lossless = Options.NearLossless;
         }
-
-        FZipEntry E;
-        E.NameInZip = TEXT("0.webp");
-        E.Data = MoveTemp(WebP);
-        PreviewFiles.Add(MakeShared<FJsonValueString>(E.NameInZip));
-        ZipEntries.Add(MoveTemp(E));
-    }
-
-    static FString NormalizeRelPath(const FString& Path)
-    {
-        FString P = Path;
-        P.ReplaceInline(TEXT("\\"), TEXT("/"));
-        while (P.StartsWith(TEXT("/")))
+        if (!WebPValidateConfig(&OutConfig))
         {
-            P.RightChopInline(1);
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Invalid WebP config (quality %.0f, method %d)"), Options.Quality, Options.Method);
+            return false;
         }
-        return P;
+        return true;
     }
 
-    // Project-layout zips can contain "<Project>/Content/...".
-    // We keep the project folder, but drop the intermediate "Content" segment
-    // so imports become "<Project>/..." under the target Content root.
-    static FString NormalizeImportRelPath(const FString& RelPath)
+    // Crop (if not empty) selects the region of the Width x Height image to encode.
+    static bool EncodeWebPFromBGRA(
+        const TArray<FColor>& Pixels,
+        int32 Width,
+        int32 Height,
+        TArray<uint8>& OutBytes,
+        const FWebPEncodeOptions& Options = FWebPEncodeOptions(),
+        const FIntRect& Crop = FIntRect())
     {
-        FString P = NormalizeRelPath(RelPath);
-        if (P.IsEmpty())
+        if (Pixels.Num() < Width * Height || Width <= 0 || Height <= 0)
         {
-            return P;
+            return false;
         }
+        const FIntRect Region = Crop.Area() > 0 ? Crop : FIntRect(0, 0, Width, Height);
 
-        TArray<FString> Parts;
-        P.ParseIntoArray(Parts, TEXT("/"), true);
-        if (Parts.Num() >= 2 && Parts[1].Equals(TEXT("Content"), ESearchCase::IgnoreCase))
-        {
-            Parts.RemoveAt(1);
-            return FString::Join(Parts, TEXT("/"));
-        }
-        if (Parts.Num() >= 1 && Parts[0].Equals(TEXT("Content"), ESearchCase::IgnoreCase))
+        WebPConfig Config;
+        if (!MakeWebPConfig(Options, Config))
         {
-            Parts.RemoveAt(0);
-            return FString::Join(Parts, TEXT("/"));
+            return false;
         }
-        return P;
-    }
 
-    static bool IsSafeZipRelPath(const FString& RelPath)
-    {
-        FString P = NormalizeRelPath(RelPath);
-        if (P.IsEmpty())
+        WebPPicture Picture;
+        if (!WebPPictureInit(&Picture))
         {
             return false;
         }
-        if (P.Contains(TEXT(":")))
+        // Lossless encodes from ARGB; lossy imports straight to YUV.
+        Picture.use_argb = Config.lossless;
+        Picture.width = Region.Width();
+        Picture.height = Region.Height();
+        const uint8* Raw = reinterpret_cast<const uint8*>(Pixels.GetData() + Region.Min.Y * Width + Region.Min.X);
+        if (!WebPPictureImportBGRA(&Picture, Raw, Width * 4))
         {
+            WebPPictureFree(&Picture);
             return false;
         }
-        TArray<FString> Parts;
-        P.ParseIntoArray(Parts, TEXT("/"), true);
-        for (const FString& Part : Parts)
+
+        OutBytes.Reset();
+        Picture.writer = WebPWriteToArray;
+        Picture.custom_ptr = &OutBytes;
+        const bool bOk = WebPEncode(&Config, &Picture) != 0;
+        if (!bOk)
         {
-            if (Part == TEXT("..") || Part == TEXT("."))
-            {
-                return false;
-            }
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("WebP encode failed (error %d)"), (int32)Picture.error_code);
+            OutBytes.Reset();
         }
-        return true;
+        WebPPictureFree(&Picture);
+        return bOk && OutBytes.Num() > 0;
     }
 
-    static bool IsImportableAssetFile(const FString& RelPath)
+    // ============================================================================
+    // PIXEL KERNELS
+    // ============================================================================
+    // Whole-frame loops over raw BGRA readbacks run on the game thread for every
+    // captured frame. On x86 they take four pixels per SSE2 step (FColor is one
+    // 32-bit lane); other targets and the tails of odd lengths use scalar code
+    // computing exactly the same values.
+    // ============================================================================
+    static const int32 kLumaHistogramBins = 32;  // luma >> 3
+
+    static FORCEINLINE uint32 PixelLuma(const FColor& C)
     {
-        const FString Ext = FString::Printf(TEXT(".%s"), *FPaths::GetExtension(RelPath, false)).ToLower();
-        return Ext == TEXT(".uasset")
-            || Ext == TEXT(".uexp")
-            || Ext == TEXT(".ubulk")
-            || Ext == TEXT(".uptnl")
-            || Ext == TEXT(".umap");
+        return (C.R * 54u + C.G * 183u + C.B * 19u) >> 8;
     }
 
-    static bool ExtractZipStore(const FString& ZipPath, const FString& DestRoot, EAssetSnapshotImportMode Mode, FString& OutError)
+    static FORCEINLINE bool IsBackgroundPixel(const FColor& C, const FColor& Background, int32 Tolerance)
     {
-        TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*ZipPath));
-        if (!Ar)
-        {
-            OutError = FString::Printf(TEXT("Failed to open zip: %s"), *ZipPath);
-            return false;
-        }
+        return FMath::Abs((int32)C.R - (int32)Background.R) <= Tolerance
+            && FMath::Abs((int32)C.G - (int32)Background.G) <= Tolerance
+            && FMath::Abs((int32)C.B - (int32)Background.B) <= Tolerance;
+    }
 
-        int32 ImportedFiles = 0;
-        int32 SkippedFiles = 0;
-        TArray<FString> ImportedUAssetFiles;
+#if ASSETSNAPSHOT_WITH_SSE2
+    // Bit k set when pixel k of the four in Px is within tolerance of the background in R, G and B.
+    static FORCEINLINE int32 SseBackgroundMask4(__m128i Px, __m128i Background, __m128i Tolerance)
+    {
+        const __m128i RgbMask = _mm_set1_epi32(0x00FFFFFF);
+        const __m128i Diff = _mm_or_si128(_mm_subs_epu8(Px, Background), _mm_subs_epu8(Background, Px));
+        const __m128i Over = _mm_and_si128(_mm_subs_epu8(Diff, Tolerance), RgbMask);
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(Over, _mm_setzero_si128())));
+    }
 
-        while (!Ar->AtEnd())
-        {
-            uint32 Sig = 0;
-            if (!ReadLE32(*Ar, Sig))
-            {
-                OutError = TEXT("Failed to read zip signature.");
-                return false;
-            }
+    // Luma of four pixels, one per 32-bit lane.
+    static FORCEINLINE __m128i SseLuma4(__m128i Px)
+    {
+        const __m128i Zero = _mm_setzero_si128();
+        const __m128i Weights = _mm_set_epi16(0, 54, 183, 19, 0, 54, 183, 19);  // B, G, R, A per pixel
+        const __m128 Lo = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(Px, Zero), Weights));
+        const __m128 Hi = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(Px, Zero), Weights));
+        const __m128i BlueGreen = _mm_castps_si128(_mm_shuffle_ps(Lo, Hi, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i RedAlpha = _mm_castps_si128(_mm_shuffle_ps(Lo, Hi, _MM_SHUFFLE(3, 1, 3, 1)));
+        return _mm_srli_epi32(_mm_add_epi32(BlueGreen, RedAlpha), 8);
+    }
 
-            if (Sig == 0x02014b50 || Sig == 0x06054b50)
-            {
-                // Central directory or end of central directory; we're done.
-                break;
-            }
+    static FORCEINLINE uint64 SseSumLanes(__m128i V)
+    {
+        alignas(16) uint32 Lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes), V);
+        return (uint64)Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+    }
+#endif
 
-            if (Sig != 0x04034b50)
+    struct FFramePixelSums
+    {
+        uint64 Luma = 0;
+        uint64 LumaSq = 0;
+        uint32 Background = 0;  // pixels within tolerance of the background colour
+        uint32 Histogram[kLumaHistogramBins] = {};
+    };
+
+    // One pass over the frame for luma sum, sum of squares, histogram and background count.
+    static void AccumulateFramePixels(const FColor* Pixels, int32 Num, const FColor& Background, int32 Tolerance, FFramePixelSums& Out)
+    {
+        int32 i = 0;
+#if ASSETSNAPSHOT_WITH_SSE2
+        // Lane sums are flushed to 64 bits before the squares could overflow 32.
+        const int32 kFlushSteps = 4096;
+        const __m128i Bg = _mm_set1_epi32((int32)Background.DWColor());
+        const __m128i Tol = _mm_set1_epi8((char)FMath::Clamp(Tolerance, 0, 255));
+        uint32 Histograms[4][kLumaHistogramBins] = {};  // one per lane, so increments do not chain
+        while (i + 4 <= Num)
+        {
+            __m128i LumaSum = _mm_setzero_si128();
+            __m128i LumaSqSum = _mm_setzero_si128();
+            for (int32 Step = 0; Step < kFlushSteps && i + 4 <= Num; ++Step, i += 4)
             {
-                OutError = FString::Printf(TEXT("Unexpected zip signature: 0x%08x"), Sig);
-                return false;
+                const __m128i Px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Pixels + i));
+                const __m128i Luma = SseLuma4(Px);
+                const __m128i Luma16 = _mm_packs_epi32(Luma, _mm_setzero_si128());
+                LumaSum = _mm_add_epi32(LumaSum, Luma);
+                LumaSqSum = _mm_add_epi32(LumaSqSum, _mm_madd_epi16(Luma16, Luma16));
+                Out.Background += (uint32)FMath::CountBits((uint64)SseBackgroundMask4(Px, Bg, Tol));
+
+                alignas(16) uint32 Lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(Lanes), _mm_srli_epi32(Luma, 3));
+                ++Histograms[0][Lanes[0]];
+                ++Histograms[1][Lanes[1]];
+                ++Histograms[2][Lanes[2]];
+                ++Histograms[3][Lanes[3]];
             }
+            Out.Luma += SseSumLanes(LumaSum);
+            Out.LumaSq += SseSumLanes(LumaSqSum);
+        }
+        for (int32 Bin = 0; Bin < kLumaHistogramBins; ++Bin)
+        {
+            Out.Histogram[Bin] += Histograms[0][Bin] + Histograms[1][Bin] + Histograms[2][Bin] + Histograms[3][Bin];
+        }
+#endif
+        for (; i < Num; ++i)
+        {
+            const uint32 Luma = PixelLuma(Pixels[i]);
+            Out.Luma += Luma;
+            Out.LumaSq += Luma * Luma;
+            Out.Background += IsBackgroundPixel(Pixels[i], Background, Tolerance) ? 1u : 0u;
+            ++Out.Histogram[Luma >> 3];
+        }
+    }
 
-            uint16 Version = 0;
-            uint16 Flags = 0;
-            uint16 Method = 0;
-            uint16 ModTime = 0;
-            uint16 ModDate = 0;
-            uint32 Crc32 = 0;
-            uint32 CompSize = 0;
-            uint32 UncompSize = 0;
-            uint16 NameLen = 0;
-            uint16 ExtraLen = 0;
+    // Index of the first pixel in [Begin, End) that differs from the background, or End.
+    static int32 FindFirstContentPixel(const FColor* Row, int32 Begin, int32 End, const FColor& Background, int32 Tolerance)
+    {
+        int32 i = Begin;
+#if ASSETSNAPSHOT_WITH_SSE2
+        const __m128i Bg = _mm_set1_epi32((int32)Background.DWColor());
+        const __m128i Tol = _mm_set1_epi8((char)FMath::Clamp(Tolerance, 0, 255));
+        for (; i + 4 <= End; i += 4)
+        {
+            const int32 Content = ~SseBackgroundMask4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Row + i)), Bg, Tol) & 0xF;
+            if (Content != 0)
+            {
+                return i + (int32)FMath::CountTrailingZeros((uint32)Content);
+            }
+        }
+#endif
+        for (; i < End; ++i)
+        {
+            if (!IsBackgroundPixel(Row[i], Background, Tolerance))
+            {
+                return i;
+            }
+        }
+        return End;
+    }
 
-            if (!ReadLE16(*Ar, Version) ||
-                !ReadLE16(*Ar, Flags) ||
-                !ReadLE16(*Ar, Method) ||
-                !ReadLE16(*Ar, ModTime) ||
-                !ReadLE16(*Ar, ModDate) ||
-                !ReadLE32(*Ar, Crc32) ||
-                !ReadLE32(*Ar, CompSize) ||
-                !ReadLE32(*Ar, UncompSize) ||
-                !ReadLE16(*Ar, NameLen) ||
-                !ReadLE16(*Ar, ExtraLen))
+    // Index of the last pixel in [Begin, End) that differs from the background, or Begin - 1.
+    static int32 FindLastContentPixel(const FColor* Row, int32 Begin, int32 End, const FColor& Background, int32 Tolerance)
+    {
+        int32 i = End;
+#if ASSETSNAPSHOT_WITH_SSE2
+        const __m128i Bg = _mm_set1_epi32((int32)Background.DWColor());
+        const __m128i Tol = _mm_set1_epi8((char)FMath::Clamp(Tolerance, 0, 255));
+        for (; i - 4 >= Begin; i -= 4)
+        {
+            const int32 Content = ~SseBackgroundMask4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Row + i - 4)), Bg, Tol) & 0xF;
+            if (Content != 0)
             {
-                OutError = TEXT("Failed to read zip local header.");
-                return false;
+                return i - 4 + (int32)FMath::FloorLog2((uint32)Content);
+            }
+        }
+#endif
+        for (; i > Begin; --i)
+        {
+            if (!IsBackgroundPixel(Row[i - 1], Background, Tolerance))
+            {
+                return i - 1;
             }
+        }
+        return Begin - 1;
+    }
 
-            TArray<uint8> NameBytes;
-            NameBytes.SetNumUninitialized(NameLen);
-            Ar->Serialize(NameBytes.GetData(), NameLen);
+    // ============================================================================
+    // AUTO-CROP
+    // ============================================================================
+    // With bAutoCropPreviews, full-size frames are encoded from the bounding box
+    // of everything that differs from the background (the corner pixel), plus
+    // padding, optionally widened to a square. The rect goes to meta.json so the
+    // explorer can re-center; tiers and animated previews stay uncropped.
+    // ============================================================================
+    static const int32 kAutoCropBackgroundTolerance = 6;  // per channel
+    static const int32 kAutoCropMinSize = 16;
 
-            FString Name;
-            if (NameLen > 0)
+    static FIntRect ComputeCropRect(const TArray<FColor>& Pixels, int32 Resolution)
+    {
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        if (!Settings || !Settings->bAutoCropPreviews || Resolution <= kAutoCropMinSize || Pixels.Num() != Resolution * Resolution)
+        {
+            return FIntRect();
+        }
+
+        const FColor Background = Pixels[0];
+        int32 MinX = Resolution;
+        int32 MinY = Resolution;
+        int32 MaxX = -1;
+        int32 MaxY = -1;
+        for (int32 Y = 0; Y < Resolution; ++Y)
+        {
+            const FColor* Row = Pixels.GetData() + Y * Resolution;
+            const int32 First = FindFirstContentPixel(Row, 0, Resolution, Background, kAutoCropBackgroundTolerance);
+            if (First == Resolution)
             {
-                FUTF8ToTCHAR Conv(reinterpret_cast<const ANSICHAR*>(NameBytes.GetData()), NameBytes.Num());
-                Name = FString(Conv.Length(), Conv.Get());
+                continue;
             }
+            // Only the span outside what is already known needs scanning from the right.
+            const int32 Known = FMath::Max(MaxX, First);
+            const int32 Last = FMath::Max(Known, FindLastContentPixel(Row, Known + 1, Resolution, Background, kAutoCropBackgroundTolerance));
+            MinX = FMath::Min(MinX, First);
+            MaxX = FMath::Max(MaxX, Last);
+            MinY = FMath::Min(MinY, Y);
+            MaxY = Y;
+        }
+        if (MaxX < 0)
+        {
+            return FIntRect();  // blank frame; nothing to center on
+        }
 
-            if (ExtraLen > 0)
+        const int32 Padding = FMath::RoundToInt(Resolution * FMath::Clamp(Settings->AutoCropPaddingPercent, 0.0f, 50.0f) / 100.0f);
+        FIntRect Rect(
+            FMath::Max(0, MinX - Padding),
+            FMath::Max(0, MinY - Padding),
+            FMath::Min(Resolution, MaxX + 1 + Padding),
+            FMath::Min(Resolution, MaxY + 1 + Padding));
+
+        if (Settings->bAutoCropSquare)
+        {
+            const int32 Side = FMath::Max(Rect.Width(), Rect.Height());
+            const FIntPoint Center = Rect.Min + FIntPoint(Rect.Width() / 2, Rect.Height() / 2);
+            const int32 X0 = FMath::Clamp(Center.X - Side / 2, 0, Resolution - Side);
+            const int32 Y0 = FMath::Clamp(Center.Y - Side / 2, 0, Resolution - Side);
+            Rect = FIntRect(X0, Y0, X0 + Side, Y0 + Side);
+        }
+
+        // Grow tiny rects around their center so single-pixel content still encodes sensibly.
+        if (Rect.Width() < kAutoCropMinSize || Rect.Height() < kAutoCropMinSize)
+        {
+            const int32 GrowX = FMath::Max(0, kAutoCropMinSize - Rect.Width());
+            const int32 GrowY = FMath::Max(0, kAutoCropMinSize - Rect.Height());
+            const int32 X0 = FMath::Clamp(Rect.Min.X - GrowX / 2, 0, Resolution - (Rect.Width() + GrowX));
+            const int32 Y0 = FMath::Clamp(Rect.Min.Y - GrowY / 2, 0, Resolution - (Rect.Height() + GrowY));
+            Rect = FIntRect(X0, Y0, X0 + Rect.Width() + GrowX, Y0 + Rect.Height() + GrowY);
+        }
+
+        return (Rect.Width() == Resolution && Rect.Height() == Resolution) ? FIntRect() : Rect;
+    }
+
+    // ============================================================================
+    // ASYNC WEBP ENCODE
+    // ============================================================================
+    // Captured frames are compressed on task-graph workers while the game thread
+    // renders the next ones. Pixel buffers are pooled so steady-state captures do
+    // not allocate; zip entries carry the pending task until ResolveZipEntries.
+    // ============================================================================
+    using FPixelBuffer = TSharedRef<TArray<FColor>, ESPMode::ThreadSafe>;
+
+    static const int32 kMaxPooledPixelBuffers = 16;
+
+    class FPixelBufferPool
+    {
+    public:
+        FPixelBuffer Acquire()
+        {
+            FScopeLock Lock(&Mutex);
+            if (Free.Num() > 0)
             {
-                Ar->Seek(Ar->Tell() + ExtraLen);
+                return Free.Pop(EAllowShrinking::No);
             }
+            return MakeShared<TArray<FColor>, ESPMode::ThreadSafe>();
+        }
 
-            if (Method != 0)
+        // Buffers still referenced elsewhere (kept for animated packing) are left to their owners.
+        void Release(const FPixelBuffer& Buffer)
+        {
+            FScopeLock Lock(&Mutex);
+            if (Buffer.IsUnique() && Free.Num() < kMaxPooledPixelBuffers)
             {
-                OutError = FString::Printf(TEXT("Unsupported zip compression method: %d"), Method);
-                return false;
+                Free.Add(Buffer);
             }
+        }
 
-            TArray<uint8> Data;
-            Data.SetNumUninitialized(CompSize);
-            if (CompSize > 0)
+    private:
+        FCriticalSection Mutex;
+        TArray<FPixelBuffer> Free;
+    };
+
+    static FPixelBufferPool GPixelBufferPool;
+
+    // Takes ownership of Pixels; the buffer goes back to the pool once encoded.
+    static UE::Tasks::TTask<TArray<uint8>> LaunchWebPEncode(const FPixelBuffer& Pixels, int32 Width, int32 Height, const FWebPEncodeOptions& Options, const FIntRect& Crop = FIntRect())
+    {
+        return UE::Tasks::Launch(UE_SOURCE_LOCATION, [Pixels, Width, Height, Options, Crop]()
+        {
+            TArray<uint8> WebP;
+            if (!EncodeWebPFromBGRA(*Pixels, Width, Height, WebP, Options, Crop))
             {
-                Ar->Serialize(Data.GetData(), CompSize);
+                WebP.Reset();
             }
+            GPixelBufferPool.Release(Pixels);
+            return WebP;
+        });
+    }
 
-            if (Name.IsEmpty() || Name.EndsWith(TEXT("/")))
+    // Waits for frames still being encoded and moves their bytes into the entries, in order.
+    static void ResolveZipEntries(TArray<FZipEntry>& Entries)
+    {
+        for (FZipEntry& E : Entries)
+        {
+            if (!E.PendingData.IsValid())
             {
                 continue;
             }
-
-            if (!IsSafeZipRelPath(Name))
+            E.Data = MoveTemp(E.PendingData.GetResult());
+            E.PendingData = {};
+            if (E.Data.Num() == 0)
             {
-                OutError = FString::Printf(TEXT("Unsafe zip path: %s"), *Name);
-                return false;
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("WebP encode failed for %s"), *E.NameInZip);
             }
+        }
+    }
 
-            const FString RelPath = NormalizeImportRelPath(Name);
-            const FString DestPath = FPaths::ConvertRelativePathToFull(DestRoot / RelPath);
+    // ============================================================================
+    // ANIMATED PREVIEWS
+    // ============================================================================
+    // With bAnimatedPreviews, the kept frames of a multi-frame capture are packed
+    // into one animated WebP through WebPAnimEncoder, which stores only what
+    // changed between frames. Frame 0 stays as a still poster (0.webp).
+    // ============================================================================
+    static const int32 kMinAnimatedFrameMs = 20;
 
-            if (!IsImportableAssetFile(RelPath))
+    static bool IsAnimatedPreviewEnabled()
+    {
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        return Settings && Settings->bAnimatedPreviews;
+    }
+
+    static UE::Tasks::TTask<TArray<uint8>> LaunchAnimatedWebPEncode(
+        const TArray<TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe>>& Frames,
+        int32 Resolution,
+        const TArray<int32>& TimestampsMs,
+        const FWebPEncodeOptions& Options)
+    {
+        return UE::Tasks::Launch(UE_SOURCE_LOCATION, [Frames, Resolution, TimestampsMs, Options]()
+        {
+            TArray<uint8> Out;
+            WebPConfig Config;
+            WebPAnimEncoderOptions AnimOptions;
+            if (!MakeWebPConfig(Options, Config) || !WebPAnimEncoderOptionsInit(&AnimOptions))
             {
-                ++SkippedFiles;
-                continue;
+                return Out;
+            }
+            WebPAnimEncoder* Encoder = WebPAnimEncoderNew(Resolution, Resolution, &AnimOptions);
+            if (!Encoder)
+            {
+                return Out;
             }
 
-            if (Mode == EAssetSnapshotImportMode::SkipExisting && IFileManager::Get().FileExists(*DestPath))
+            // TimestampsMs holds each frame's start plus the end of the last one.
+            bool bOk = TimestampsMs.Num() == Frames.Num() + 1;
+            for (int32 i = 0; bOk && i < Frames.Num(); ++i)
             {
-                ++SkippedFiles;
-                continue;
+                const TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe>& Pixels = Frames[i];
+                WebPPicture Picture;
+                if (!WebPPictureInit(&Picture))
+                {
+                    bOk = false;
+                    break;
+                }
+                Picture.use_argb = 1;
+                Picture.width = Resolution;
+                Picture.height = Resolution;
+                bOk = WebPPictureImportBGRA(&Picture, reinterpret_cast<const uint8*>(Pixels->GetData()), Resolution * 4)
+                    && WebPAnimEncoderAdd(Encoder, &Picture, TimestampsMs[i], &Config);
+                WebPPictureFree(&Picture);
             }
 
-            IFileManager::Get().MakeDirectory(*FPaths::GetPath(DestPath), true);
-            if (!FFileHelper::SaveArrayToFile(Data, *DestPath))
+            WebPData Data;
+            WebPDataInit(&Data);
+            if (bOk && WebPAnimEncoderAdd(Encoder, nullptr, TimestampsMs.Last(), nullptr) && WebPAnimEncoderAssemble(Encoder, &Data))
             {
-                OutError = FString::Printf(TEXT("Failed to write file: %s"), *DestPath);
-                return false;
+                Out.Append(Data.bytes, (int32)Data.size);
+            }
+            else
+            {
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Animated WebP encode failed: %s"), UTF8_TO_TCHAR(WebPAnimEncoderGetError(Encoder)));
             }
+            WebPDataClear(&Data);
+            WebPAnimEncoderDelete(Encoder);
+            return Out;
+        });
+    }
 
-            if (DestPath.EndsWith(TEXT(".uasset")) || DestPath.EndsWith(TEXT(".umap")))
+    // With animated previews on, frames after the poster are only ever packed, so
+    // capture skips their still encode and keeps just the pixels.
+    static bool NeedsStillEncode(int32 FrameIndex)
+    {
+        return FrameIndex == 0 || !IsAnimatedPreviewEnabled();
+    }
+
+    static int32 GetAnimatedStepMs(float FrameIntervalSeconds)
+    {
+        return FMath::Max(kMinAnimatedFrameMs, FMath::RoundToInt(FrameIntervalSeconds * 1000.0f));
+    }
+
+    // Packs Frames into OutAnim and trims Frames to the poster. Returns false (and
+    // leaves the stills alone) when disabled or when frames lack kept pixels.
+    // Each frame starts at its own capture step, so a frame followed by dropped
+    // duplicates stays up for their steps too and the turntable keeps its pace.
+    static bool PackAnimatedPreview(TArray<FZipEntry>& Frames, float FrameIntervalSeconds, FZipEntry& OutAnim)
+    {
+        bool bPackable = IsAnimatedPreviewEnabled() && Frames.Num() > 1;
+        const int32 Resolution = Frames.Num() > 0 ? Frames[0].SourceResolution : 0;
+        TArray<TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe>> Pixels;
+        for (const FZipEntry& F : Frames)
+        {
+            bPackable = bPackable && F.SourcePixels.IsValid() && F.SourceResolution == Resolution
+                && F.SourcePixels->Num() == Resolution * Resolution;
+            if (bPackable)
             {
-                ImportedUAssetFiles.Add(DestPath);
+                Pixels.Add(F.SourcePixels);
             }
-            ++ImportedFiles;
+        }
+        if (!bPackable)
+        {
+            // Frames whose still was skipped in the expectation of packing get one now.
+            for (FZipEntry& F : Frames)
+            {
+                if (F.Data.Num() == 0 && !F.PendingData.IsValid() && F.SourcePixels.IsValid())
+                {
+                    F.PendingData = LaunchWebPEncode(F.SourcePixels.ToSharedRef(), F.SourceResolution, F.SourceResolution, GetWebPEncodeOptions(), F.CropRect);
+                }
+            }
+            return false;
         }
 
-        if (ImportedUAssetFiles.Num() > 0)
+        const int32 StepMs = GetAnimatedStepMs(FrameIntervalSeconds);
+        TArray<int32> TimestampsMs;
+        TimestampsMs.Reserve(Frames.Num() + 1);
+        for (const FZipEntry& F : Frames)
         {
-            FAssetRegistryModule& ARM = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-            ARM.Get().ScanFilesSynchronous(ImportedUAssetFiles, true);
+            TimestampsMs.Add((F.CaptureStep - Frames[0].CaptureStep) * StepMs);
         }
+        TimestampsMs.Add(TimestampsMs.Last() + StepMs);
 
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Import complete. Imported: %d, Skipped: %d"), ImportedFiles, SkippedFiles);
+        OutAnim.NameInZip = TEXT("anim.webp");
+        OutAnim.PendingData = LaunchAnimatedWebPEncode(Pixels, Resolution, TimestampsMs, GetWebPEncodeOptions());
+        Frames.SetNum(1);
         return true;
     }
 
-
-    static FString BuildSnapshotUrl(const FString& BaseUrl, const FString& PathTemplate, const FString& SnapshotId)
+    // ============================================================================
+    // PREVIEW TIERS
+    // ============================================================================
+    // Each kept frame is also written downscaled to the configured tier sizes
+    // (PreviewTierSizes, e.g. 128 and 256) as <frame>_<size>.webp, so grid
+    // thumbnails do not need the full-size frame. Tiers are filtered on the CPU
+    // from the frame already read back and encoded on task-graph workers.
+    // ============================================================================
+    static TArray<int32> GetPreviewTierSizes()
     {
-        FString Url = NormalizeBaseUrl(BaseUrl);
-
-        FString Path = PathTemplate;
-        Path.TrimStartAndEndInline();
-        if (Path.IsEmpty())
-        {
-            Path = TEXT("/download/{id}.zip");
-        }
-        if (!Path.StartsWith(TEXT("/")))
+        TArray<int32> Sizes;
+        if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
         {
-            Path = TEXT("/") + Path;
+            for (const int32 Size : Settings->PreviewTierSizes)
+            {
+                if (Size >= 16)
+                {
+                    Sizes.AddUnique(Size);
+                }
+            }
         }
-        Path.ReplaceInline(TEXT("{id}"), *SnapshotId);
-        return Url + Path;
+        Sizes.Sort();
+        return Sizes;
     }
 
-    static bool CheckServerHasHash(
-        const FString& BaseUrl,
-        const FString& PathTemplate,
-        const FString& Hash,
-        bool& OutExists)
+    // Frames keep their pixels past encoding only when something downstream needs them.
+    static bool ShouldKeepFramePixels()
     {
-        OutExists = false;
-        if (BaseUrl.IsEmpty() || PathTemplate.IsEmpty() || Hash.IsEmpty())
-        {
-            return false;
-        }
+        return IsAnimatedPreviewEnabled() || GetPreviewTierSizes().Num() > 0;
+    }
 
-        FString Url = NormalizeBaseUrl(BaseUrl);
+    // Box-filter downscale of a square BGRA frame: each output pixel is the mean of
+    // the source pixels it covers, so integer ratios (1024 -> 256) average 4x4 blocks.
+    static void DownscaleBox(const TArray<FColor>& Src, int32 SrcSize, int32 DstSize, TArray<FColor>& Dst)
+    {
+        Dst.SetNumUninitialized(DstSize * DstSize, EAllowShrinking::No);
 
-        FString Path = PathTemplate;
-        Path.TrimStartAndEndInline();
-        if (!Path.StartsWith(TEXT("/")))
+        TArray<int32> Spans;
+        Spans.SetNumUninitialized(DstSize + 1);
+        for (int32 i = 0; i <= DstSize; ++i)
         {
-            Path = TEXT("/") + Path;
+            Spans[i] = (int32)(((int64)i * SrcSize) / DstSize);
         }
-        Path.ReplaceInline(TEXT("{hash}"), *Hash);
-        Url += Path;
 
-        FEvent* DoneEvent = FPlatformProcess::GetSynchEventFromPool(true);
-        TAtomic<bool> bDone(false);
-        TAtomic<bool> bOk(false);
+        TArray<uint32> RowSums;
+        RowSums.SetNumUninitialized(SrcSize * 4);
+        for (int32 Y = 0; Y < DstSize; ++Y)
+        {
+            const int32 Y0 = Spans[Y];
+            const int32 Y1 = FMath::Max(Y0 + 1, Spans[Y + 1]);
 
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-        Request->SetURL(Url);
-        Request->SetVerb(TEXT("GET"));
-        Request->OnProcessRequestComplete().BindLambda(
-            [&](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+            // Sum the covered rows column by column first, then each span of columns.
+            FMemory::Memzero(RowSums.GetData(), RowSums.Num() * sizeof(uint32));
+            for (int32 SY = Y0; SY < Y1; ++SY)
             {
-                if (bSucceeded && Resp.IsValid() && Resp->GetResponseCode() == 200)
+                const uint8* Row = reinterpret_cast<const uint8*>(Src.GetData() + SY * SrcSize);
+                uint32* Sums = RowSums.GetData();
+                int32 i = 0;
+#if ASSETSNAPSHOT_WITH_SSE2
+                // Four pixels per step: bytes widened to 16 and then 32 bits.
+                const __m128i Zero = _mm_setzero_si128();
+                for (; i + 16 <= SrcSize * 4; i += 16)
                 {
-                    TSharedPtr<FJsonObject> Root;
-                    const FString Body = Resp->GetContentAsString();
-                    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
-                    if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
-                    {
-                        OutExists = Root->GetBoolField(TEXT("exists"));
-                        bOk = true;
-                    }
+                    const __m128i Px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row + i));
+                    const __m128i Lo = _mm_unpacklo_epi8(Px, Zero);
+                    const __m128i Hi = _mm_unpackhi_epi8(Px, Zero);
+                    __m128i* Out4 = reinterpret_cast<__m128i*>(Sums + i);
+                    _mm_storeu_si128(Out4 + 0, _mm_add_epi32(_mm_loadu_si128(Out4 + 0), _mm_unpacklo_epi16(Lo, Zero)));
+                    _mm_storeu_si128(Out4 + 1, _mm_add_epi32(_mm_loadu_si128(Out4 + 1), _mm_unpackhi_epi16(Lo, Zero)));
+                    _mm_storeu_si128(Out4 + 2, _mm_add_epi32(_mm_loadu_si128(Out4 + 2), _mm_unpacklo_epi16(Hi, Zero)));
+                    _mm_storeu_si128(Out4 + 3, _mm_add_epi32(_mm_loadu_si128(Out4 + 3), _mm_unpackhi_epi16(Hi, Zero)));
                 }
-                bDone = true;
-                DoneEvent->Trigger();
-            });
-
-        Request->ProcessRequest();
+#endif
+                for (; i < SrcSize * 4; ++i)
+                {
+                    Sums[i] += Row[i];
+                }
+            }
 
-        const double Start = FPlatformTime::Seconds();
-        while (!bDone && (FPlatformTime::Seconds() - Start) < 5.0)
-        {
-            FHttpModule::Get().GetHttpManager().Tick(0.01f);
-            FPlatformProcess::Sleep(0.01f);
+            FColor* Out = Dst.GetData() + Y * DstSize;
+            for (int32 X = 0; X < DstSize; ++X)
+            {
+                const int32 X0 = Spans[X];
+                const int32 X1 = FMath::Max(X0 + 1, Spans[X + 1]);
+                // One pixel's four channel sums are one vector.
+                alignas(16) uint32 Acc[4] = { 0, 0, 0, 0 };
+#if ASSETSNAPSHOT_WITH_SSE2
+                __m128i AccV = _mm_setzero_si128();
+                for (int32 SX = X0; SX < X1; ++SX)
+                {
+                    AccV = _mm_add_epi32(AccV, _mm_loadu_si128(reinterpret_cast<const __m128i*>(RowSums.GetData() + SX * 4)));
+                }
+                _mm_store_si128(reinterpret_cast<__m128i*>(Acc), AccV);
+#else
+                for (int32 SX = X0; SX < X1; ++SX)
+                {
+                    const uint32* Sum = RowSums.GetData() + SX * 4;
+                    Acc[0] += Sum[0];
+                    Acc[1] += Sum[1];
+                    Acc[2] += Sum[2];
+                    Acc[3] += Sum[3];
+                }
+#endif
+                const uint32 Count = (uint32)((X1 - X0) * (Y1 - Y0));
+                uint8* Px = reinterpret_cast<uint8*>(Out + X);
+                for (int32 c = 0; c < 4; ++c)
+                {
+                    Px[c] = (uint8)((Acc[c] + Count / 2) / Count);
+                }
+            }
         }
+    }
 
-        FPlatformProcess::ReturnSynchEventToPool(DoneEvent);
-        if (!bDone)
-        {
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("GetServerExportFilters: timeout waiting for %s"), *Url);
-        }
-        if (!bOk && bDone)
+    static UE::Tasks::TTask<TArray<uint8>> LaunchWebPTierEncode(const FPixelBuffer& Pixels, int32 Resolution, int32 TierSize, const FWebPEncodeOptions& Options)
+    {
+        return UE::Tasks::Launch(UE_SOURCE_LOCATION, [Pixels, Resolution, TierSize, Options]()
         {
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("GetServerExportFilters: no usable data from %s"), *Url);
-        }
-        return bOk;
+            FPixelBuffer Tier = GPixelBufferPool.Acquire();
+            DownscaleBox(*Pixels, Resolution, TierSize, *Tier);
+            TArray<uint8> WebP;
+            if (!EncodeWebPFromBGRA(*Tier, TierSize, TierSize, WebP, Options))
+            {
+                WebP.Reset();
+            }
+            GPixelBufferPool.Release(Tier);
+            GPixelBufferPool.Release(Pixels);
+            return WebP;
+        });
     }
 
-    static bool ResolveProjectIdFromServer(const FString& BaseUrl, const FString& SourcePath, int32& OutProjectId)
+    // ============================================================================
+    // DUPLICATE FRAMES
+    // ============================================================================
+    // Consecutive frames are compared on raw BGRA before encoding: both reduce to
+    // a 32x32 luma grid and count as the same picture when the grids differ by
+    // less than compression noise. Duplicates are dropped; after
+    // DuplicateFrameStopCount of them in a row the capture stops early.
+    // ============================================================================
+    static const int32 kFrameSignatureSize = 32;
+    static const float kDuplicateMeanLumaDelta = 1.0f;
+    static const int32 kDuplicateMaxLumaDelta = 6;
+
+    static int32 GCaptureDuplicateFrames = 0;
+
+    // Small is scratch space for the downscaled grid; both buffers are reused across calls.
+    static void ComputeFrameSignature(const TArray<FColor>& Pixels, int32 Resolution, TArray<FColor>& Small, TArray<uint8>& OutSignature)
     {
-        OutProjectId = 0;
-        if (BaseUrl.IsEmpty() || SourcePath.IsEmpty())
+        DownscaleBox(Pixels, Resolution, kFrameSignatureSize, Small);
+        OutSignature.SetNumUninitialized(Small.Num(), EAllowShrinking::No);
+        int32 i = 0;
+#if ASSETSNAPSHOT_WITH_SSE2
+        for (; i + 4 <= Small.Num(); i += 4)
         {
-            return false;
+            const __m128i Luma = SseLuma4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Small.GetData() + i)));
+            const __m128i Bytes = _mm_packus_epi16(_mm_packs_epi32(Luma, Luma), _mm_setzero_si128());
+            const int32 Packed = _mm_cvtsi128_si32(Bytes);
+            FMemory::Memcpy(OutSignature.GetData() + i, &Packed, 4);
         }
-
-        FString Url = NormalizeBaseUrl(BaseUrl);
-        Url += TEXT("/projects/resolve?source_path=");
-        Url += FGenericPlatformHttp::UrlEncode(SourcePath);
-        Url += TEXT("&auto_create=1");
-
-        TSharedPtr<FEvent> DoneEvent = MakeShareable(
-            FPlatformProcess::GetSynchEventFromPool(true),
-            [](FEvent* E) { FPlatformProcess::ReturnSynchEventToPool(E); });
-        TSharedRef<TAtomic<bool>> bDone = MakeShared<TAtomic<bool>>(false);
-        TSharedRef<TAtomic<bool>> bOk = MakeShared<TAtomic<bool>>(false);
-        TSharedRef<TAtomic<bool>> bAbandoned = MakeShared<TAtomic<bool>>(false);
-
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-        Request->SetURL(Url);
-        Request->SetVerb(TEXT("GET"));
-        Request->OnProcessRequestComplete().BindLambda(
-            [bDone, bOk, bAbandoned, DoneEvent, &OutProjectId](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
-            {
-                if (*bAbandoned)
-                {
-                    return;
-                }
-                if (bSucceeded && Resp.IsValid() && Resp->GetResponseCode() == 200)
-                {
-                    TSharedPtr<FJsonObject> Root;
-                    const FString Body = Resp->GetContentAsString();
-                    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
-                    if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
-                    {
-                        const TSharedPtr<FJsonValue> Value = Root->TryGetField(TEXT("project_id"));
-                        if (Value.IsValid() && Value->Type == EJson::Number)
-                        {
-                            OutProjectId = (int32)Value->AsNumber();
-                            if (OutProjectId > 0)
-                            {
-                                bOk->Store(true);
-                            }
-                        }
-                    }
-                }
-                bDone->Store(true);
-                DoneEvent->Trigger();
-            });
-
-        Request->ProcessRequest();
-
-        const double Start = FPlatformTime::Seconds();
-        while (!*bDone && (FPlatformTime::Seconds() - Start) < 5.0)
+#endif
+        for (; i < Small.Num(); ++i)
         {
-            FHttpModule::Get().GetHttpManager().Tick(0.01f);
-            FPlatformProcess::Sleep(0.01f);
+            OutSignature[i] = (uint8)PixelLuma(Small[i]);
         }
+    }
 
-        if (!*bDone)
+    // Sum and maximum of the per-cell luma differences of two signatures.
+    static void CompareFrameSignatures(const uint8* A, const uint8* B, int32 Num, int32& OutSum, int32& OutMax)
+    {
+        OutSum = 0;
+        OutMax = 0;
+        int32 i = 0;
+#if ASSETSNAPSHOT_WITH_SSE2
+        __m128i SumV = _mm_setzero_si128();
+        __m128i MaxV = _mm_setzero_si128();
+        for (; i + 16 <= Num; i += 16)
+        {
+            const __m128i VA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A + i));
+            const __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B + i));
+            const __m128i Delta = _mm_or_si128(_mm_subs_epu8(VA, VB), _mm_subs_epu8(VB, VA));
+            SumV = _mm_add_epi64(SumV, _mm_sad_epu8(Delta, _mm_setzero_si128()));
+            MaxV = _mm_max_epu8(MaxV, Delta);
+        }
+        alignas(16) uint64 Sums[2];
+        alignas(16) uint8 Maxes[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(Sums), SumV);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Maxes), MaxV);
+        OutSum = (int32)(Sums[0] + Sums[1]);
+        for (const uint8 Max : Maxes)
+        {
+            OutMax = FMath::Max(OutMax, (int32)Max);
+        }
+#endif
+        for (; i < Num; ++i)
         {
-            bAbandoned->Store(true);
-            Request->CancelRequest();
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("ResolveProjectIdFromServer: timeout waiting for %s"), *Url);
+            const int32 Delta = FMath::Abs((int32)A[i] - (int32)B[i]);
+            OutSum += Delta;
+            OutMax = FMath::Max(OutMax, Delta);
         }
-        return *bOk;
     }
 
-    static bool UploadZipToServer(
-        const FString& BaseUrl,
-        const FString& PathTemplate,
-        const FString& ZipPath,
-        int32 ProjectId)
+    class FDuplicateFrameFilter
     {
-        if (BaseUrl.IsEmpty() || ZipPath.IsEmpty() || ProjectId <= 0)
+    public:
+        FDuplicateFrameFilter()
         {
-            return false;
+            const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+            StopAfter = Settings ? FMath::Max(0, Settings->DuplicateFrameStopCount) : 0;
         }
 
-        FString Url = NormalizeBaseUrl(BaseUrl);
-
-        FString Path = PathTemplate;
-        Path.TrimStartAndEndInline();
-        if (Path.IsEmpty())
+        // True when the frame matches the last kept one and should be dropped.
+        bool IsDuplicate(const TArray<FColor>& Pixels, int32 Resolution)
         {
-            Path = TEXT("/assets/upload");
+            if (StopAfter <= 0 || Resolution < kFrameSignatureSize)
+            {
+                return false;
+            }
+            ComputeFrameSignature(Pixels, Resolution, Small, Signature);
+            if (Previous.Num() == Signature.Num())
+            {
+                int32 Sum = 0;
+                int32 Max = 0;
+                CompareFrameSignatures(Signature.GetData(), Previous.GetData(), Signature.Num(), Sum, Max);
+                if (Max <= kDuplicateMaxLumaDelta && (float)Sum / (float)Signature.Num() <= kDuplicateMeanLumaDelta)
+                {
+                    ++Consecutive;
+                    ++GCaptureDuplicateFrames;
+                    return true;
+                }
+            }
+            Swap(Previous, Signature);
+            Consecutive = 0;
+            return false;
         }
-        if (!Path.StartsWith(TEXT("/")))
+
+        bool ShouldStop() const
         {
-            Path = TEXT("/") + Path;
+            return StopAfter > 0 && Consecutive >= StopAfter;
         }
-        Url += Path;
 
-        TArray<uint8> ZipData;
-        if (!FFileHelper::LoadFileToArray(ZipData, *ZipPath))
+    private:
+        TArray<uint8> Previous;
+        TArray<uint8> Signature;   // scratch, reused per frame
+        TArray<FColor> Small;      // scratch, reused per frame
+        int32 StopAfter = 0;
+        int32 Consecutive = 0;
+    };
+
+    // ============================================================================
+    // FRAME STATISTICS
+    // ============================================================================
+    // Capture quality is judged on the raw readback: luma mean/variance, a coarse
+    // luma histogram and the fraction of pixels matching the background. The
+    // background is the median of the frame's border ring (subjects are framed
+    // with a margin), so a dark subject on a dark backdrop still counts as drawn
+    // wherever it differs from the backdrop. A frame is blank when nothing
+    // rendered, and low quality when the subject covers almost nothing or the
+    // whole frame is one flat value. Flat but lit swatches pass.
+    // ============================================================================
+    static const int32 kFrameBackgroundTolerance = 6;        // per channel, 8-bit
+    static const int32 kFrameHistogramBins = kLumaHistogramBins;
+    static const float kFrameHistogramMinShare = 0.001f;     // bins below this share are noise
+    static const float kFrameBlankBackgroundFraction = 0.999f;
+    static const float kFrameLowQualityBackgroundFraction = 0.97f;
+
+    struct FFrameStats
+    {
+        float LumaMean = 0.0f;
+        float LumaVariance = 0.0f;
+        float BackgroundFraction = 1.0f;
+        FColor Background = FColor::Black;
+        int32 HistogramBinsUsed = 0;
+
+        bool IsBlank() const
         {
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("UploadZipToServer: failed to read zip %s"), *ZipPath);
-            return false;
+            return BackgroundFraction >= kFrameBlankBackgroundFraction;
         }
 
-        const FString Boundary = FString::Printf(TEXT("----AssetSnapshotBoundary%s"), *FGuid::NewGuid().ToString(EGuidFormats::Digits));
-        const FString FileName = FPaths::GetCleanFilename(ZipPath);
-
-        auto AppendString = [](TArray<uint8>& Out, const FString& Text)
+        bool IsLowQuality() const
         {
-            FTCHARToUTF8 Utf8(*Text);
-            Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
-        };
+            return IsBlank() || BackgroundFraction >= kFrameLowQualityBackgroundFraction || HistogramBinsUsed <= 1;
+        }
 
-        TArray<uint8> Body;
-        AppendString(Body, TEXT("--") + Boundary + TEXT("\r\n"));
-        AppendString(Body, TEXT("Content-Disposition: form-data; name=\"project_id\"\r\n\r\n"));
-        AppendString(Body, FString::FromInt(ProjectId) + TEXT("\r\n"));
+        TSharedRef<FJsonObject> ToJson() const
+        {
+            TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+            Obj->SetNumberField(TEXT("luma_mean"), LumaMean);
+            Obj->SetNumberField(TEXT("luma_variance"), LumaVariance);
+            Obj->SetNumberField(TEXT("background_fraction"), BackgroundFraction);
+            Obj->SetStringField(TEXT("background"), Background.ToHex());
+            Obj->SetNumberField(TEXT("histogram_bins"), (double)HistogramBinsUsed);
+            return Obj;
+        }
+    };
 
-        AppendString(Body, TEXT("--") + Boundary + TEXT("\r\n"));
-        AppendString(Body, TEXT("Content-Disposition: form-data; name=\"file\"; filename=\"") + FileName + TEXT("\"\r\n"));
-        AppendString(Body, TEXT("Content-Type: application/zip\r\n\r\n"));
-        Body.Append(ZipData);
-        AppendString(Body, TEXT("\r\n--") + Boundary + TEXT("--\r\n"));
+    // Per kept frame of the exported asset (reset in ExportPlannedAsset).
+    static TArray<TSharedPtr<FJsonValue>> GCaptureFrameStats;
 
-        TSharedPtr<FEvent> DoneEvent = MakeShareable(
-            FPlatformProcess::GetSynchEventFromPool(true),
-            [](FEvent* E) { FPlatformProcess::ReturnSynchEventToPool(E); });
-        TSharedRef<TAtomic<bool>> bDone = MakeShared<TAtomic<bool>>(false);
-        TSharedRef<TAtomic<bool>> bOk = MakeShared<TAtomic<bool>>(false);
-        TSharedRef<TAtomic<bool>> bAbandoned = MakeShared<TAtomic<bool>>(false);
+    // Per-channel median of the outermost rows and columns of a square frame.
+    static FColor EstimateFrameBackground(const TArray<FColor>& Pixels, int32 Size)
+    {
+        uint32 Counts[3][256] = {};
+        uint32 Total = 0;
+        auto Add = [&Counts, &Total](const FColor& C)
+        {
+            ++Counts[0][C.R];
+            ++Counts[1][C.G];
+            ++Counts[2][C.B];
+            ++Total;
+        };
+        for (int32 I = 0; I < Size; ++I)
+        {
+            Add(Pixels[I]);
+            Add(Pixels[(Size - 1) * Size + I]);
+            Add(Pixels[I * Size]);
+            Add(Pixels[I * Size + Size - 1]);
+        }
 
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-        Request->SetURL(Url);
-        Request->SetVerb(TEXT("POST"));
-        Request->SetHeader(TEXT("Content-Type"), TEXT("multipart/form-data; boundary=") + Boundary);
-        Request->SetContent(MoveTemp(Body));
-        Request->OnProcessRequestComplete().BindLambda(
-            [bDone, bOk, bAbandoned, DoneEvent](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+        uint8 Median[3] = {};
+        for (int32 Channel = 0; Channel < 3; ++Channel)
+        {
+            uint32 Seen = 0;
+            for (int32 V = 0; V < 256; ++V)
             {
-                if (*bAbandoned)
-                {
-                    return;
-                }
-                if (bSucceeded && Resp.IsValid() && Resp->GetResponseCode() == 200)
+                Seen += Counts[Channel][V];
+                if (Seen * 2 >= Total)
                 {
-                    bOk->Store(true);
+                    Median[Channel] = (uint8)V;
+                    break;
                 }
-                bDone->Store(true);
-                DoneEvent->Trigger();
-            });
+            }
+        }
+        return FColor(Median[0], Median[1], Median[2], 255);
+    }
 
-        Request->ProcessRequest();
+    static FFrameStats AnalyzeFrame(const TArray<FColor>& Pixels)
+    {
+        FFrameStats Stats;
+        if (Pixels.Num() == 0)
+        {
+            return Stats;
+        }
 
-        const double Start = FPlatformTime::Seconds();
-        while (!*bDone && (FPlatformTime::Seconds() - Start) < 10.0)
+        // Captures are square; anything else falls back to the clear colour.
+        const int32 Size = FMath::RoundToInt(FMath::Sqrt((double)Pixels.Num()));
+        if (Size * Size == Pixels.Num())
         {
-            FHttpModule::Get().GetHttpManager().Tick(0.01f);
-            FPlatformProcess::Sleep(0.01f);
+            Stats.Background = EstimateFrameBackground(Pixels, Size);
         }
 
-        if (!*bDone)
+        FFramePixelSums Sums;
+        AccumulateFramePixels(Pixels.GetData(), Pixels.Num(), Stats.Background, kFrameBackgroundTolerance, Sums);
+
+        const double N = (double)Pixels.Num();
+        const double Mean = (double)Sums.Luma / N;
+        Stats.LumaMean = (float)Mean;
+        Stats.LumaVariance = (float)FMath::Max(0.0, (double)Sums.LumaSq / N - Mean * Mean);
+        Stats.BackgroundFraction = (float)((double)Sums.Background / N);
+        for (const uint32 Count : Sums.Histogram)
         {
-            bAbandoned->Store(true);
-            Request->CancelRequest();
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("UploadZipToServer: timeout waiting for %s"), *Url);
+            Stats.HistogramBinsUsed += ((double)Count / N >= kFrameHistogramMinShare) ? 1 : 0;
         }
-        return *bOk;
+        return Stats;
     }
 
-    static void SendUploadEvent(const FString& BaseUrl, const FString& AssetName)
+    static bool MakeBlackWebP(int32 Size, TArray<uint8>& OutWebP)
     {
-        if (BaseUrl.IsEmpty())
+        if (Size <= 0)
         {
-            return;
+            return false;
         }
 
-        FString Url = NormalizeBaseUrl(BaseUrl);
-        Url += TEXT("/events/notify");
-
-        const int32 Total = GAssetSnapshotExportTotal;
-        const int32 Current = GAssetSnapshotExportCurrent;
-        const int32 Percent = Total > 0 ? FMath::RoundToInt((double)Current / (double)Total * 100.0) : 0;
-
-        TSharedPtr<FJsonObject> Root = MakeShared<FJsonObject>();
-        Root->SetNumberField(TEXT("batch_id"), GAssetSnapshotExportBatchId);
-        Root->SetNumberField(TEXT("current"), Current);
-        Root->SetNumberField(TEXT("total"), Total);
-        Root->SetNumberField(TEXT("percent"), Percent);
-        Root->SetStringField(TEXT("name"), AssetName);
-        Root->SetStringField(TEXT("source"), TEXT("plugin"));
+        TArray<FColor> Pixels;
+        Pixels.Init(FColor::Black, Size * Size);
+        return EncodeWebPFromBGRA(Pixels, Size, Size, OutWebP, GetWebPEncodeOptions());
+    }
 
-        FString Body;
-        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Body);
-        FJsonSerializer::Serialize(Root.ToSharedRef(), Writer);
+    static void AddBlackPreview(
+        TArray<TSharedPtr<FJsonValue>>& PreviewFiles,
+        TArray<FZipEntry>& ZipEntries,
+        int32 Size)
+    {
+        TArray<uint8> WebP;
+        if (!MakeBlackWebP(Size, WebP))
+        {
+            return;
+        }
 
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-        Request->SetURL(Url);
-        Request->SetVerb(TEXT("POST"));
-        Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-        Request->SetContentAsString(Body);
-        Request->ProcessRequest();
+        FZipEntry E;
+        E.NameInZip = TEXT("0.webp");
+        E.Data = MoveTemp(WebP);
+        PreviewFiles.Add(MakeShared<FJsonValueString>(E.NameInZip));
+        ZipEntries.Add(MoveTemp(E));
     }
 
-static bool GetServerExportFilters(
-        const FString& BaseUrl,
-        FString& OutInclude,
-        FString& OutExclude)
+    // Moves captured frames into the zip; with animated previews on, anim.webp plus
+    // the 0.webp poster. Every remaining still also gets its preview tiers.
+    static void AddCapturedFrames(
+        TArray<FZipEntry>& Frames,
+        float FrameIntervalSeconds,
+        TArray<TSharedPtr<FJsonValue>>& PreviewFiles,
+        TArray<FZipEntry>& ZipEntries,
+        const TSharedRef<FJsonObject>& Root)
     {
-        OutInclude.Reset();
-        OutExclude.Reset();
-        if (BaseUrl.IsEmpty())
+        const int32 FrameCount = Frames.Num();
+        FZipEntry Anim;
+        if (PackAnimatedPreview(Frames, FrameIntervalSeconds, Anim))
         {
-            return false;
+            Root->SetStringField(TEXT("preview_animated"), Anim.NameInZip);
+            Root->SetNumberField(TEXT("preview_animated_frames"), (double)FrameCount);
+            Root->SetNumberField(TEXT("preview_animated_frame_ms"), (double)GetAnimatedStepMs(FrameIntervalSeconds));
+            ZipEntries.Add(MoveTemp(Anim));
         }
 
-        FString Url = NormalizeBaseUrl(BaseUrl);
-        Url += TEXT("/settings");
+        const TArray<int32> TierSizes = GetPreviewTierSizes();
+        const FWebPEncodeOptions TierOptions = GetWebPEncodeOptions();
+        TMap<int32, TArray<TSharedPtr<FJsonValue>>> TierFiles;
+        TArray<FZipEntry> TierEntries;
+        TArray<TSharedPtr<FJsonValue>> Crops;
+        for (FZipEntry& F : Frames)
+        {
+            if (F.CropRect.Area() > 0)
+            {
+                TSharedRef<FJsonObject> CropObj = MakeShared<FJsonObject>();
+                CropObj->SetStringField(TEXT("file"), F.NameInZip);
+                CropObj->SetNumberField(TEXT("x"), (double)F.CropRect.Min.X);
+                CropObj->SetNumberField(TEXT("y"), (double)F.CropRect.Min.Y);
+                CropObj->SetNumberField(TEXT("width"), (double)F.CropRect.Width());
+                CropObj->SetNumberField(TEXT("height"), (double)F.CropRect.Height());
+                Crops.Add(MakeShared<FJsonValueObject>(CropObj));
+            }
+            if (F.SourcePixels.IsValid() && F.SourcePixels->Num() == F.SourceResolution * F.SourceResolution)
+            {
+                for (const int32 Size : TierSizes)
+                {
+                    if (Size >= F.SourceResolution)
+                    {
+                        continue;
+                    }
+                    FZipEntry& Tier = TierEntries.AddDefaulted_GetRef();
+                    Tier.NameInZip = FString::Printf(TEXT("%s_%d.webp"), *FPaths::GetBaseFilename(F.NameInZip), Size);
+                    Tier.PendingData = LaunchWebPTierEncode(F.SourcePixels.ToSharedRef(), F.SourceResolution, Size, TierOptions);
+                    TierFiles.FindOrAdd(Size).Add(MakeShared<FJsonValueString>(Tier.NameInZip));
+                }
+            }
+            F.SourcePixels.Reset();
+            PreviewFiles.Add(MakeShared<FJsonValueString>(F.NameInZip));
+            ZipEntries.Add(MoveTemp(F));
+        }
 
-        static double LastFetchAt = 0.0;
-        static double FetchStartedAt = 0.0;
-        static FString CachedInclude;
-        static FString CachedExclude;
-        static bool bCacheValid = false;
-        static bool bFetchInFlight = false;
-        static TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> ActiveRequest;
-        static FCriticalSection CacheMutex;
+        if (Crops.Num() > 0)
+        {
+            Root->SetArrayField(TEXT("preview_crops"), Crops);
+        }
 
-        const double Now = FPlatformTime::Seconds();
-        FHttpModule::Get().GetHttpManager().Tick(0.0f);
+        if (TierFiles.Num() > 0)
         {
-            FScopeLock Lock(&CacheMutex);
-            if (bCacheValid && (Now - LastFetchAt) < 5.0)
+            TSharedRef<FJsonObject> Tiers = MakeShared<FJsonObject>();
+            for (const TPair<int32, TArray<TSharedPtr<FJsonValue>>>& Pair : TierFiles)
             {
-                OutInclude = CachedInclude;
-                OutExclude = CachedExclude;
-                return true;
+                Tiers->SetArrayField(FString::FromInt(Pair.Key), Pair.Value);
             }
+            Root->SetObjectField(TEXT("preview_tiers"), Tiers);
+            ZipEntries.Append(MoveTemp(TierEntries));
         }
+    }
 
-        if (bFetchInFlight)
+    // Waits for the preview encodes and removes every file whose encode failed from
+    // the zip and from the meta fields that list it, so no empty .webp ships.
+    // Returns the number of files dropped.
+    static int32 DropFailedPreviews(
+        TArray<FZipEntry>& ZipEntries,
+        TArray<TSharedPtr<FJsonValue>>& PreviewFiles,
+        const TSharedRef<FJsonObject>& Root)
+    {
+        ResolveZipEntries(ZipEntries);
+        TSet<FString> Failed;
+        ZipEntries.RemoveAll([&Failed](const FZipEntry& E)
         {
-            if ((Now - FetchStartedAt) > 5.0)
+            if (E.Data.Num() > 0)
             {
-                bFetchInFlight = false;
+                return false;
             }
-            return false;
+            Failed.Add(E.NameInZip);
+            return true;
+        });
+        if (Failed.Num() == 0)
+        {
+            return 0;
         }
 
-        bFetchInFlight = true;
-        FetchStartedAt = Now;
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-        ActiveRequest = Request;
-        Request->SetURL(Url);
-        Request->SetVerb(TEXT("GET"));
-        Request->OnProcessRequestComplete().BindLambda(
-            [&](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+        auto IsFailedName = [&Failed](const TSharedPtr<FJsonValue>& Value)
+        {
+            return Value.IsValid() && Failed.Contains(Value->AsString());
+        };
+        PreviewFiles.RemoveAll(IsFailedName);
+
+        const TArray<TSharedPtr<FJsonValue>>* Crops = nullptr;
+        if (Root->TryGetArrayField(TEXT("preview_crops"), Crops))
+        {
+            TArray<TSharedPtr<FJsonValue>> Kept = *Crops;
+            Kept.RemoveAll([&Failed](const TSharedPtr<FJsonValue>& Value)
             {
-                FString Include;
-                FString Exclude;
-                const int32 Code = Resp.IsValid() ? Resp->GetResponseCode() : -1;
-                const FString Body = Resp.IsValid() ? Resp->GetContentAsString() : FString();
-                bool bParsed = false;
-                if (bSucceeded && Resp.IsValid() && Code == 200)
-                {
-                    TSharedPtr<FJsonObject> Root;
-                    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
-                    if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
-                    {
-                        if (const TSharedPtr<FJsonValue> SkipVal = Root->TryGetField(TEXT("skip_export_if_on_server")))
-                        {
-                            bool bParsedSkip = false;
-                            bool bEnabled = true;
-                            if (SkipVal->Type == EJson::Boolean)
-                            {
-                                bEnabled = SkipVal->AsBool();
-                                bParsedSkip = true;
-                            }
-                            else if (SkipVal->Type == EJson::String)
-                            {
-                                const FString Raw = SkipVal->AsString().ToLower();
-                                if (Raw == TEXT("1") || Raw == TEXT("true") || Raw == TEXT("yes") || Raw == TEXT("on"))
-                                {
-                                    bEnabled = true;
-                                    bParsedSkip = true;
-                                }
-                                else if (Raw == TEXT("0") || Raw == TEXT("false") || Raw == TEXT("no") || Raw == TEXT("off"))
-                                {
-                                    bEnabled = false;
-                                    bParsedSkip = true;
-                                }
-                            }
-                            else if (SkipVal->Type == EJson::Number)
-                            {
-                                bEnabled = SkipVal->AsNumber() != 0.0;
-                                bParsedSkip = true;
-                            }
-
-                            if (bParsedSkip)
-                            {
-                                GAssetSnapshotServerSkipKnown = true;
-                                GAssetSnapshotServerSkipEnabled = bEnabled;
-                            }
-                        }
-
-                        auto JoinArray = [](const TArray<TSharedPtr<FJsonValue>>& Values) -> FString
-                        {
-                            TArray<FString> Parts;
-                            for (const TSharedPtr<FJsonValue>& V : Values)
-                            {
-                                if (!V.IsValid())
-                                {
-                                    continue;
-                                }
-                                const FString S = V->AsString().TrimStartAndEnd();
-                                if (!S.IsEmpty())
-                                {
-                                    Parts.Add(S);
-                                }
-                            }
-                            return FString::Join(Parts, TEXT(","));
-                        };
+                const TSharedPtr<FJsonObject>* Obj = nullptr;
+                FString File;
+                return Value->TryGetObject(Obj) && (*Obj)->TryGetStringField(TEXT("file"), File) && Failed.Contains(File);
+            });
+            if (Kept.Num() > 0)
+            {
+                Root->SetArrayField(TEXT("preview_crops"), Kept);
+            }
+            else
+            {
+                Root->RemoveField(TEXT("preview_crops"));
+            }
+        }
 
-                        if (const TSharedPtr<FJsonValue> IncludeVal = Root->TryGetField(TEXT("export_include_types")))
-                        {
-                            if (IncludeVal->Type == EJson::Array)
-                            {
-                                Include = JoinArray(IncludeVal->AsArray());
-                            }
-                            else if (IncludeVal->Type == EJson::String)
-                            {
-                                Include = IncludeVal->AsString();
-                            }
-                        }
-                        if (const TSharedPtr<FJsonValue> ExcludeVal = Root->TryGetField(TEXT("export_exclude_types")))
-                        {
-                            if (ExcludeVal->Type == EJson::Array)
-                            {
-                                Exclude = JoinArray(ExcludeVal->AsArray());
-                            }
-                            else if (ExcludeVal->Type == EJson::String)
-                            {
-                                Exclude = ExcludeVal->AsString();
-                            }
-                        }
-                        bParsed = true;
-                        UE_LOG(LogAssetSnapshot, Log, TEXT("GetServerExportFilters: parsed include='%s' exclude='%s'"), *Include, *Exclude);
-                    }
-                    else
-                    {
-                        UE_LOG(LogAssetSnapshot, Warning, TEXT("GetServerExportFilters: JSON parse failed body='%s'"), *Body);
-                    }
-                }
-                else
+        const TSharedPtr<FJsonObject>* Tiers = nullptr;
+        if (Root->TryGetObjectField(TEXT("preview_tiers"), Tiers))
+        {
+            TSharedRef<FJsonObject> KeptTiers = MakeShared<FJsonObject>();
+            for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*Tiers)->Values)
+            {
+                TArray<TSharedPtr<FJsonValue>> Files = Pair.Value->AsArray();
+                Files.RemoveAll(IsFailedName);
+                if (Files.Num() > 0)
                 {
-                    UE_LOG(LogAssetSnapshot, Warning, TEXT("GetServerExportFilters: request failed ok=%s code=%d"),
-                        bSucceeded ? TEXT("true") : TEXT("false"),
-                        Code);
+                    KeptTiers->SetArrayField(Pair.Key, Files);
                 }
+            }
+            if (KeptTiers->Values.Num() > 0)
+            {
+                Root->SetObjectField(TEXT("preview_tiers"), KeptTiers);
+            }
+            else
+            {
+                Root->RemoveField(TEXT("preview_tiers"));
+            }
+        }
 
-                {
-                    FScopeLock Lock(&CacheMutex);
-                    CachedInclude = Include;
-                    CachedExclude = Exclude;
-                    LastFetchAt = FPlatformTime::Seconds();
-                    bCacheValid = bParsed;
-                }
-                bFetchInFlight = false;
-                ActiveRequest.Reset();
-            });
+        FString Animated;
+        if (Root->TryGetStringField(TEXT("preview_animated"), Animated) && Failed.Contains(Animated))
+        {
+            Root->RemoveField(TEXT("preview_animated"));
+            Root->RemoveField(TEXT("preview_animated_frames"));
+            Root->RemoveField(TEXT("preview_animated_frame_ms"));
+        }
 
-        Request->ProcessRequest();
-        // Short tick to allow completion without stalling export too long.
-        for (int32 i = 0; i < 100; ++i)
+        const TArray<TSharedPtr<FJsonValue>>* Frames = nullptr;
+        if (Root->TryGetArrayField(TEXT("frames"), Frames))
         {
-            FHttpModule::Get().GetHttpManager().Tick(0.01f);
-            FPlatformProcess::Sleep(0.01f);
+            for (const TSharedPtr<FJsonValue>& Frame : *Frames)
             {
-                FScopeLock Lock(&CacheMutex);
-                if (bCacheValid)
+                const TSharedPtr<FJsonObject>* Obj = nullptr;
+                FString File;
+                if (Frame->TryGetObject(Obj) && (*Obj)->TryGetStringField(TEXT("file"), File) && Failed.Contains(File))
                 {
-                    OutInclude = CachedInclude;
-                    OutExclude = CachedExclude;
-                    return true;
+                    (*Obj)->RemoveField(TEXT("file"));
                 }
             }
         }
-        return false;
+
+        UE_LOG(LogAssetSnapshot, Warning, TEXT("Dropped %d preview file(s) whose WebP encode failed"), Failed.Num());
+        return Failed.Num();
     }
 
-    static bool IsServerSkipExportEnabled(const FString& BaseUrl, bool& OutEnabled)
+    static FString NormalizeRelPath(const FString& Path)
     {
-        const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(BaseUrl);
-        OutEnabled = Server.bSkipExportIfOnServer;
-        return Server.bAvailable;
+        FString P = Path;
+        P.ReplaceInline(TEXT("\\"), TEXT("/"));
+        while (P.StartsWith(TEXT("/")))
+        {
+            P.RightChopInline(1);
+        }
+        return P;
     }
 
-    static bool PackageToMainFileAbs(const FString& PackageName, FString& OutAbs)
+    // Project-layout zips can contain "<Project>/Content/...".
+    // We keep the project folder, but drop the intermediate "Content" segment
+    // so imports become "<Project>/..." under the target Content root.
+    static FString NormalizeImportRelPath(const FString& RelPath)
     {
-        FString AbsUAsset = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
-        if (FPaths::FileExists(AbsUAsset))
+        FString P = NormalizeRelPath(RelPath);
+        if (P.IsEmpty())
         {
-            OutAbs = AbsUAsset;
-            return true;
+            return P;
         }
 
-        FString AbsUMap = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetMapPackageExtension());
-        if (FPaths::FileExists(AbsUMap))
+        TArray<FString> Parts;
+        P.ParseIntoArray(Parts, TEXT("/"), true);
+        if (Parts.Num() >= 2 && Parts[1].Equals(TEXT("Content"), ESearchCase::IgnoreCase))
         {
-            OutAbs = AbsUMap;
-            return true;
+            Parts.RemoveAt(1);
+            return FString::Join(Parts, TEXT("/"));
         }
-
-        OutAbs = AbsUAsset; // best effort
-        return false;
+        if (Parts.Num() >= 1 && Parts[0].Equals(TEXT("Content"), ESearchCase::IgnoreCase))
+        {
+            Parts.RemoveAt(0);
+            return FString::Join(Parts, TEXT("/"));
+        }
+        return P;
     }
 
-    static void AddIfExistsAllowlisted(const FString& AbsPath, const FString& ContentDir, TSet<FString>& SeenRel, TArray<FString>& OutRel, TArray<FString>& OutAbs, int64& TotalBytes)
+    static bool IsSafeZipRelPath(const FString& RelPath)
     {
-        if (!FPaths::FileExists(AbsPath))
+        FString P = NormalizeRelPath(RelPath);
+        if (P.IsEmpty())
         {
-            return;
+            return false;
         }
-
-        FString Rel = AbsPath;
-        FPaths::MakePathRelativeTo(Rel, *ContentDir);
-        Rel = NormalizeRelPath(Rel);
-
-        const FString Ext = FPaths::GetExtension(Rel, true).ToLower();
-        const bool bAllowed = (Ext == TEXT(".uasset") || Ext == TEXT(".uexp") || Ext == TEXT(".ubulk") || Ext == TEXT(".uptnl") || Ext == TEXT(".umap"));
-        if (!bAllowed)
+        if (P.Contains(TEXT(":")))
         {
-            return;
+            return false;
         }
-
-        if (SeenRel.Contains(Rel))
+        TArray<FString> Parts;
+        P.ParseIntoArray(Parts, TEXT("/"), true);
+        for (const FString& Part : Parts)
         {
-            return;
+            if (Part == TEXT("..") || Part == TEXT("."))
+            {
+                return false;
+            }
         }
-
-        SeenRel.Add(Rel);
-        OutRel.Add(Rel);
-        OutAbs.Add(AbsPath);
-        TotalBytes += (int64)IFileManager::Get().FileSize(*AbsPath);
+        return true;
     }
 
-    static void GatherFilesOnDiskForPackage(const FString& PackageName, TSet<FString>& SeenRel, TArray<FString>& OutRel, TArray<FString>& OutAbs, int64& TotalBytes)
+    static bool IsImportableAssetFile(const FString& RelPath)
     {
-        const FString ContentDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
-
-        FString MainAbs;
-        PackageToMainFileAbs(PackageName, MainAbs);
-        const FString BaseNoExt = FPaths::ChangeExtension(MainAbs, TEXT(""));
-
-        AddIfExistsAllowlisted(MainAbs, ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
-        AddIfExistsAllowlisted(BaseNoExt + TEXT(".uexp"), ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
-        AddIfExistsAllowlisted(BaseNoExt + TEXT(".ubulk"), ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
-        AddIfExistsAllowlisted(BaseNoExt + TEXT(".uptnl"), ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
+        const FString Ext = FString::Printf(TEXT(".%s"), *FPaths::GetExtension(RelPath, false)).ToLower();
+        return Ext == TEXT(".uasset")
+            || Ext == TEXT(".uexp")
+            || Ext == TEXT(".ubulk")
+            || Ext == TEXT(".uptnl")
+            || Ext == TEXT(".umap");
     }
 
-    static void GatherGameDependenciesPackages(const FString& RootPackage, TArray<FString>& OutPackages)
-{
-    OutPackages.Reset();
-
-    // We only care about /Game packages for recovery.
-    if (!RootPackage.StartsWith(TEXT("/Game/")))
+    static bool ExtractZipStore(const FString& ZipPath, const FString& DestRoot, EAssetSnapshotImportMode Mode, FString& OutError)
     {
-        OutPackages.Add(RootPackage);
-        return;
-    }
+        TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*ZipPath));
+        if (!Ar)
+        {
+            OutError = FString::Printf(TEXT("Failed to open zip: %s"), *ZipPath);
+            return false;
+        }
 
-    IAssetRegistry& AR = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+        int32 ImportedFiles = 0;
+        int32 SkippedFiles = 0;
+        TArray<FString> ImportedUAssetFiles;
 
-    // Use the default dependency query here (UE versions differ in how flags are interpreted).
+        while (!Ar->AtEnd())
+        {
+            uint32 Sig = 0;
+            if (!ReadLE32(*Ar, Sig))
+            {
+                OutError = TEXT("Failed to read zip signature.");
+                return false;
+            }
 
-    TArray<FName> Queue;
-    TSet<FName> Seen;
+            if (Sig == 0x02014b50 || Sig == 0x06054b50)
+            {
+                // Central directory or end of central directory; we're done.
+                break;
+            }
 
-    const FName RootPkg(*RootPackage);
-    Queue.Add(RootPkg);
-    Seen.Add(RootPkg);
+            if (Sig != 0x04034b50)
+            {
+                OutError = FString::Printf(TEXT("Unexpected zip signature: 0x%08x"), Sig);
+                return false;
+            }
 
-    for (int32 Qi = 0; Qi < Queue.Num(); ++Qi)
-    {
-        const FName Cur = Queue[Qi];
+            uint16 Version = 0;
+            uint16 Flags = 0;
+            uint16 Method = 0;
+            uint16 ModTime = 0;
+            uint16 ModDate = 0;
+            uint32 Crc32 = 0;
+            uint32 CompSize = 0;
+            uint32 UncompSize = 0;
+            uint16 NameLen = 0;
+            uint16 ExtraLen = 0;
 
-        TArray<FName> Deps;
-        AR.GetDependencies(Cur, Deps, UE::AssetRegistry::EDependencyCategory::Package);
+            if (!ReadLE16(*Ar, Version) ||
+                !ReadLE16(*Ar, Flags) ||
+                !ReadLE16(*Ar, Method) ||
+                !ReadLE16(*Ar, ModTime) ||
+                !ReadLE16(*Ar, ModDate) ||
+                !ReadLE32(*Ar, Crc32) ||
+                !ReadLE32(*Ar, CompSize) ||
+                !ReadLE32(*Ar, UncompSize) ||
+                !ReadLE16(*Ar, NameLen) ||
+                !ReadLE16(*Ar, ExtraLen))
+            {
+                OutError = TEXT("Failed to read zip local header.");
+                return false;
+            }
 
-        for (const FName& Dep : Deps)
-        {
-            const FString DepStr = Dep.ToString();
-            if (!DepStr.StartsWith(TEXT("/Game/")))
+            TArray<uint8> NameBytes;
+            NameBytes.SetNumUninitialized(NameLen);
+            Ar->Serialize(NameBytes.GetData(), NameLen);
+
+            FString Name;
+            if (NameLen > 0)
             {
-                continue;
+                FUTF8ToTCHAR Conv(reinterpret_cast<const ANSICHAR*>(NameBytes.GetData()), NameBytes.Num());
+                Name = FString(Conv.Length(), Conv.Get());
             }
-            if (Seen.Contains(Dep))
+
+            if (ExtraLen > 0)
             {
-                continue;
+                Ar->Seek(Ar->Tell() + ExtraLen);
             }
 
-            Seen.Add(Dep);
-            Queue.Add(Dep);
-        }
-    }
+            if (Method != 0)
+            {
+                OutError = FString::Printf(TEXT("Unsupported zip compression method: %d"), Method);
+                return false;
+            }
 
-    // Deterministic output.
-    for (const FName& Pkg : Seen)
-    {
-        OutPackages.Add(Pkg.ToString());
-    }
-    OutPackages.Sort();
-}
+            TArray<uint8> Data;
+            Data.SetNumUninitialized(CompSize);
+            if (CompSize > 0)
+            {
+                Ar->Serialize(Data.GetData(), CompSize);
+            }
 
-    struct FMeshStats
-    {
-        int64 Triangles = 0;
-        int64 Vertices = 0;
-        int32 LODs = 0;
-        bool bNaniteEnabled = false;
-        FString CollisionComplexity;
-        FVector ApproxSize = FVector::ZeroVector; // cm
-    };
+            if (Name.IsEmpty() || Name.EndsWith(TEXT("/")))
+            {
+                continue;
+            }
 
-    static FMeshStats GetStaticMeshStats(UStaticMesh* SM)
-    {
-        FMeshStats S;
-        if (!SM)
-        {
-            return S;
-        }
+            if (!IsSafeZipRelPath(Name))
+            {
+                OutError = FString::Printf(TEXT("Unsafe zip path: %s"), *Name);
+                return false;
+            }
 
-        const FBoxSphereBounds B = SM->GetBounds();
-        S.ApproxSize = B.BoxExtent * 2.0f;
+            const FString RelPath = NormalizeImportRelPath(Name);
+            const FString DestPath = FPaths::ConvertRelativePathToFull(DestRoot / RelPath);
 
-        if (SM->GetRenderData() && SM->GetRenderData()->LODResources.Num() > 0)
-        {
-            const FStaticMeshLODResources& LOD0 = SM->GetRenderData()->LODResources[0];
-            S.Triangles = (int64)LOD0.GetNumTriangles();
-            S.Vertices = (int64)LOD0.GetNumVertices();
-            S.LODs = SM->GetRenderData()->LODResources.Num();
-        }
+            if (!IsImportableAssetFile(RelPath))
+            {
+                ++SkippedFiles;
+                continue;
+            }
 
-#if WITH_EDITOR
-    #if ENGINE_MAJOR_VERSION > 5 || (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 6)
-        S.bNaniteEnabled = SM->GetNaniteSettings().bEnabled || SM->IsNaniteForceEnabled();
-    #else
-        S.bNaniteEnabled = SM->NaniteSettings.bEnabled || SM->IsNaniteForceEnabled();
-    #endif
-#else
-        S.bNaniteEnabled = false;
-#endif
+            if (Mode == EAssetSnapshotImportMode::SkipExisting && IFileManager::Get().FileExists(*DestPath))
+            {
+                ++SkippedFiles;
+                continue;
+            }
 
-        if (UBodySetup* BS = SM->GetBodySetup())
-        {
-            switch (BS->CollisionTraceFlag)
+            IFileManager::Get().MakeDirectory(*FPaths::GetPath(DestPath), true);
+            if (!FFileHelper::SaveArrayToFile(Data, *DestPath))
             {
-            case CTF_UseDefault: S.CollisionComplexity = TEXT("UseDefault"); break;
-            case CTF_UseSimpleAsComplex: S.CollisionComplexity = TEXT("UseSimpleAsComplex"); break;
-            case CTF_UseComplexAsSimple: S.CollisionComplexity = TEXT("UseComplexAsSimple"); break;
-            case CTF_UseSimpleAndComplex: S.CollisionComplexity = TEXT("UseSimpleAndComplex"); break;
-            default: S.CollisionComplexity = TEXT("Unknown"); break;
+                OutError = FString::Printf(TEXT("Failed to write file: %s"), *DestPath);
+                return false;
+            }
+
+            if (DestPath.EndsWith(TEXT(".uasset")) || DestPath.EndsWith(TEXT(".umap")))
+            {
+                ImportedUAssetFiles.Add(DestPath);
             }
+            ++ImportedFiles;
         }
-        else
+
+        if (ImportedUAssetFiles.Num() > 0)
         {
-            S.CollisionComplexity = TEXT("None");
+            FAssetRegistryModule& ARM = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+            ARM.Get().ScanFilesSynchronous(ImportedUAssetFiles, true);
         }
 
-        return S;
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Import complete. Imported: %d, Skipped: %d"), ImportedFiles, SkippedFiles);
+        return true;
     }
 
-    static FMeshStats GetSkeletalMeshStats(USkeletalMesh* SK)
+
+    static FString BuildSnapshotUrl(const FString& BaseUrl, const FString& PathTemplate, const FString& SnapshotId)
     {
-        FMeshStats S;
-        if (!SK)
+        FString Url = NormalizeBaseUrl(BaseUrl);
+
+        FString Path = PathTemplate;
+        Path.TrimStartAndEndInline();
+        if (Path.IsEmpty())
         {
-            return S;
+            Path = TEXT("/download/{id}.zip");
         }
-
-        const FBoxSphereBounds B = SK->GetBounds();
-        S.ApproxSize = B.BoxExtent * 2.0f;
-
-        const FSkeletalMeshRenderData* RD = SK->GetResourceForRendering();
-        if (RD && RD->LODRenderData.Num() > 0)
+        if (!Path.StartsWith(TEXT("/")))
         {
-            S.LODs = RD->LODRenderData.Num();
-            const FSkeletalMeshLODRenderData& LOD0 = RD->LODRenderData[0];
-            S.Triangles = (int64)LOD0.GetTotalFaces();
-            S.Vertices = (int64)LOD0.GetNumVertices();
+            Path = TEXT("/") + Path;
         }
-
-        S.bNaniteEnabled = false;
-        S.CollisionComplexity = TEXT("N/A");
-        return S;
+        Path.ReplaceInline(TEXT("{id}"), *SnapshotId);
+        return Url + Path;
     }
 
-    static float ComputeCameraDistanceFromBounds(float SphereRadius, float FovDeg, float Padding)
+    // Hashes the server confirmed (or that were uploaded) in this session. Only
+    // positive answers are cached; "missing" is re-checked on the next run.
+    static TSet<FString> GServerKnownHashes;
+
+    static FString MakeServerHashKey(const FString& BaseUrl, const FString& Hash)
     {
-        const float HalfFovRad = FMath::DegreesToRadians(FovDeg * 0.5f);
-        const float Dist = (SphereRadius / FMath::Tan(HalfFovRad)) * Padding;
-        return FMath::Max(50.0f, Dist);
+        return NormalizeBaseUrl(BaseUrl) + TEXT("|") + Hash;
     }
 
-    static void WarmupWorld(UWorld* World, float Seconds)
+    static void RememberServerHash(const FString& BaseUrl, const FString& Hash)
     {
-        if (!World || Seconds <= 0.f)
+        if (!Hash.IsEmpty())
         {
-            return;
+            GServerKnownHashes.Add(MakeServerHashKey(BaseUrl, Hash));
         }
+    }
+
+    // ============================================================================
+    // SERVER HASH CHECKS
+    // ============================================================================
+    // "Does the server already have this hash?" is an async request. Batches start
+    // the checks of the next assets ahead of time (a few in parallel), so planning
+    // an asset only waits for an answer that is usually already there.
+    // ============================================================================
+    static const float kServerHashCheckTimeoutSeconds = 5.0f;
+    static const int32 kServerHashCheckMaxAhead = 8;
+
+    struct FServerHashCheck
+    {
+        TAtomic<bool> bDone{ false };
+        TAtomic<bool> bOk{ false };
+        TAtomic<bool> bExists{ false };
+        TAtomic<bool> bAbandoned{ false };
+        FString Url;
+        double StartSec = 0.0;
+        TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> Request;
+    };
+
+    using FServerHashCheckRef = TSharedRef<FServerHashCheck, ESPMode::ThreadSafe>;
 
-        const float Dt = 1.f / 60.f;
-        const int32 Steps = FMath::Max(1, FMath::CeilToInt(Seconds / Dt));
-        for (int32 i = 0; i < Steps; ++i)
+    // Started and not yet consumed, by MakeServerHashKey.
+    static TMap<FString, FServerHashCheckRef> GServerHashChecks;
+
+    static int32 CountServerHashChecksInFlight()
+    {
+        int32 InFlight = 0;
+        for (const TPair<FString, FServerHashCheckRef>& Pair : GServerHashChecks)
         {
-            World->Tick(LEVELTICK_All, Dt);
-            IStreamingManager::Get().Tick(Dt);
-            FlushRenderingCommands();
+            InFlight += Pair.Value->bDone.Load() ? 0 : 1;
         }
-        IStreamingManager::Get().BlockTillAllRequestsFinished(Seconds, false);
-        FPlatformProcess::Sleep(kWarmupPauseSeconds);
-
+        return InFlight;
     }
 
-    static void BlockStreamingAndCompiles(UWorld* World)
+    // Starts (or finds) the check for Hash. Null when the answer is already known,
+    // the backend is short-circuited, or a lookahead check would exceed the cap.
+    static TSharedPtr<FServerHashCheck, ESPMode::ThreadSafe> BeginServerHashCheck(
+        const FString& BaseUrl,
+        const FString& PathTemplate,
+        const FString& Hash,
+        bool bLookahead = false)
     {
-        if (!World)
+        if (BaseUrl.IsEmpty() || PathTemplate.IsEmpty() || Hash.IsEmpty())
         {
-            return;
+            return nullptr;
         }
-
-        const float Dt = 1.f / 60.f;
-        for (int32 i = 0; i < 4; ++i)
+        const FString Key = MakeServerHashKey(BaseUrl, Hash);
+        if (GServerKnownHashes.Contains(Key))
         {
-            World->Tick(LEVELTICK_All, Dt);
-            IStreamingManager::Get().Tick(Dt);
+            return nullptr;
+        }
+        if (const FServerHashCheckRef* Existing = GServerHashChecks.Find(Key))
+        {
+            return *Existing;
+        }
+        if (bLookahead && CountServerHashChecksInFlight() >= kServerHashCheckMaxAhead)
+        {
+            return nullptr;
         }
 
-        IStreamingManager::Get().BlockTillAllRequestsFinished(kWarmupSeconds, false);
-        FlushRenderingCommands();
-#if WITH_EDITOR
-        FAssetCompilingManager::Get().FinishAllCompilation();
-#endif
-    }
-
-    static int32 ClampPreviewResolution(int32 InResolution)
-    {
-        return FMath::Clamp(InResolution, 128, 2048);
-    }
+        FString Path = PathTemplate;
+        Path.TrimStartAndEndInline();
+        if (!Path.StartsWith(TEXT("/")))
+        {
+            Path = TEXT("/") + Path;
+        }
+        Path.ReplaceInline(TEXT("{hash}"), *Hash);
 
-    static int32 GetMaterialPreviewResolution(UMaterialInterface* Mat, int32 Fallback)
-    {
-        if (!Mat)
+        if (!BackendAllowRequest(TEXT("hash check")))
         {
-            return ClampPreviewResolution(Fallback);
+            return nullptr;
         }
 
-        TArray<UTexture*> Used;
-        Mat->GetUsedTextures(Used);
+        FServerHashCheckRef Check = MakeShared<FServerHashCheck, ESPMode::ThreadSafe>();
+        Check->Url = NormalizeBaseUrl(BaseUrl) + Path;
+        Check->StartSec = FPlatformTime::Seconds();
 
-        int32 MaxDim = 0;
-        for (UTexture* Tex : Used)
-        {
-            if (!Tex)
-            {
-                continue;
-            }
-            MaxDim = FMath::Max(MaxDim, (int32)Tex->GetSurfaceWidth());
-            MaxDim = FMath::Max(MaxDim, (int32)Tex->GetSurfaceHeight());
-        }
-
-        const int32 Base = (MaxDim > 0) ? MaxDim : Fallback;
-        return FMath::Max(kMinMaterialResolution, ClampPreviewResolution(Base));
+        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+        Request->SetURL(Check->Url);
+        Request->SetVerb(TEXT("GET"));
+        Request->SetTimeout(kServerHashCheckTimeoutSeconds);
+        // The check owns the request, so the callback must not own the check.
+        Request->OnProcessRequestComplete().BindLambda(
+            [WeakCheck = TWeakPtr<FServerHashCheck, ESPMode::ThreadSafe>(Check)](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+            {
+                const TSharedPtr<FServerHashCheck, ESPMode::ThreadSafe> Check = WeakCheck.Pin();
+                if (!Check || Check->bAbandoned.Load())
+                {
+                    return;
+                }
+                BackendRecordResult(IsBackendReachable(Resp, bSucceeded));
+                if (bSucceeded && Resp.IsValid() && Resp->GetResponseCode() == 200)
+                {
+                    TSharedPtr<FJsonObject> Root;
+                    const FString Body = Resp->GetContentAsString();
+                    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
+                    if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
+                    {
+                        Check->bExists.Store(Root->GetBoolField(TEXT("exists")));
+                        Check->bOk.Store(true);
+                    }
+                }
+                Check->bDone.Store(true);
+            });
+        Check->Request = Request;
+        GServerHashChecks.Add(Key, Check);
+        Request->ProcessRequest();
+        return Check;
     }
 
-    static int32 GetTexturePreviewResolution(UTexture2D* Tex, int32 Fallback)
+    static bool CheckServerHasHashCached(
+        const FString& BaseUrl,
+        const FString& PathTemplate,
+        const FString& Hash,
+        bool& OutExists)
     {
-        return ClampPreviewResolution(kTexturePreviewResolution);
-    }
+        OutExists = false;
+        const FString Key = MakeServerHashKey(BaseUrl, Hash);
+        if (GServerKnownHashes.Contains(Key))
+        {
+            OutExists = true;
+            return true;
+        }
 
-    static void ComputeTextureCaptureSize(UTexture2D* Tex, int32 Fallback, int32& OutWidth, int32& OutHeight)
-    {
-        const int32 Target = ClampPreviewResolution(kTexturePreviewResolution);
-        OutWidth = Target;
-        OutHeight = Target;
+        const TSharedPtr<FServerHashCheck, ESPMode::ThreadSafe> Check = BeginServerHashCheck(BaseUrl, PathTemplate, Hash);
+        if (!Check)
+        {
+            return false;
+        }
+
+        // Measured from when the check started, so lookahead checks rarely wait at all.
+        while (!Check->bDone.Load() && (FPlatformTime::Seconds() - Check->StartSec) < kServerHashCheckTimeoutSeconds + 1.0)
+        {
+            FHttpModule::Get().GetHttpManager().Tick(0.01f);
+            if (!Check->bDone.Load())
+            {
+                FPlatformProcess::Sleep(0.01f);
+            }
+        }
+        GServerHashChecks.Remove(Key);
+
+        if (!Check->bDone.Load())
+        {
+            Check->bAbandoned.Store(true);
+            Check->Request->CancelRequest();
+            BackendRecordResult(false);
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("CheckServerHasHash: timeout waiting for %s"), *Check->Url);
+        }
+        Check->Request->OnProcessRequestComplete().Unbind();
+        Check->Request.Reset();
+        else if (!Check->bOk.Load())
+        {
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("CheckServerHasHash: no usable data from %s"), *Check->Url);
+        }
+        OutExists = Check->bExists.Load();
+        if (Check->bOk.Load() && OutExists)
+        {
+            RememberServerHash(BaseUrl, Hash);
+        }
+        return Check->bOk.Load();
     }
 
-    // Pick a stable "good for vision" view direction.
-    // Heuristic: look along the *thinnest* horizontal axis (X or Y). That usually produces
-    // a readable side-profile (e.g. pistols) instead of a front/back view.
-    static FVector ChooseStableViewDirFromBoxExtent(const FVector& BoxExtent)
+    static FString BuildResolveProjectUrl(const FString& BaseUrl, const FString& SourcePath)
     {
-        const bool bUseX = (BoxExtent.X < BoxExtent.Y);
-        const FVector Horizontal = bUseX ? FVector(-1.f, 0.f, 0.f) : FVector(0.f, -1.f, 0.f);
-        return (Horizontal + FVector(0.f, 0.f, 0.05f)).GetSafeNormal();
+        FString Url = NormalizeBaseUrl(BaseUrl);
+        Url += TEXT("/projects/resolve?source_path=");
+        Url += FGenericPlatformHttp::UrlEncode(SourcePath);
+        Url += TEXT("&auto_create=1");
+        return Url;
     }
 
-
-    static void SetupDefaultLights(FPreviewScene& Scene)
+    static bool ParseResolvedProjectId(FHttpResponsePtr Resp, bool bSucceeded, int32& OutProjectId)
     {
-        // Enhanced 3-point lighting for 360° view
-        // Key Light (Main) - Front-left, brighter
-        UDirectionalLightComponent* Key = NewObject<UDirectionalLightComponent>(GetTransientPackage());
-        Key->Intensity = 2.0f;  // Increased from 1.25
-		Key->SetCastShadows(true);
-        Key->LightColor = FColor::White;
-        Scene.AddComponent(Key, FTransform(FRotator(-30.f, 45.f, 0.f), FVector::ZeroVector));
-
-        // Fill Light (Secondary) - Front-right
-        UDirectionalLightComponent* Fill = NewObject<UDirectionalLightComponent>(GetTransientPackage());
-        Fill->Intensity = 1.2f;  // Increased from 0.625
-		Fill->SetCastShadows(false);
-        Fill->LightColor = FColor::White;
-        Scene.AddComponent(Fill, FTransform(FRotator(-20.f, -120.f, 0.f), FVector::ZeroVector));
-
-        // Rim Light (Back) - From behind for edge definition
-        UDirectionalLightComponent* Rim = NewObject<UDirectionalLightComponent>(GetTransientPackage());
-        Rim->Intensity = 1.0f;  // Increased from 0.75
-		Rim->SetCastShadows(false);
-        Rim->LightColor = FColor::White;
-        Scene.AddComponent(Rim, FTransform(FRotator(20.f, 180.f, 0.f), FVector::ZeroVector));
-
-        // Additional Side Lights for 360° coverage
-        UDirectionalLightComponent* SideLeft = NewObject<UDirectionalLightComponent>(GetTransientPackage());
-        SideLeft->Intensity = 0.8f;
-		SideLeft->SetCastShadows(false);
-        SideLeft->LightColor = FColor::White;
-        Scene.AddComponent(SideLeft, FTransform(FRotator(-25.f, -90.f, 0.f), FVector::ZeroVector));
+        OutProjectId = 0;
+        if (!bSucceeded || !Resp.IsValid() || Resp->GetResponseCode() != 200)
+        {
+            return false;
+        }
 
-        UDirectionalLightComponent* SideRight = NewObject<UDirectionalLightComponent>(GetTransientPackage());
-        SideRight->Intensity = 0.8f;
-		SideRight->SetCastShadows(false);
-        SideRight->LightColor = FColor::White;
-        Scene.AddComponent(SideRight, FTransform(FRotator(-25.f, 90.f, 0.f), FVector::ZeroVector));
+        TSharedPtr<FJsonObject> Root;
+        const FString Body = Resp->GetContentAsString();
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
+        if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+        {
+            return false;
+        }
 
-        // Sky Light - Overall ambient for consistent 360° lighting
-        USkyLightComponent* Sky = NewObject<USkyLightComponent>(GetTransientPackage());
-        Sky->Intensity = 0.5f;  // Increased from 0.25
-        Sky->LightColor = FColor::White;
-        Sky->bLowerHemisphereIsBlack = false;
-        Scene.AddComponent(Sky, FTransform::Identity);
+        const TSharedPtr<FJsonValue> Value = Root->TryGetField(TEXT("project_id"));
+        if (Value.IsValid() && Value->Type == EJson::Number)
+        {
+            OutProjectId = (int32)Value->AsNumber();
+        }
+        return OutProjectId > 0;
     }
 
-    static bool InitMaterialCaptureContext(FMaterialCaptureContext& Ctx)
+    static FString BuildUploadUrl(const FString& BaseUrl, const FString& PathTemplate)
     {
-        SetupDefaultLights(Ctx.Scene);
+        FString Url = NormalizeBaseUrl(BaseUrl);
 
-        Ctx.World = Ctx.Scene.GetWorld();
-        if (!Ctx.World)
+        FString Path = PathTemplate;
+        Path.TrimStartAndEndInline();
+        if (Path.IsEmpty())
         {
-            return false;
+            Path = TEXT("/assets/upload");
+        }
+        if (!Path.StartsWith(TEXT("/")))
+        {
+            Path = TEXT("/") + Path;
         }
+        return Url + Path;
+    }
 
-        UStaticMesh* Sphere = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
-        if (!Sphere)
+    static bool BuildUploadMultipartBody(const FString& ZipPath, int32 ProjectId, TArray<uint8>& OutBody, FString& OutContentType)
+    {
+        TArray<uint8> ZipData;
+        if (!FFileHelper::LoadFileToArray(ZipData, *ZipPath))
         {
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("UploadZipToServer: failed to read zip %s"), *ZipPath);
             return false;
         }
 
-        Ctx.Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
-        Ctx.Comp->SetStaticMesh(Sphere);
-        Ctx.Comp->SetMobility(EComponentMobility::Movable);
-        Ctx.Comp->RegisterComponentWithWorld(Ctx.World);
-        Ctx.Comp->SetWorldScale3D(FVector(2.0f));
-        Ctx.Comp->SetWorldRotation(FRotator(0.f, 270.f, 0.f));  // 270Жј
-        Ctx.Comp->UpdateBounds();
+        const FString Boundary = FString::Printf(TEXT("----AssetSnapshotBoundary%s"), *FGuid::NewGuid().ToString(EGuidFormats::Digits));
+        const FString FileName = FPaths::GetCleanFilename(ZipPath);
 
-        Ctx.Scene.AddComponent(Ctx.Comp, FTransform::Identity);
-        Ctx.Comp->MarkRenderStateDirty();
+        auto AppendString = [](TArray<uint8>& Out, const FString& Text)
+        {
+            FTCHARToUTF8 Utf8(*Text);
+            Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+        };
 
-        const FBoxSphereBounds B = Ctx.Comp->Bounds;
-        const float Radius = B.SphereRadius;
-        Ctx.Distance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.05f);
-        Ctx.ViewDir = FVector(1.f, 0.f, 0.f);
+        OutBody.Reset();
+        OutBody.Reserve(ZipData.Num() + 512);
+        AppendString(OutBody, TEXT("--") + Boundary + TEXT("\r\n"));
+        AppendString(OutBody, TEXT("Content-Disposition: form-data; name=\"project_id\"\r\n\r\n"));
+        AppendString(OutBody, FString::FromInt(ProjectId) + TEXT("\r\n"));
+
+        AppendString(OutBody, TEXT("--") + Boundary + TEXT("\r\n"));
+        AppendString(OutBody, TEXT("Content-Disposition: form-data; name=\"file\"; filename=\"") + FileName + TEXT("\"\r\n"));
+        AppendString(OutBody, TEXT("Content-Type: application/zip\r\n\r\n"));
+        OutBody.Append(ZipData);
+        AppendString(OutBody, TEXT("\r\n--") + Boundary + TEXT("--\r\n"));
+
+        OutContentType = TEXT("multipart/form-data; boundary=") + Boundary;
         return true;
     }
 
-    static void ForceComponentTexturesResident(UPrimitiveComponent* Comp)
-{
-    if (!Comp)
+    static FString BuildUploadEventBody(const FString& AssetName)
     {
-        return;
-    }
+        const int32 Total = GAssetSnapshotExportTotal;
+        const int32 Current = GAssetSnapshotExportCurrent;
+        const int32 Percent = Total > 0 ? FMath::RoundToInt((double)Current / (double)Total * 100.0) : 0;
 
-    TSet<UTexture*> UniqueTextures;
+        TSharedPtr<FJsonObject> Root = MakeShared<FJsonObject>();
+        Root->SetNumberField(TEXT("batch_id"), GAssetSnapshotExportBatchId);
+        Root->SetNumberField(TEXT("current"), Current);
+        Root->SetNumberField(TEXT("total"), Total);
+        Root->SetNumberField(TEXT("percent"), Percent);
+        Root->SetStringField(TEXT("name"), AssetName);
+        Root->SetStringField(TEXT("source"), TEXT("plugin"));
 
-    Comp->bForceMipStreaming = true;
+        FString Body;
+        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Body);
+        FJsonSerializer::Serialize(Root.ToSharedRef(), Writer);
+        return Body;
+    }
 
-    TArray<UTexture*> Used;
-    Comp->GetUsedTextures(Used, EMaterialQualityLevel::High);
-    for (UTexture* Tex : Used)
+    // Content folder the backend resolves an uploaded asset against: the top-level
+    // folder under /Game, or the content root for assets outside it.
+    static FString GetUploadResolvePath(const UObject* Asset)
     {
-        if (Tex)
+        FString ResolvePath = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+        if (!Asset)
         {
-            UniqueTextures.Add(Tex);
+            return ResolvePath;
+        }
+        const FString AssetPackageName = Asset->GetOutermost() ? Asset->GetOutermost()->GetName() : FString();
+        const FString PackagePath = FPackageName::GetLongPackagePath(AssetPackageName);
+        if (PackagePath.StartsWith(TEXT("/Game/")))
+        {
+            const FString RelativePath = PackagePath.Mid(6);
+            FString TopFolder;
+            FString Remainder;
+            if (RelativePath.Split(TEXT("/"), &TopFolder, &Remainder))
+            {
+                if (!TopFolder.IsEmpty())
+                {
+                    ResolvePath = FPaths::ConvertRelativePathToFull(
+                        FPaths::Combine(FPaths::ProjectContentDir(), TopFolder));
+                }
+            }
+            else if (!RelativePath.IsEmpty())
+            {
+                ResolvePath = FPaths::ConvertRelativePathToFull(
+                    FPaths::Combine(FPaths::ProjectContentDir(), RelativePath));
+            }
         }
+        return ResolvePath;
     }
 
-    for (UTexture* Tex : UniqueTextures)
+    // ============================================================================
+    // UPLOAD OUTBOX
+    // ============================================================================
+    // Uploads and progress events are never sent inline by the export. They are
+    // appended to <Saved>/AssetSnapshotOutbox/outbox.jsonl and delivered by the
+    // sender below (pumped between assets and by the module ticker). Records:
+    //   {"op":"add", "key":"upload:<hash>", ...}   pending delivery
+    //   {"op":"done","key":"upload:<hash>"}        delivered (or dropped)
+    // Replaying the journal on startup resumes anything that was still pending,
+    // so a backend outage no longer requires re-exporting to backfill the server.
+    // ============================================================================
+    static const int32 kOutboxMaxParallel = 4;
+    static const float kOutboxRequestTimeoutSeconds = 30.0f;
+    static const double kOutboxRetryBaseSeconds = 5.0;
+    static const double kOutboxRetryMaxSeconds = 300.0;
+    static const double kOutboxBatchDrainSeconds = 15.0;
+
+    enum class EOutboxKind : uint8
     {
-        Tex->SetForceMipLevelsToBeResident(30.0f);
+        Upload,
+        Event
+    };
+
+    struct FOutboxEntry
+    {
+        FString Key;
+        EOutboxKind Kind = EOutboxKind::Upload;
+        FString Hash;
+        FString BaseUrl;
+        FString ZipPath;
+        FString ResolvePath;
+        FString UploadPathTemplate;
+        FString EventBody;
+        int32 Attempts = 0;
+        double NextAttemptSec = 0.0;
+        bool bInFlight = false;
+    };
+
+    struct FUploadOutbox
+    {
+        bool bLoaded = false;
+        int32 InFlight = 0;
+        TMap<FString, FOutboxEntry> Pending;
+        TArray<FString> Order;
+        TSet<FString> Delivered;
+        TMap<FString, int32> ProjectIds;
+        TMap<FString, double> ResolveRetryAt;
+        TSet<FString> ResolvesInFlight;
+    };
+
+    static FUploadOutbox GUploadOutbox;
+
+    static FString GetOutboxJournalPath()
+    {
+        return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("AssetSnapshotOutbox") / TEXT("outbox.jsonl"));
     }
 
-    // Let the render thread process residency requests.
-    FlushRenderingCommands();
+    static TSharedRef<FJsonObject> OutboxEntryToJson(const FOutboxEntry& Entry)
+    {
+        TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+        Obj->SetStringField(TEXT("op"), TEXT("add"));
+        Obj->SetStringField(TEXT("key"), Entry.Key);
+        Obj->SetStringField(TEXT("kind"), Entry.Kind == EOutboxKind::Upload ? TEXT("upload") : TEXT("event"));
+        Obj->SetStringField(TEXT("hash"), Entry.Hash);
+        Obj->SetStringField(TEXT("base_url"), Entry.BaseUrl);
+        Obj->SetStringField(TEXT("zip"), Entry.ZipPath);
+        Obj->SetStringField(TEXT("resolve_path"), Entry.ResolvePath);
+        Obj->SetStringField(TEXT("upload_path"), Entry.UploadPathTemplate);
+        Obj->SetStringField(TEXT("event"), Entry.EventBody);
+        return Obj;
+    }
 
-    for (UTexture* Tex : UniqueTextures)
+    // Appends one condensed JSON record as a line (journal files are JSON-lines).
+    static void AppendJsonLine(const FString& FilePath, const TSharedRef<FJsonObject>& Record)
     {
-        Tex->WaitForStreaming();
+        FString Line;
+        TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+        FJsonSerializer::Serialize(Record, Writer);
+        Line += TEXT("\n");
+
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+        FFileHelper::SaveStringToFile(Line, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
     }
 
-    IStreamingManager::Get().BlockTillAllRequestsFinished(kWarmupSeconds, false);
-    Comp->MarkRenderStateDirty();
-}
+    static void AppendOutboxJournal(const TSharedRef<FJsonObject>& Record)
+    {
+        AppendJsonLine(GetOutboxJournalPath(), Record);
+    }
 
-    static bool CapturePreviewSceneToWebPBytes(
-        FPreviewScene& Scene,
-        const FVector& LookAt,
-        float Distance,
-        float FovDeg,
-        int32 Resolution,
-        TArray<uint8>& OutWebP,
-        const FVector& ViewDirFromLookAt,
-        float YawRotationDegrees = 0.0f)  // 360° view rotation
+    // Rewrites the journal with only the pending entries (or removes it when empty).
+    static void CompactOutboxJournal()
     {
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+        const FString JournalPath = GetOutboxJournalPath();
+        if (GUploadOutbox.Pending.Num() == 0)
         {
-            return false;
+            IFileManager::Get().Delete(*JournalPath, false, true, true);
+            return;
         }
 
-        AActor* CaptureActor = World->SpawnActor<AActor>();
-        USceneCaptureComponent2D* Capture = NewObject<USceneCaptureComponent2D>(CaptureActor);
-        Capture->RegisterComponentWithWorld(World);
-        CaptureActor->SetRootComponent(Capture);
-
-        UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
-        RT->InitCustomFormat(Resolution, Resolution, PF_B8G8R8A8, false);
-        RT->ClearColor = FLinearColor::Black;
-        RT->TargetGamma = 1.8f;  // Compromise between too dark (1.0) and too bright (2.2)
-        RT->UpdateResourceImmediate(true);
+        FString Text;
+        for (const FString& Key : GUploadOutbox.Order)
+        {
+            if (const FOutboxEntry* Entry = GUploadOutbox.Pending.Find(Key))
+            {
+                FString Line;
+                TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+                FJsonSerializer::Serialize(OutboxEntryToJson(*Entry), Writer);
+                Text += Line;
+                Text += TEXT("\n");
+            }
+        }
 
-        Capture->TextureTarget = RT;
-        Capture->FOVAngle = FovDeg;
-        Capture->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
-        Capture->bCaptureEveryFrame = false;
-        Capture->bCaptureOnMovement = false;
-        Capture->PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_RenderScenePrimitives;
-
-        // Make sure post process / exposure doesn't blow out and doesn't add noise
-        Capture->PostProcessSettings.bOverride_AutoExposureMethod = true;
-        Capture->PostProcessSettings.AutoExposureMethod = EAutoExposureMethod::AEM_Manual;
-        Capture->PostProcessSettings.bOverride_AutoExposureBias = true;
-        Capture->PostProcessSettings.AutoExposureBias = 0.0f;
-
-        Capture->PostProcessSettings.bOverride_MotionBlurAmount = true;
-        Capture->PostProcessSettings.MotionBlurAmount = 0.0f;
-        Capture->PostProcessSettings.bOverride_VignetteIntensity = true;
-        Capture->PostProcessSettings.VignetteIntensity = 0.0f;
-        Capture->PostProcessSettings.bOverride_SceneFringeIntensity = true;
-        Capture->PostProcessSettings.SceneFringeIntensity = 0.0f;
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(JournalPath), true);
+        FFileHelper::SaveStringToFile(Text, *JournalPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    }
 
-        // Position camera using a stable view direction
-        FVector ViewDir = ViewDirFromLookAt.IsNearlyZero() ? FVector(0.f, -1.f, 0.f) : ViewDirFromLookAt.GetSafeNormal();
-        
-        // Rotate camera around asset for 360° view
-        if (FMath::Abs(YawRotationDegrees) > 0.01f)
+    static void LoadOutboxJournal()
+    {
+        if (GUploadOutbox.bLoaded)
         {
-            FRotator Rotation(0.f, YawRotationDegrees, 0.f);
-            ViewDir = Rotation.RotateVector(ViewDir);
+            return;
         }
-        
-        const FVector CamPos = LookAt + (ViewDir * Distance);
-        const FRotator CamRot = (LookAt - CamPos).Rotation();
-        CaptureActor->SetActorLocation(CamPos);
-        CaptureActor->SetActorRotation(CamRot);
-
-#if WITH_EDITOR
-        FAssetCompilingManager::Get().FinishAllCompilation();
-#endif
-
-        // NO WARMUP - just capture
-        // Warmup is handled by frame discarding in multi-frame capture
-        Capture->CaptureScene();
-        FlushRenderingCommands();
+        GUploadOutbox.bLoaded = true;
 
-        FTextureRenderTargetResource* Res = RT->GameThread_GetRenderTargetResource();
-        if (!Res)
+        TArray<FString> Lines;
+        if (!FFileHelper::LoadFileToStringArray(Lines, *GetOutboxJournalPath()))
         {
-            return false;
+            return;
         }
 
-        TArray<FColor> Pixels;
-        Pixels.SetNumUninitialized(Resolution * Resolution);
-
-        FReadSurfaceDataFlags Flags(RCM_UNorm);
-        Flags.SetLinearToGamma(true);
-        const bool bReadOk = Res->ReadPixels(Pixels, Flags);
-        if (!bReadOk)
+        for (const FString& Line : Lines)
         {
-            CaptureActor->Destroy();
-            return false;
+            TSharedPtr<FJsonObject> Obj;
+            TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Line);
+            if (Line.IsEmpty() || !FJsonSerializer::Deserialize(Reader, Obj) || !Obj.IsValid())
+            {
+                // A torn last line after a crash is expected; skip it.
+                continue;
+            }
+
+            auto GetField = [](const TSharedPtr<FJsonObject>& Record, const TCHAR* Field)
+            {
+                FString Value;
+                Record->TryGetStringField(Field, Value);
+                return Value;
+            };
+
+            const FString Op = GetField(Obj, TEXT("op"));
+            const FString Key = GetField(Obj, TEXT("key"));
+            if (Key.IsEmpty())
+            {
+                continue;
+            }
+
+            if (Op == TEXT("done"))
+            {
+                GUploadOutbox.Pending.Remove(Key);
+                GUploadOutbox.Order.Remove(Key);
+                continue;
+            }
+
+            if (Op != TEXT("add") || GUploadOutbox.Pending.Contains(Key))
+            {
+                continue;
+            }
+
+            FOutboxEntry Entry;
+            Entry.Key = Key;
+            Entry.Kind = GetField(Obj, TEXT("kind")) == TEXT("event") ? EOutboxKind::Event : EOutboxKind::Upload;
+            Entry.Hash = GetField(Obj, TEXT("hash"));
+            Entry.BaseUrl = GetField(Obj, TEXT("base_url"));
+            Entry.ZipPath = GetField(Obj, TEXT("zip"));
+            Entry.ResolvePath = GetField(Obj, TEXT("resolve_path"));
+            Entry.UploadPathTemplate = GetField(Obj, TEXT("upload_path"));
+            Entry.EventBody = GetField(Obj, TEXT("event"));
+            GUploadOutbox.Order.Add(Key);
+            GUploadOutbox.Pending.Add(Key, MoveTemp(Entry));
         }
 
-        if (!EncodeWebPFromBGRA(Pixels, Resolution, Resolution, OutWebP))
+        CompactOutboxJournal();
+        if (GUploadOutbox.Pending.Num() > 0)
         {
-            CaptureActor->Destroy();
-            return false;
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Upload outbox: resumed %d pending entr(ies) from %s"), GUploadOutbox.Pending.Num(), *GetOutboxJournalPath());
         }
-
-        CaptureActor->Destroy();
-        return true;
     }
 
-    static bool CaptureStaticMeshMultiFrame(UStaticMesh* SM, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance)
+    static void EnqueueOutbox(FOutboxEntry&& Entry)
     {
-        if (!SM)
-        {
-            return false;
-        }
-
-        FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
-
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+        LoadOutboxJournal();
+        if (Entry.Key.IsEmpty() || GUploadOutbox.Pending.Contains(Entry.Key) || GUploadOutbox.Delivered.Contains(Entry.Key))
         {
-            return false;
+            return;
         }
 
-        UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
-        Comp->SetStaticMesh(SM);
-        Comp->SetMobility(EComponentMobility::Movable);
-        Comp->RegisterComponentWithWorld(World);
-        Comp->SetForcedLodModel(1);
+        AppendOutboxJournal(OutboxEntryToJson(Entry));
+        GUploadOutbox.Order.Add(Entry.Key);
+        GUploadOutbox.Pending.Add(Entry.Key, MoveTemp(Entry));
+    }
 
-        Scene.AddComponent(Comp, FTransform::Identity);
-        Comp->UpdateBounds();
+    // Removes a finished entry and journals it as done. The key is copied first
+    // because callers often pass the entry's own Key field.
+    static FOutboxEntry RetireOutboxEntry(const FString& InKey)
+    {
+        const FString Key = InKey;
+        FOutboxEntry Done;
+        GUploadOutbox.Pending.RemoveAndCopyValue(Key, Done);
+        GUploadOutbox.Order.Remove(Key);
+        GUploadOutbox.Delivered.Add(Key);
+
+        TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+        Record->SetStringField(TEXT("op"), TEXT("done"));
+        Record->SetStringField(TEXT("key"), Key);
+        AppendOutboxJournal(Record);
+        return Done;
+    }
 
-        const FVector CenterOffset = -Comp->Bounds.Origin;
-        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();
-        Comp->SetWorldLocation(CenterOffset);
-        
-        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
-        BaseRotation.Yaw += 90.f;  // 90° rotation
-        Comp->SetWorldRotation(BaseRotation);
-        Comp->UpdateBounds();
+    static void DropOutboxEntry(const FString& Key, const TCHAR* Reason);
 
-        // Ensure textures are resident before capture (prevents low-mip blur on first pass).
-        ForceComponentTexturesResident(Comp);
+    // Transport errors (code 0), timeouts, throttling and server errors may pass on
+    // a later attempt; any other 4xx is the server rejecting the entry itself.
+    static bool IsOutboxRetryable(int32 ResponseCode)
+    {
+        return ResponseCode <= 0
+            || ResponseCode == EHttpResponseCodes::RequestTimeout
+            || ResponseCode == EHttpResponseCodes::TooManyRequests
+            || ResponseCode >= 500;
+    }
 
-        const float Radius = Comp->Bounds.SphereRadius;
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, kDistancePadding);
+    // ResponseCode is 0 when the request never got an answer.
+    static void CompleteOutboxEntry(const FString& Key, int32 ResponseCode)
+    {
+        FOutboxEntry* Entry = GUploadOutbox.Pending.Find(Key);
+        if (!Entry)
+        {
+            return;
+        }
 
-        OutFrames.Reset();
-        const int32 FramesToKeep = GetStaticMeshFrameCount();
-        const int32 FramesToDiscard = GetCapture360DiscardCount();
-        const int32 FramesTotal = FramesToKeep + FramesToDiscard;
-        OutFrames.Reserve(FramesToKeep);
+        Entry->bInFlight = false;
+        GUploadOutbox.InFlight = FMath::Max(0, GUploadOutbox.InFlight - 1);
 
-        // ============================================================================
-        // 1 SECOND PAUSE BEFORE SHOOTING - Let textures/shaders load!
-        // ============================================================================
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Pausing %.1f seconds before capture..."), kCapture360PauseBeforeShoot);
-        
-        // Tick world multiple times during pause
-        const float PauseTickInterval = 0.5f;
-        const int32 NumPauseTicks = (int32)(kCapture360PauseBeforeShoot / PauseTickInterval);
-        
-        for (int32 PauseTick = 0; PauseTick < NumPauseTicks; ++PauseTick)
+        if (!EHttpResponseCodes::IsOk(ResponseCode) && !IsOutboxRetryable(ResponseCode))
         {
-            World->Tick(LEVELTICK_All, PauseTickInterval);
-            Comp->MarkRenderStateDirty();
-            FlushRenderingCommands();
-            FPlatformProcess::Sleep(PauseTickInterval);
+            DropOutboxEntry(Key, *FString::Printf(TEXT("rejected with HTTP %d"), ResponseCode));
+            return;
         }
-        
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Pause complete, starting capture..."));
-        // ============================================================================
-
-        // Now capture frames (skip first 3, keep rest)
-        for (int32 i = 0; i < FramesTotal; ++i)
+        if (!EHttpResponseCodes::IsOk(ResponseCode))
         {
-            if (i > 0)
-            {
-                World->Tick(LEVELTICK_All, kCapture360FrameInterval);
-                Comp->MarkRenderStateDirty();
-                FlushRenderingCommands();
-                FPlatformProcess::Sleep(kCapture360FrameInterval);
-            }
-
-            // 360° camera rotation
-            float CameraYaw = 0.0f;
-            if (i >= FramesToDiscard)
-            {
-                const int32 FrameIndex = i - FramesToDiscard;
-                CameraYaw = (360.0f / (float)FramesToKeep) * FrameIndex;
-            }
+            ++Entry->Attempts;
+            const double Backoff = FMath::Min(kOutboxRetryMaxSeconds, kOutboxRetryBaseSeconds * FMath::Pow(2.0, (double)FMath::Min(Entry->Attempts - 1, 10)));
+            Entry->NextAttemptSec = FPlatformTime::Seconds() + Backoff;
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Upload outbox: delivery failed for %s (attempt %d, HTTP %d), retrying in %.0fs"), *Key, Entry->Attempts, ResponseCode, Backoff);
+            return;
+        }
 
-            TArray<uint8> WebP;
-            if (CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, WebP, ViewDir, CameraYaw))
+        const FOutboxEntry Done = RetireOutboxEntry(Key);
+        if (Done.Kind == EOutboxKind::Upload)
+        {
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Upload outbox: uploaded %s"), *Done.ZipPath);
+            RememberServerHash(Done.BaseUrl, Done.Hash);
+            if (!Done.EventBody.IsEmpty())
             {
-                if (i >= FramesToDiscard)
-                {
-                    FZipEntry Frame;
-                    Frame.NameInZip = FString::Printf(TEXT("%d.webp"), OutFrames.Num());
-                    Frame.Data = MoveTemp(WebP);
-                    OutFrames.Add(MoveTemp(Frame));
-                }
+                FOutboxEntry Event;
+                Event.Key = TEXT("event:") + Done.Hash;
+                Event.Kind = EOutboxKind::Event;
+                Event.Hash = Done.Hash;
+                Event.BaseUrl = Done.BaseUrl;
+                Event.EventBody = Done.EventBody;
+                EnqueueOutbox(MoveTemp(Event));
             }
         }
 
-        return OutFrames.Num() > 0;
+        if (GUploadOutbox.Pending.Num() == 0)
+        {
+            CompactOutboxJournal();
+        }
     }
 
-    static bool CaptureStaticMesh(UStaticMesh* SM, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
+    // Gives up on an entry that can never be delivered: journaled as done so it
+    // is not resumed, but not counted as an upload and no event is chained.
+    static void DropOutboxEntry(const FString& Key, const TCHAR* Reason)
     {
-        // Legacy single-frame wrapper for backward compatibility
-        TArray<FZipEntry> Frames;
-        if (!CaptureStaticMeshMultiFrame(SM, Resolution, Frames, OutDistance))
+        const FOutboxEntry* Entry = GUploadOutbox.Pending.Find(Key);
+        if (!Entry)
         {
-            return false;
+            return;
         }
-        if (Frames.Num() > 0)
+        if (Entry->bInFlight)
         {
-            OutWebP = MoveTemp(Frames[0].Data);  // Return first frame
-            return true;
+            GUploadOutbox.InFlight = FMath::Max(0, GUploadOutbox.InFlight - 1);
+        }
+
+        const FOutboxEntry Dropped = RetireOutboxEntry(Key);
+        UE_LOG(LogAssetSnapshot, Warning, TEXT("Upload outbox: dropped %s (%s)"), *Dropped.Key, Reason);
+
+        if (GUploadOutbox.Pending.Num() == 0)
+        {
+            CompactOutboxJournal();
         }
-        return false;
     }
 
-    static bool CaptureSkeletalMesh(USkeletalMesh* SK, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
+    // Returns false only when the breaker refused the request.
+    static bool BeginResolveProjectId(const FString& BaseUrl, const FString& ResolvePath)
     {
-        if (!SK)
+        if (GUploadOutbox.ResolvesInFlight.Contains(ResolvePath))
         {
-            return false;
+            return true;
+        }
+        if (const double* RetryAt = GUploadOutbox.ResolveRetryAt.Find(ResolvePath))
+        {
+            if (FPlatformTime::Seconds() < *RetryAt)
+            {
+                return true;
+            }
         }
 
-		FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
-
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+        if (!BackendAllowRequest(TEXT("project resolve")))
         {
             return false;
         }
 
-        USkeletalMeshComponent* Comp = NewObject<USkeletalMeshComponent>(GetTransientPackage());
-        Comp->SetSkeletalMesh(SK);
-        Comp->SetMobility(EComponentMobility::Movable);
-        Comp->RegisterComponentWithWorld(World);
-        Comp->SetForcedLOD(1);
-
-        Scene.AddComponent(Comp, FTransform::Identity);
-        Comp->UpdateBounds();
-
-        const FVector CenterOffset = -Comp->Bounds.Origin;
-        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();  // Y-axis
-        Comp->SetWorldLocation(CenterOffset);
-        
-        // Rotate mesh: base rotation + 90° around Z-axis
-        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
-        BaseRotation.Yaw += 90.f;  // Add 90° rotation towards camera
-        Comp->SetWorldRotation(BaseRotation);
-        Comp->UpdateBounds();
-
-        // Ensure textures are resident before capture (prevents silver previews while streaming is pending).
-        ForceComponentTexturesResident(Comp);
-
-        const float Radius = Comp->Bounds.SphereRadius;
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, kDistancePadding);
-        return CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir);
+        GUploadOutbox.ResolvesInFlight.Add(ResolvePath);
+        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+        Request->SetURL(BuildResolveProjectUrl(BaseUrl, ResolvePath));
+        Request->SetVerb(TEXT("GET"));
+        Request->SetTimeout(kOutboxRequestTimeoutSeconds);
+        Request->OnProcessRequestComplete().BindLambda(
+            [ResolvePath](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+            {
+                GUploadOutbox.ResolvesInFlight.Remove(ResolvePath);
+                BackendRecordResult(IsBackendReachable(Resp, bSucceeded));
+                int32 ProjectId = 0;
+                if (ParseResolvedProjectId(Resp, bSucceeded, ProjectId))
+                {
+                    GUploadOutbox.ProjectIds.Add(ResolvePath, ProjectId);
+                    GUploadOutbox.ResolveRetryAt.Remove(ResolvePath);
+                }
+                else
+                {
+                    UE_LOG(LogAssetSnapshot, Warning, TEXT("Upload outbox: project id not resolved for %s"), *ResolvePath);
+                    GUploadOutbox.ResolveRetryAt.Add(ResolvePath, FPlatformTime::Seconds() + kOutboxRetryBaseSeconds);
+                }
+            });
+        Request->ProcessRequest();
+        return true;
     }
 
-    static bool CaptureSkeletalMeshMultiFrame(USkeletalMesh* SK, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance)
+    // Returns false only when the breaker refused the request; the zip is read
+    // only after the breaker let it through.
+    static bool BeginOutboxDelivery(FOutboxEntry& Entry)
     {
-        if (!SK)
+        if (Entry.Kind == EOutboxKind::Upload && !GUploadOutbox.ProjectIds.Contains(Entry.ResolvePath))
         {
-            return false;
+            return BeginResolveProjectId(Entry.BaseUrl, Entry.ResolvePath);
         }
-
-        FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
-
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+        if (Entry.Kind == EOutboxKind::Upload && !IFileManager::Get().FileExists(*Entry.ZipPath))
+        {
+            DropOutboxEntry(Entry.Key, TEXT("zip missing"));
+            return true;
+        }
+        if (!BackendAllowRequest(Entry.Kind == EOutboxKind::Upload ? TEXT("upload") : TEXT("event")))
         {
             return false;
         }
 
-        USkeletalMeshComponent* Comp = NewObject<USkeletalMeshComponent>(GetTransientPackage());
-        Comp->SetSkeletalMesh(SK);
-        Comp->SetMobility(EComponentMobility::Movable);
-        Comp->RegisterComponentWithWorld(World);
-        Comp->SetForcedLOD(1);
-
-        Scene.AddComponent(Comp, FTransform::Identity);
-        Comp->UpdateBounds();
+        // From here on the request is sent and always reports back.
+        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+        Request->SetVerb(TEXT("POST"));
+        Request->SetTimeout(kOutboxRequestTimeoutSeconds);
 
-        const FVector CenterOffset = -Comp->Bounds.Origin;
-        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();
-        Comp->SetWorldLocation(CenterOffset);
-        
-        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
-        BaseRotation.Yaw += 90.f;  // 90° rotation
-        Comp->SetWorldRotation(BaseRotation);
-        Comp->UpdateBounds();
+        if (Entry.Kind == EOutboxKind::Upload)
+        {
+            const int32* ProjectId = GUploadOutbox.ProjectIds.Find(Entry.ResolvePath);
+            TArray<uint8> Body;
+            FString ContentType;
+            if (!BuildUploadMultipartBody(Entry.ZipPath, *ProjectId, Body, ContentType))
+            {
+                BackendReleaseProbe();
+                DropOutboxEntry(Entry.Key, TEXT("zip unreadable"));
+                return true;
+            }
+            Request->SetURL(BuildUploadUrl(Entry.BaseUrl, Entry.UploadPathTemplate));
+            Request->SetHeader(TEXT("Content-Type"), ContentType);
+            Request->SetContent(MoveTemp(Body));
+        }
+        else
+        {
+            Request->SetURL(NormalizeBaseUrl(Entry.BaseUrl) + TEXT("/events/notify"));
+            Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+            Request->SetContentAsString(Entry.EventBody);
+        }
 
-        // Ensure textures are resident before capture (prevents low-mip blur on first pass).
-        ForceComponentTexturesResident(Comp);
+        const FString Key = Entry.Key;
+        Request->OnProcessRequestComplete().BindLambda(
+            [Key](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+            {
+                BackendRecordResult(IsBackendReachable(Resp, bSucceeded));
+                CompleteOutboxEntry(Key, bSucceeded && Resp.IsValid() ? Resp->GetResponseCode() : 0);
+            });
 
-        const float Radius = Comp->Bounds.SphereRadius;
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, kDistancePadding);
+        Entry.bInFlight = true;
+        ++GUploadOutbox.InFlight;
+        Request->ProcessRequest();
+        return true;
+    }
 
-        OutFrames.Reset();
-        const int32 FramesToKeep = GetSkeletalMeshFrameCount();
-        const int32 FramesToDiscard = GetCapture360DiscardCount();
-        const int32 FramesTotal = FramesToKeep + FramesToDiscard;
-        OutFrames.Reserve(FramesToKeep);
+    // Non-blocking: starts deliveries for due entries, up to kOutboxMaxParallel at once.
+    static void PumpOutbox()
+    {
+        LoadOutboxJournal();
+        if (GUploadOutbox.Pending.Num() == 0)
+        {
+            return;
+        }
 
-        // ============================================================================
-        // 1 SECOND PAUSE BEFORE SHOOTING - Let textures/shaders load!
-        // ============================================================================
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Pausing %.1f seconds before capture..."), kCapture360PauseBeforeShoot);
-        
-        // Tick world multiple times during pause
-        const float PauseTickInterval = 0.5f;
-        const int32 NumPauseTicks = (int32)(kCapture360PauseBeforeShoot / PauseTickInterval);
-        
-        for (int32 PauseTick = 0; PauseTick < NumPauseTicks; ++PauseTick)
+        const double Now = FPlatformTime::Seconds();
+        if (IsBackendBlocked())
         {
-            World->Tick(LEVELTICK_All, PauseTickInterval);
-            Comp->MarkRenderStateDirty();
-            FlushRenderingCommands();
-            FPlatformProcess::Sleep(PauseTickInterval);
+            // Breaker is open or its probe is still out; nothing would get through.
+            return;
         }
-        
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Pause complete, starting capture..."));
-        // ============================================================================
 
-        // Now capture frames (skip first 3, keep rest)
-        for (int32 i = 0; i < FramesTotal; ++i)
+        const TArray<FString> Keys = GUploadOutbox.Order;
+        for (const FString& Key : Keys)
         {
-            if (i > 0)
+            if (GUploadOutbox.InFlight >= kOutboxMaxParallel)
             {
-                World->Tick(LEVELTICK_All, kCapture360FrameInterval);
-                Comp->MarkRenderStateDirty();
-                FlushRenderingCommands();
-                FPlatformProcess::Sleep(kCapture360FrameInterval);
+                break;
             }
-
-            // 360° camera rotation
-            float CameraYaw = 0.0f;
-            if (i >= FramesToDiscard)
+            FOutboxEntry* Entry = GUploadOutbox.Pending.Find(Key);
+            if (!Entry || Entry->bInFlight || Entry->NextAttemptSec > Now)
             {
-                const int32 FrameIndex = i - FramesToDiscard;
-                CameraYaw = (360.0f / (float)FramesToKeep) * FrameIndex;
+                continue;
             }
-
-            TArray<uint8> WebP;
-            if (CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, WebP, ViewDir, CameraYaw))
+            if (!BeginOutboxDelivery(*Entry))
             {
-                if (i >= FramesToDiscard)
-                {
-                    FZipEntry Frame;
-                    Frame.NameInZip = FString::Printf(TEXT("%d.webp"), OutFrames.Num());
-                    Frame.Data = MoveTemp(WebP);
-                    OutFrames.Add(MoveTemp(Frame));
-                }
+                // The breaker refused; the remaining entries would be refused too.
+                break;
             }
         }
+    }
 
-        return OutFrames.Num() > 0;
+    // Pumps the outbox and ticks HTTP until it is empty or the timeout elapses.
+    static int32 DrainOutbox(double TimeoutSeconds)
+    {
+        const double Start = FPlatformTime::Seconds();
+        do
+        {
+            PumpOutbox();
+            FHttpModule::Get().GetHttpManager().Tick(0.01f);
+            if (GUploadOutbox.Pending.Num() == 0 || (GUploadOutbox.InFlight == 0 && GetBackendNextProbeSec() > FPlatformTime::Seconds()))
+            {
+                break;
+            }
+            FPlatformProcess::Sleep(0.01f);
+        }
+        while ((FPlatformTime::Seconds() - Start) < TimeoutSeconds);
+        return GUploadOutbox.Pending.Num();
     }
 
-    static bool CaptureMaterialOnSharedSphereMultiFrame(
-        FMaterialCaptureContext& Ctx,
-        UMaterialInterface* Mat,
-        int32 Resolution,
-        TArray<FZipEntry>& OutFrames,
-        float& OutDistance,
-        bool& OutLowQuality)
+static bool GetServerExportFilters(
+        const FString& BaseUrl,
+        FString& OutInclude,
+        FString& OutExclude)
     {
-        OutLowQuality = false;
-        if (!Mat || !Ctx.Comp || !Ctx.World)
+        OutInclude.Reset();
+        OutExclude.Reset();
+        if (BaseUrl.IsEmpty())
         {
             return false;
         }
 
-        auto DoCapturePass = [&](TArray<FZipEntry>& Frames, bool& bLowQuality)
+        FString Url = NormalizeBaseUrl(BaseUrl);
+        Url += TEXT("/settings");
+
+        static double LastFetchAt = 0.0;
+        static double FetchStartedAt = 0.0;
+        static FString CachedInclude;
+        static FString CachedExclude;
+        static bool bCacheValid = false;
+        static bool bFetchInFlight = false;
+        static TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> ActiveRequest;
+        static FCriticalSection CacheMutex;
+
+        const double Now = FPlatformTime::Seconds();
+        FHttpModule::Get().GetHttpManager().Tick(0.0f);
         {
-            Frames.Reset();
-            const int32 FramesTotal = GetMaterialFrameCount();
-            Frames.Reserve(FramesTotal);
+            FScopeLock Lock(&CacheMutex);
+            if (bCacheValid && (Now - LastFetchAt) < 5.0)
+            {
+                OutInclude = CachedInclude;
+                OutExclude = CachedExclude;
+                return true;
+            }
+        }
 
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Pausing %.1f seconds before capture..."), kCaptureMaterialPauseBeforeShoot);
-            const float PauseTickInterval = 0.5f;
-            const int32 NumPauseTicks = (int32)(kCaptureMaterialPauseBeforeShoot / PauseTickInterval);
-            for (int32 PauseTick = 0; PauseTick < NumPauseTicks; ++PauseTick)
+        if (bFetchInFlight)
+        {
+            if ((Now - FetchStartedAt) > 5.0)
             {
-                Ctx.World->Tick(LEVELTICK_All, PauseTickInterval);
-                Ctx.Comp->MarkRenderStateDirty();
-                FlushRenderingCommands();
-                FPlatformProcess::Sleep(PauseTickInterval);
+                bFetchInFlight = false;
             }
+            return false;
+        }
 
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Pause complete, starting capture..."));
-            BlockStreamingAndCompiles(Ctx.World);
+        if (!BackendAllowRequest(TEXT("export filters")))
+        {
+            return false;
+        }
 
-            for (int32 i = 0; i < FramesTotal; ++i)
+        bFetchInFlight = true;
+        FetchStartedAt = Now;
+        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+        ActiveRequest = Request;
+        Request->SetURL(Url);
+        Request->SetVerb(TEXT("GET"));
+        Request->OnProcessRequestComplete().BindLambda(
+            [&](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
             {
-                if (i > 0)
+                BackendRecordResult(IsBackendReachable(Resp, bSucceeded));
+                FString Include;
+                FString Exclude;
+                const int32 Code = Resp.IsValid() ? Resp->GetResponseCode() : -1;
+                const FString Body = Resp.IsValid() ? Resp->GetContentAsString() : FString();
+                bool bParsed = false;
+                if (bSucceeded && Resp.IsValid() && Code == 200)
                 {
-                    Ctx.World->Tick(LEVELTICK_All, kCaptureMaterialFrameInterval);
-                    Ctx.Comp->MarkRenderStateDirty();
-                    FlushRenderingCommands();
-                    FPlatformProcess::Sleep(kCaptureMaterialFrameInterval);
-                }
+                    TSharedPtr<FJsonObject> Root;
+                    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
+                    if (FJsonSerializer::Deserialize(Reader, Root) && Root.IsValid())
+                    {
+                        if (const TSharedPtr<FJsonValue> SkipVal = Root->TryGetField(TEXT("skip_export_if_on_server")))
+                        {
+                            bool bParsedSkip = false;
+                            bool bEnabled = true;
+                            if (SkipVal->Type == EJson::Boolean)
+                            {
+                                bEnabled = SkipVal->AsBool();
+                                bParsedSkip = true;
+                            }
+                            else if (SkipVal->Type == EJson::String)
+                            {
+                                const FString Raw = SkipVal->AsString().ToLower();
+                                if (Raw == TEXT("1") || Raw == TEXT("true") || Raw == TEXT("yes") || Raw == TEXT("on"))
+                                {
+                                    bEnabled = true;
+                                    bParsedSkip = true;
+                                }
+                                else if (Raw == TEXT("0") || Raw == TEXT("false") || Raw == TEXT("no") || Raw == TEXT("off"))
+                                {
+                                    bEnabled = false;
+                                    bParsedSkip = true;
+                                }
+                            }
+                            else if (SkipVal->Type == EJson::Number)
+                            {
+                                bEnabled = SkipVal->AsNumber() != 0.0;
+                                bParsedSkip = true;
+                            }
 
-                TArray<uint8> WebP;
-                if (CapturePreviewSceneToWebPBytes(Ctx.Scene, Ctx.Comp->Bounds.Origin, Ctx.Distance, kDefaultFov, Resolution, WebP, Ctx.ViewDir, 0.0f))
-                {
-                    const bool bMeetsQuality = (WebP.Num() >= kMaterialMinWebPBytes);
-                    if (!bMeetsQuality)
+                            if (bParsedSkip)
+                            {
+                                GAssetSnapshotServerSkipKnown = true;
+                                GAssetSnapshotServerSkipEnabled = bEnabled;
+                            }
+                        }
+
+                        auto JoinArray = [](const TArray<TSharedPtr<FJsonValue>>& Values) -> FString
+                        {
+                            TArray<FString> Parts;
+                            for (const TSharedPtr<FJsonValue>& V : Values)
+                            {
+                                if (!V.IsValid())
+                                {
+                                    continue;
+                                }
+                                const FString S = V->AsString().TrimStartAndEnd();
+                                if (!S.IsEmpty())
+                                {
+                                    Parts.Add(S);
+                                }
+                            }
+                            return FString::Join(Parts, TEXT(","));
+                        };
+
+                        if (const TSharedPtr<FJsonValue> IncludeVal = Root->TryGetField(TEXT("export_include_types")))
+                        {
+                            if (IncludeVal->Type == EJson::Array)
+                            {
+                                Include = JoinArray(IncludeVal->AsArray());
+                            }
+                            else if (IncludeVal->Type == EJson::String)
+                            {
+                                Include = IncludeVal->AsString();
+                            }
+                        }
+                        if (const TSharedPtr<FJsonValue> ExcludeVal = Root->TryGetField(TEXT("export_exclude_types")))
+                        {
+                            if (ExcludeVal->Type == EJson::Array)
+                            {
+                                Exclude = JoinArray(ExcludeVal->AsArray());
+                            }
+                            else if (ExcludeVal->Type == EJson::String)
+                            {
+                                Exclude = ExcludeVal->AsString();
+                            }
+                        }
+                        bParsed = true;
+                        UE_LOG(LogAssetSnapshot, Log, TEXT("GetServerExportFilters: parsed include='%s' exclude='%s'"), *Include, *Exclude);
+                    }
+                    else
                     {
-                        bLowQuality = true;
+                        UE_LOG(LogAssetSnapshot, Warning, TEXT("GetServerExportFilters: JSON parse failed body='%s'"), *Body);
                     }
+                }
+                else
+                {
+                    UE_LOG(LogAssetSnapshot, Warning, TEXT("GetServerExportFilters: request failed ok=%s code=%d"),
+                        bSucceeded ? TEXT("true") : TEXT("false"),
+                        Code);
+                }
 
-                    UE_LOG(
-                        LogAssetSnapshot,
-                        Log,
-                        TEXT("Material capture %s frame %d: %d bytes%s"),
-                        Mat ? *Mat->GetName() : TEXT("<null>"),
-                        i,
-                        WebP.Num(),
-                        bMeetsQuality ? TEXT("") : TEXT(" (low quality)"));
+                {
+                    FScopeLock Lock(&CacheMutex);
+                    CachedInclude = Include;
+                    CachedExclude = Exclude;
+                    LastFetchAt = FPlatformTime::Seconds();
+                    bCacheValid = bParsed;
+                }
+                bFetchInFlight = false;
+                ActiveRequest.Reset();
+            });
 
-                    FZipEntry Frame;
-                    Frame.NameInZip = FString::Printf(TEXT("%d.webp"), Frames.Num());
-                    Frame.Data = MoveTemp(WebP);
-                    Frames.Add(MoveTemp(Frame));
+        Request->ProcessRequest();
+        // Short tick to allow completion without stalling export too long.
+        for (int32 i = 0; i < 100; ++i)
+        {
+            FHttpModule::Get().GetHttpManager().Tick(0.01f);
+            FPlatformProcess::Sleep(0.01f);
+            {
+                FScopeLock Lock(&CacheMutex);
+                if (bCacheValid)
+                {
+                    OutInclude = CachedInclude;
+                    OutExclude = CachedExclude;
+                    return true;
                 }
             }
+        }
+        return false;
+    }
 
-            return Frames.Num() > 0;
-        };
-
-        Ctx.Comp->SetMaterial(0, Mat);
-        Ctx.Comp->MarkRenderStateDirty();
-        ForceComponentTexturesResident(Ctx.Comp);
-        WarmupWorld(Ctx.World, kWarmupSeconds);
-        ForceComponentTexturesResident(Ctx.Comp);
-
-        OutDistance = Ctx.Distance;
+    static bool IsServerSkipExportEnabled(const FString& BaseUrl, bool& OutEnabled)
+    {
+        const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(BaseUrl);
+        OutEnabled = Server.bSkipExportIfOnServer;
+        return Server.bAvailable;
+    }
 
-        TArray<FZipEntry> Frames;
-        bool bLowQuality = false;
-        const bool bCaptured = DoCapturePass(Frames, bLowQuality);
-        if (!bCaptured)
+    static bool PackageToMainFileAbs(const FString& PackageName, FString& OutAbs)
+    {
+        FString AbsUAsset = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+        if (FPaths::FileExists(AbsUAsset))
         {
-            return false;
+            OutAbs = AbsUAsset;
+            return true;
         }
 
-        if (bLowQuality)
+        FString AbsUMap = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetMapPackageExtension());
+        if (FPaths::FileExists(AbsUMap))
         {
-            // Re-apply material and retry once if any frame is too small.
-            Ctx.Comp->SetMaterial(0, Mat);
-            Ctx.Comp->MarkRenderStateDirty();
-            ForceComponentTexturesResident(Ctx.Comp);
-            BlockStreamingAndCompiles(Ctx.World);
-
-            TArray<FZipEntry> RetryFrames;
-            bool bRetryLowQuality = false;
-            const bool bRetryCaptured = DoCapturePass(RetryFrames, bRetryLowQuality);
-            if (bRetryCaptured)
-            {
-                OutLowQuality = bRetryLowQuality;
-                OutFrames = MoveTemp(RetryFrames);
-                return true;
-            }
+            OutAbs = AbsUMap;
+            return true;
         }
 
-        OutLowQuality = bLowQuality;
-        OutFrames = MoveTemp(Frames);
-        return true;
+        OutAbs = AbsUAsset; // best effort
+        return false;
     }
 
-    static bool CaptureMaterialOnSphereMultiFrame(UMaterialInterface* Mat, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance, bool& OutLowQuality)
+    static void AddIfExistsAllowlisted(const FString& AbsPath, const FString& ContentDir, TSet<FString>& SeenRel, TArray<FString>& OutRel, TArray<FString>& OutAbs, int64& TotalBytes)
     {
-        OutLowQuality = false;
-        if (!Mat)
+        if (!FPaths::FileExists(AbsPath))
         {
-            return false;
+            return;
         }
 
-        FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
+        FString Rel = AbsPath;
+        FPaths::MakePathRelativeTo(Rel, *ContentDir);
+        Rel = NormalizeRelPath(Rel);
 
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+        const FString Ext = FPaths::GetExtension(Rel, true).ToLower();
+        const bool bAllowed = (Ext == TEXT(".uasset") || Ext == TEXT(".uexp") || Ext == TEXT(".ubulk") || Ext == TEXT(".uptnl") || Ext == TEXT(".umap"));
+        if (!bAllowed)
         {
-            return false;
+            return;
         }
 
-        UStaticMesh* Sphere = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
-        if (!Sphere)
+        if (SeenRel.Contains(Rel))
         {
-            return false;
+            return;
         }
 
-        UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
-        Comp->SetStaticMesh(Sphere);
-        Comp->SetMobility(EComponentMobility::Movable);
-        Comp->RegisterComponentWithWorld(World);
-        Comp->SetWorldScale3D(FVector(2.0f));
-        Comp->SetWorldRotation(FRotator(0.f, 270.f, 0.f));  // 270°
-        Comp->UpdateBounds();
+        SeenRel.Add(Rel);
+        OutRel.Add(Rel);
+        OutAbs.Add(AbsPath);
+        TotalBytes += (int64)IFileManager::Get().FileSize(*AbsPath);
+    }
 
-        Scene.AddComponent(Comp, FTransform::Identity);
-        Comp->SetMaterial(0, Mat);
-        Comp->MarkRenderStateDirty();
+    static void GatherFilesOnDiskForPackage(const FString& PackageName, TSet<FString>& SeenRel, TArray<FString>& OutRel, TArray<FString>& OutAbs, int64& TotalBytes)
+    {
+        const FString ContentDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
 
-        // Ensure textures are resident before capture (prevents low-mip blur on first pass).
-        ForceComponentTexturesResident(Comp);
+        FString MainAbs;
+        PackageToMainFileAbs(PackageName, MainAbs);
+        const FString BaseNoExt = FPaths::ChangeExtension(MainAbs, TEXT(""));
 
-        // Give shader compilation/streaming a brief warmup for stubborn materials.
-        WarmupWorld(World, kWarmupSeconds);
-        ForceComponentTexturesResident(Comp);
+        AddIfExistsAllowlisted(MainAbs, ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
+        AddIfExistsAllowlisted(BaseNoExt + TEXT(".uexp"), ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
+        AddIfExistsAllowlisted(BaseNoExt + TEXT(".ubulk"), ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
+        AddIfExistsAllowlisted(BaseNoExt + TEXT(".uptnl"), ContentDir, SeenRel, OutRel, OutAbs, TotalBytes);
+    }
 
-        const FBoxSphereBounds B = Comp->Bounds;
-        const float Radius = B.SphereRadius;
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.05f);
-        const FVector ViewDir = FVector(1.f, 0.f, 0.f);
+    static void GatherGameDependenciesPackages(const FString& RootPackage, TArray<FString>& OutPackages)
+{
+    OutPackages.Reset();
 
-        OutFrames.Reset();
-        const int32 FramesTotal = GetMaterialFrameCount();
-        OutFrames.Reserve(FramesTotal);
+    // We only care about /Game packages for recovery.
+    if (!RootPackage.StartsWith(TEXT("/Game/")))
+    {
+        OutPackages.Add(RootPackage);
+        return;
+    }
 
-        // ============================================================================
-        // 1 SECOND PAUSE BEFORE SHOOTING - Let material parameters settle!
-        // ============================================================================
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Pausing %.1f seconds before capture..."), kCaptureMaterialPauseBeforeShoot);
-        
-        // Tick world multiple times during pause
-        const float PauseTickInterval = 0.5f;
-        const int32 NumPauseTicks = (int32)(kCaptureMaterialPauseBeforeShoot / PauseTickInterval);
-        
-        for (int32 PauseTick = 0; PauseTick < NumPauseTicks; ++PauseTick)
-        {
-            World->Tick(LEVELTICK_All, PauseTickInterval);
-            Comp->MarkRenderStateDirty();
-            FlushRenderingCommands();
-            FPlatformProcess::Sleep(PauseTickInterval);
-        }
-        
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Pause complete, starting capture..."));
-        // ============================================================================
+    IAssetRegistry& AR = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+    // Use the default dependency query here (UE versions differ in how flags are interpreted).
 
-        // Hard block on streaming/shader compilation before capture.
-        BlockStreamingAndCompiles(World);
+    TArray<FName> Queue;
+    TSet<FName> Seen;
 
-        // Now capture frames
-        for (int32 i = 0; i < FramesTotal; ++i)
+    const FName RootPkg(*RootPackage);
+    Queue.Add(RootPkg);
+    Seen.Add(RootPkg);
+
+    for (int32 Qi = 0; Qi < Queue.Num(); ++Qi)
+    {
+        const FName Cur = Queue[Qi];
+
+        TArray<FName> Deps;
+        AR.GetDependencies(Cur, Deps, UE::AssetRegistry::EDependencyCategory::Package);
+
+        for (const FName& Dep : Deps)
         {
-            if (i > 0)
+            const FString DepStr = Dep.ToString();
+            if (!DepStr.StartsWith(TEXT("/Game/")))
             {
-                World->Tick(LEVELTICK_All, kCaptureMaterialFrameInterval);
-                Comp->MarkRenderStateDirty();
-                FlushRenderingCommands();
-                FPlatformProcess::Sleep(kCaptureMaterialFrameInterval);
+                continue;
             }
-
-            // NO camera rotation for materials (static view, animated material)
-            TArray<uint8> WebP;
-            const bool bCapturedOk = CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, WebP, ViewDir, 0.0f);
-            if (bCapturedOk)
+            if (Seen.Contains(Dep))
             {
-                const bool bMeetsQuality = (WebP.Num() >= kMaterialMinWebPBytes);
-                if (!bMeetsQuality)
-                {
-                    OutLowQuality = true;
-                }
-
-                UE_LOG(
-                    LogAssetSnapshot,
-                    Log,
-                    TEXT("Material capture %s frame %d: %d bytes%s"),
-                    Mat ? *Mat->GetName() : TEXT("<null>"),
-                    i,
-                    WebP.Num(),
-                    bMeetsQuality ? TEXT("") : TEXT(" (low quality)"));
-
-                FZipEntry Frame;
-                Frame.NameInZip = FString::Printf(TEXT("%d.webp"), OutFrames.Num());
-                Frame.Data = MoveTemp(WebP);
-                OutFrames.Add(MoveTemp(Frame));
+                continue;
             }
+
+            Seen.Add(Dep);
+            Queue.Add(Dep);
         }
+    }
 
-        return OutFrames.Num() > 0;
+    // Deterministic output.
+    for (const FName& Pkg : Seen)
+    {
+        OutPackages.Add(Pkg.ToString());
     }
+    OutPackages.Sort();
+}
 
-    static bool CaptureMaterialOnCube(UMaterialInterface* Mat, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
+    struct FMeshStats
     {
-        if (!Mat)
+        int64 Triangles = 0;
+        int64 Vertices = 0;
+        int32 LODs = 0;
+        bool bNaniteEnabled = false;
+        FString CollisionComplexity;
+        FVector ApproxSize = FVector::ZeroVector; // cm
+    };
+
+    static FMeshStats GetStaticMeshStats(UStaticMesh* SM)
+    {
+        FMeshStats S;
+        if (!SM)
         {
-            return false;
+            return S;
         }
 
-		FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
+        const FBoxSphereBounds B = SM->GetBounds();
+        S.ApproxSize = B.BoxExtent * 2.0f;
 
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+        if (SM->GetRenderData() && SM->GetRenderData()->LODResources.Num() > 0)
         {
-            return false;
+            const FStaticMeshLODResources& LOD0 = SM->GetRenderData()->LODResources[0];
+            S.Triangles = (int64)LOD0.GetNumTriangles();
+            S.Vertices = (int64)LOD0.GetNumVertices();
+            S.LODs = SM->GetRenderData()->LODResources.Num();
         }
 
-        // Use SPHERE for materials, not cube
-        UStaticMesh* Sphere = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
-        if (!Sphere)
+#if WITH_EDITOR
+    #if ENGINE_MAJOR_VERSION > 5 || (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 6)
+        S.bNaniteEnabled = SM->GetNaniteSettings().bEnabled || SM->IsNaniteForceEnabled();
+    #else
+        S.bNaniteEnabled = SM->NaniteSettings.bEnabled || SM->IsNaniteForceEnabled();
+    #endif
+#else
+        S.bNaniteEnabled = false;
+#endif
+
+        if (UBodySetup* BS = SM->GetBodySetup())
         {
-            return false;
+            switch (BS->CollisionTraceFlag)
+            {
+            case CTF_UseDefault: S.CollisionComplexity = TEXT("UseDefault"); break;
+            case CTF_UseSimpleAsComplex: S.CollisionComplexity = TEXT("UseSimpleAsComplex"); break;
+            case CTF_UseComplexAsSimple: S.CollisionComplexity = TEXT("UseComplexAsSimple"); break;
+            case CTF_UseSimpleAndComplex: S.CollisionComplexity = TEXT("UseSimpleAndComplex"); break;
+            default: S.CollisionComplexity = TEXT("Unknown"); break;
+            }
+        }
+        else
+        {
+            S.CollisionComplexity = TEXT("None");
         }
 
-        UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
-        Comp->SetStaticMesh(Sphere);
-        Comp->SetMobility(EComponentMobility::Movable);
-        Comp->RegisterComponentWithWorld(World);
-        Comp->SetWorldScale3D(FVector(2.0f));
-        Comp->SetWorldRotation(FRotator(0.f, 270.f, 0.f));  // 270° (was 90°, +180° correction)
-        Comp->UpdateBounds();
-
-        Scene.AddComponent(Comp, FTransform::Identity);
-        Comp->SetMaterial(0, Mat);
-        Comp->MarkRenderStateDirty();
-
-        // Force textures
-        ForceComponentTexturesResident(Comp);
-
-        const FBoxSphereBounds B = Comp->Bounds;
-        const float Radius = B.SphereRadius;
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.05f);
-        const FVector ViewDir = FVector(1.f, 0.f, 0.f);
-        return CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir);
+        return S;
     }
 
-    static bool CaptureTexture2D(UTexture2D* Tex, int32 Resolution, TArray<uint8>& OutWebP)
+    static FMeshStats GetSkeletalMeshStats(USkeletalMesh* SK)
     {
-        if (!Tex)
+        FMeshStats S;
+        if (!SK)
         {
-            return false;
+            return S;
         }
 
-        Tex->SetForceMipLevelsToBeResident(30.0f);
-        Tex->WaitForStreaming();
-
-        int32 Width = 0;
-        int32 Height = 0;
-        ComputeTextureCaptureSize(Tex, Resolution, Width, Height);
-
-        UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
-        RT->InitCustomFormat(Width, Height, PF_B8G8R8A8, false);
-        RT->ClearColor = FLinearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        RT->TargetGamma = 1.8f;  // Compromise between too dark (1.0) and too bright (2.2)
-        RT->UpdateResourceImmediate(true);
+        const FBoxSphereBounds B = SK->GetBounds();
+        S.ApproxSize = B.BoxExtent * 2.0f;
 
-        FTextureRenderTargetResource* RTRes = RT->GameThread_GetRenderTargetResource();
-        if (!RTRes)
+        const FSkeletalMeshRenderData* RD = SK->GetResourceForRendering();
+        if (RD && RD->LODRenderData.Num() > 0)
         {
-            return false;
+            S.LODs = RD->LODRenderData.Num();
+            const FSkeletalMeshLODRenderData& LOD0 = RD->LODRenderData[0];
+            S.Triangles = (int64)LOD0.GetTotalFaces();
+            S.Vertices = (int64)LOD0.GetNumVertices();
         }
 
-        // Draw the texture onto the render target using a Canvas (no custom material needed)
-        FCanvas Canvas(RTRes, nullptr, FGameTime::GetTimeSinceAppStart(), GMaxRHIFeatureLevel);
-        Canvas.Clear(RT->ClearColor);
+        S.bNaniteEnabled = false;
+        S.CollisionComplexity = TEXT("N/A");
+        return S;
+    }
 
-        FCanvasTileItem Tile(FVector2D(0, 0), Tex->GetResource(), FVector2D(Width, Height), FLinearColor::White);
-        Tile.BlendMode = SE_BLEND_Opaque;
-        Canvas.DrawItem(Tile);
-        Canvas.Flush_GameThread();
-        FlushRenderingCommands();
+    static float ComputeCameraDistanceFromBounds(float SphereRadius, float FovDeg, float Padding)
+    {
+        const float HalfFovRad = FMath::DegreesToRadians(FovDeg * 0.5f);
+        const float Dist = (SphereRadius / FMath::Tan(HalfFovRad)) * Padding;
+        return FMath::Max(50.0f, Dist);
+    }
 
-        TArray<FColor> Pixels;
-        Pixels.SetNumUninitialized(Width * Height);
-        FReadSurfaceDataFlags Flags(RCM_UNorm);
-        Flags.SetLinearToGamma(true);
-        const bool bOk = RTRes->ReadPixels(Pixels, Flags);
-        if (!bOk)
-        {
-            return false;
-        }
+    // ============================================================================
+    // PACKAGE PREFETCH
+    // ============================================================================
+    // While one asset is captured, the packages of the next capturable assets are
+    // loaded with LoadPackageAsync. The editor does not tick async loading while a
+    // batch blocks the game thread, so capture waits pump it via IdleWithPrefetch.
+    // Prefetched assets are held by TStrongObjectPtr so the batch GC cannot drop
+    // them before their turn.
+    // ============================================================================
+    struct FPrefetchRequest
+    {
+        int32 RequestId = INDEX_NONE;
+        int64 EstimatedBytes = 0;
+        bool bDone = false;
+        TStrongObjectPtr<UObject> Asset;
+    };
+
+    struct FPackagePrefetcher
+    {
+        int32 MaxAhead = 0;
+        int64 BudgetBytes = 0;
+        int64 BytesAhead = 0;
+        TMap<int32, TSharedRef<FPrefetchRequest>> Requests;
 
-        if (!EncodeWebPFromBGRA(Pixels, Width, Height, OutWebP))
+        bool HasPending() const
         {
+            for (const TPair<int32, TSharedRef<FPrefetchRequest>>& Pair : Requests)
+            {
+                if (!Pair.Value->bDone)
+                {
+                    return true;
+                }
+            }
             return false;
         }
-        return true;
-    }
 
-    static bool CaptureBlueprint(UBlueprint* BP, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
-    {
-        if (!BP || !BP->GeneratedClass)
+        // ExtraAhead widens the count limit for callers with their own window (shader precompile).
+        bool CanRequest(int64 EstimatedBytes, int32 ExtraAhead = 0) const
         {
-            return false;
+            if (Requests.Num() >= MaxAhead + ExtraAhead)
+            {
+                return false;
+            }
+            // A single package larger than the budget is still prefetched on its own.
+            return Requests.Num() == 0 || BytesAhead + EstimatedBytes <= BudgetBytes;
         }
 
-        UClass* Cls = BP->GeneratedClass;
-        if (!Cls->IsChildOf(AActor::StaticClass()))
+        void Request(int32 Index, const FAssetData& AD, int64 EstimatedBytes)
         {
-            return false;
-        }
+            if (Requests.Contains(Index))
+            {
+                return;
+            }
 
-		FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
+            TSharedRef<FPrefetchRequest> Req = MakeShared<FPrefetchRequest>();
+            Req->EstimatedBytes = EstimatedBytes;
+            Requests.Add(Index, Req);
+            BytesAhead += EstimatedBytes;
 
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+            const FSoftObjectPath ObjectPath = AD.GetSoftObjectPath();
+            Req->RequestId = LoadPackageAsync(
+                AD.PackageName.ToString(),
+                FLoadPackageAsyncDelegate::CreateLambda([Req, ObjectPath](const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+                {
+                    Req->bDone = true;
+                    if (LoadedPackage && Result == EAsyncLoadingResult::Succeeded)
+                    {
+                        Req->Asset.Reset(ObjectPath.ResolveObject());
+                    }
+                    else
+                    {
+                        UE_LOG(LogAssetSnapshot, Warning, TEXT("Prefetch: failed to load %s"), *PackageName.ToString());
+                    }
+                }));
+            UE_LOG(LogAssetSnapshot, Verbose, TEXT("Prefetch: requested %s (%lld bytes on disk, %d ahead)"), *AD.PackageName.ToString(), EstimatedBytes, Requests.Num());
+        }
+
+        // The asset of Index once its async load finished, without taking it over.
+        UObject* PeekLoaded(int32 Index) const
         {
-            return false;
+            const TSharedRef<FPrefetchRequest>* Found = Requests.Find(Index);
+            return (Found && (*Found)->bDone) ? (*Found)->Asset.Get() : nullptr;
         }
 
-        FActorSpawnParameters Params;
-        Params.ObjectFlags = RF_Transient;
-        Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-        AActor* A = World->SpawnActor<AActor>(Cls, FTransform::Identity, Params);
-        if (!A)
+        // Hands over a finished load (null if it failed) and forgets the request;
+        // false while Index is still loading or was never requested.
+        bool TakeFinished(int32 Index, UObject*& OutAsset)
         {
-            return false;
+            const TSharedRef<FPrefetchRequest>* Found = Requests.Find(Index);
+            if (!Found || !(*Found)->bDone)
+            {
+                return false;
+            }
+            OutAsset = (*Found)->Asset.Get();
+            BytesAhead = FMath::Max<int64>(0, BytesAhead - (*Found)->EstimatedBytes);
+            Requests.Remove(Index);
+            return true;
         }
 
-        // Center actor
-        const FBox Box = A->GetComponentsBoundingBox(true);
-        const FVector Center = Box.GetCenter();
-        A->SetActorLocation(-Center);
-        
-        // Rotate actor 90° around Z-axis
-        FRotator ActorRotation = A->GetActorRotation();
-        ActorRotation.Yaw += 90.f;  // Add 90° rotation towards camera
-        A->SetActorRotation(ActorRotation);
+        // Returns the loaded asset for Index, finishing its async load if needed.
+        // Falls back to a synchronous load for assets that were never prefetched.
+        UObject* Acquire(int32 Index, const FAssetData& AD)
+        {
+            TSharedPtr<FPrefetchRequest> Req;
+            if (TSharedRef<FPrefetchRequest>* Found = Requests.Find(Index))
+            {
+                Req = *Found;
+                Requests.Remove(Index);
+                BytesAhead = FMath::Max<int64>(0, BytesAhead - Req->EstimatedBytes);
+            }
 
-        const float Radius = Box.GetExtent().Size();
-        const float BlueprintPadding = FMath::Max(1.05f, kDistancePadding * 0.75f);
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, BlueprintPadding);
-        const FVector ViewDir = ChooseStableViewDirFromBoxExtent(Box.GetExtent());
-        return CapturePreviewSceneToWebPBytes(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir);
-    }
+            if (Req.IsValid() && !Req->bDone && Req->RequestId != INDEX_NONE)
+            {
+                FlushAsyncLoading(Req->RequestId);
+            }
 
-    static bool CaptureBlueprintMultiFrame(UBlueprint* BP, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance)
-    {
-        OutFrames.Reset();
-        if (!BP || !BP->GeneratedClass)
+            if (Req.IsValid() && Req->Asset.IsValid())
+            {
+                return Req->Asset.Get();
+            }
+            return AD.GetAsset();
+        }
+
+        void Pump(float TimeLimitSeconds)
         {
-            return false;
+            if (HasPending())
+            {
+                ProcessAsyncLoading(true, false, TimeLimitSeconds);
+            }
         }
 
-        UClass* Cls = BP->GeneratedClass;
-        if (!Cls->IsChildOf(AActor::StaticClass()))
+        void FlushAll()
         {
-            return false;
+            for (const TPair<int32, TSharedRef<FPrefetchRequest>>& Pair : Requests)
+            {
+                if (!Pair.Value->bDone && Pair.Value->RequestId != INDEX_NONE)
+                {
+                    FlushAsyncLoading(Pair.Value->RequestId);
+                }
+            }
+            Requests.Reset();
+            BytesAhead = 0;
         }
+    };
 
-        FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
+    static FPackagePrefetcher* GPackagePrefetcher = nullptr;
 
-        UWorld* World = Scene.GetWorld();
-        if (!World)
+    // Sleeps for the given time, spending it on pending prefetch loads first.
+    static void IdleWithPrefetch(float Seconds)
+    {
+        const double EndSec = FPlatformTime::Seconds() + Seconds;
+        if (GPackagePrefetcher)
         {
-            return false;
+            GPackagePrefetcher->Pump(Seconds);
         }
-
-        FActorSpawnParameters Params;
-        Params.ObjectFlags = RF_Transient;
-        Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-        AActor* A = World->SpawnActor<AActor>(Cls, FTransform::Identity, Params);
-        if (!A)
+        const double Remaining = EndSec - FPlatformTime::Seconds();
+        if (Remaining > 0.0)
         {
-            return false;
+            FPlatformProcess::Sleep((float)Remaining);
         }
+    }
 
-        const FBox Box = A->GetComponentsBoundingBox(true);
-        const FVector Center = Box.GetCenter();
-        A->SetActorLocation(-Center);
+    // ============================================================================
+    // BATCH GC POLICY
+    // ============================================================================
+    // A full GC costs more than exporting a small material, while a handful of
+    // large skeletal meshes can exhaust memory between fixed intervals. Collect
+    // when resident memory nears the budget, when many UObjects piled up since
+    // the last pass, or after a safety interval of loaded assets. Above the soft
+    // limit the prefetcher stops looking ahead.
+    // ============================================================================
+    static const double kGCSoftPressure = 0.75;
+    static const double kGCHardPressure = 0.9;
+    static const int32 kGCObjectGrowthLimit = 200000;
 
-        const FRotator ActorRotation = A->GetActorRotation();
-        A->SetActorRotation(ActorRotation + FRotator(0.f, 90.f, 0.f));
+    struct FBatchGCPolicy
+    {
+        uint64 BudgetBytes = 0;
+        int32 MaxAssetsBetween = 50;
+        int32 LoadedSinceGC = 0;
+        int32 ObjectsAfterGC = 0;
+        int32 Collections = 0;
+        double TotalSeconds = 0.0;
+
+        void Init()
+        {
+            const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+            const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+            const int32 BudgetMB = Settings ? Settings->GCMemoryBudgetMB : 0;
+            MaxAssetsBetween = Settings ? FMath::Max(1, Settings->GCMaxAssetsBetween) : 50;
+            // 0 = three quarters of physical memory, leaving room for the renderer and other processes.
+            BudgetBytes = BudgetMB > 0 ? (uint64)BudgetMB * 1024 * 1024 : (uint64)(Stats.TotalPhysical * 0.75);
+            ObjectsAfterGC = GUObjectArray.GetObjectArrayNumMinusAvailable();
+        }
+
+        // Used fraction of the budget; a nearly full machine counts as over budget.
+        double GetPressure() const
+        {
+            const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+            double Pressure = BudgetBytes > 0 ? (double)Stats.UsedPhysical / (double)BudgetBytes : 0.0;
+            if (Stats.TotalPhysical > 0 && Stats.AvailablePhysical < Stats.TotalPhysical / 10)
+            {
+                Pressure = FMath::Max(Pressure, 1.0);
+            }
+            return Pressure;
+        }
 
-        const float Radius = Box.GetExtent().Size();
-        const float BlueprintPadding = FMath::Max(1.05f, kDistancePadding * 0.75f);
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, BlueprintPadding);
-        const FVector ViewDir = ChooseStableViewDirFromBoxExtent(Box.GetExtent());
+        bool IsUnderPressure() const
+        {
+            return GetPressure() >= kGCSoftPressure;
+        }
 
-        const int32 FramesToKeep = GetBlueprintFrameCount();
-        const int32 FramesToDiscard = GetCapture360DiscardCount();
-        const int32 FramesTotal = FramesToKeep + FramesToDiscard;
-        OutFrames.Reserve(FramesToKeep);
-        for (int32 i = 0; i < FramesTotal; ++i)
+        void NoteLoaded()
         {
-            if (i > 0)
+            ++LoadedSinceGC;
+        }
+
+        void CollectIfNeeded()
+        {
+            if (LoadedSinceGC <= 0)
             {
-                World->Tick(LEVELTICK_All, kCapture360FrameInterval);
-                A->MarkComponentsRenderStateDirty();
-                FlushRenderingCommands();
-                FPlatformProcess::Sleep(kCapture360FrameInterval);
+                return;
             }
-
-            float CameraYaw = 0.0f;
-            if (i >= FramesToDiscard)
+            const double Pressure = GetPressure();
+            const int32 ObjectGrowth = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsAfterGC;
+            if (Pressure >= kGCHardPressure)
             {
-                const int32 FrameIndex = i - FramesToDiscard;
-                CameraYaw = (360.0f / (float)FramesToKeep) * FrameIndex;
+                Collect(TEXT("memory"), Pressure);
             }
-
-            TArray<uint8> WebP;
-            if (CapturePreviewSceneToWebPBytes(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, WebP, ViewDir, CameraYaw))
+            else if (ObjectGrowth >= kGCObjectGrowthLimit)
             {
-                if (i >= FramesToDiscard)
-                {
-                    FZipEntry Frame;
-                    Frame.NameInZip = FString::Printf(TEXT("%d.webp"), OutFrames.Num());
-                    Frame.Data = MoveTemp(WebP);
-                    OutFrames.Add(MoveTemp(Frame));
-                }
+                Collect(TEXT("objects"), Pressure);
+            }
+            else if (LoadedSinceGC >= MaxAssetsBetween)
+            {
+                Collect(TEXT("interval"), Pressure);
             }
         }
 
-        return OutFrames.Num() > 0;
-    }
-
-#if ASSETSNAPSHOT_WITH_NIAGARA
-    static bool CaptureNiagara(UNiagaraSystem* Sys, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
-    {
-        if (!Sys)
+        void Collect(const TCHAR* Reason, double Pressure)
         {
-            return false;
-        }
+            const double StartSec = FPlatformTime::Seconds();
+            const uint64 UsedBefore = FPlatformMemory::GetStats().UsedPhysical;
 
-		FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
+            // Forced (fully streamed) capture textures would otherwise stay resident.
+            IStreamingManager::Get().CancelForcedResources();
+            CollectGarbage(RF_NoFlags);
+            if (Pressure >= kGCHardPressure)
+            {
+                // Let streaming release the mips of what was just collected right away.
+                FlushRenderingCommands();
+                IStreamingManager::Get().UpdateResourceStreaming(0.0f, true);
+                IStreamingManager::Get().BlockTillAllRequestsFinished(1.0f, false);
+            }
 
-        UWorld* World = Scene.GetWorld();
-        if (!World)
-        {
-            return false;
+            const double Seconds = FPlatformTime::Seconds() - StartSec;
+            const uint64 UsedAfter = FPlatformMemory::GetStats().UsedPhysical;
+            TotalSeconds += Seconds;
+            ++Collections;
+            UE_LOG(LogAssetSnapshot, Log, TEXT("GC (%s) after %d loaded asset(s): %.2fs, %.0f -> %.0f MB resident, %.0f%% of budget"),
+                Reason, LoadedSinceGC, Seconds, UsedBefore / (1024.0 * 1024.0), UsedAfter / (1024.0 * 1024.0), Pressure * 100.0);
+            LoadedSinceGC = 0;
+            ObjectsAfterGC = GUObjectArray.GetObjectArrayNumMinusAvailable();
         }
 
-        AActor* A = World->SpawnActor<AActor>();
-        UNiagaraComponent* Comp = NewObject<UNiagaraComponent>(A);
-        Comp->SetAsset(Sys);
-        Comp->SetAutoActivate(true);
-        Comp->RegisterComponentWithWorld(World);
-        A->SetRootComponent(Comp);
-        A->SetActorLocation(FVector::ZeroVector);
-        
-        // Rotate actor 90° around Z-axis
-        FRotator ActorRotation = A->GetActorRotation();
-        ActorRotation.Yaw += 90.f;  // Add 90° rotation towards camera
-        A->SetActorRotation(ActorRotation);
-
-        // Let it simulate a bit
-        for (int32 i = 0; i < 30; ++i)
+        void LogSummary() const
         {
-            const float Dt = 1.f / 60.f;
-            World->Tick(LEVELTICK_All, Dt);
-            IStreamingManager::Get().Tick(Dt);
+            UE_LOG(LogAssetSnapshot, Log, TEXT("GC: %d collection(s), %.2fs total, budget %.0f MB"),
+                Collections, TotalSeconds, BudgetBytes / (1024.0 * 1024.0));
         }
-        FlushRenderingCommands();
-
-        ForceComponentTexturesResident(Comp);
+    };
 
-        const FBoxSphereBounds B = Comp->Bounds;
-        const float Radius = FMath::Max(100.f, B.SphereRadius);
-        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.35f);
-        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();  // Y-axis
-        return CapturePreviewSceneToWebPBytes(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir);
+    static int32 ClampPreviewResolution(int32 InResolution)
+    {
+        return FMath::Clamp(InResolution, 128, 2048);
     }
-#endif
 
-    static bool CaptureAnimSequence(UAnimSequence* Anim, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance, float& OutAnimLen)
+    static int32 GetMaterialPreviewResolution(UMaterialInterface* Mat, int32 Fallback)
     {
-        if (!Anim)
+        if (!Mat)
         {
-            return false;
+            return ClampPreviewResolution(Fallback);
         }
 
-        OutAnimLen = Anim->GetPlayLength();
-        const int32 FrameCount = FMath::Clamp(GetAnimFrameCount(), 1, 32);
+        TArray<UTexture*> Used;
+        Mat->GetUsedTextures(Used);
 
-        USkeletalMesh* PreviewMesh = nullptr;
-#if WITH_EDITOR
-        PreviewMesh = Anim->GetPreviewMesh();
-#endif
-        if (!PreviewMesh && Anim->GetSkeleton())
-        {
-#if WITH_EDITOR
-            PreviewMesh = Anim->GetSkeleton()->GetPreviewMesh();
-#endif
-        }
-        if (!PreviewMesh)
+        int32 MaxDim = 0;
+        for (UTexture* Tex : Used)
         {
-            return false;
+            if (!Tex)
+            {
+                continue;
+            }
+            MaxDim = FMath::Max(MaxDim, (int32)Tex->GetSurfaceWidth());
+            MaxDim = FMath::Max(MaxDim, (int32)Tex->GetSurfaceHeight());
         }
 
-		FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
-        SetupDefaultLights(Scene);
-
-        UWorld* World = Scene.GetWorld();
-        if (!World)
-        {
-            return false;
-        }
+        const int32 Base = (MaxDim > 0) ? MaxDim : Fallback;
+        return FMath::Max(kMinMaterialResolution, ClampPreviewResolution(Base));
+    }
 
-        USkeletalMeshComponent* Comp = NewObject<USkeletalMeshComponent>(GetTransientPackage());
-        Comp->SetSkeletalMesh(PreviewMesh);
-        Comp->SetMobility(EComponentMobility::Movable);
-        Comp->RegisterComponentWithWorld(World);
-        Scene.AddComponent(Comp, FTransform::Identity);
-        Comp->SetForcedLOD(1);
+    static int32 GetTexturePreviewResolution(UTexture2D* Tex, int32 Fallback)
+    {
+        return ClampPreviewResolution(kTexturePreviewResolution);
+    }
 
-        Comp->SetAnimationMode(EAnimationMode::AnimationSingleNode);
-        Comp->SetAnimation(Anim);
-        Comp->Stop();
+    static void ComputeTextureCaptureSize(UTexture2D* Tex, int32 Fallback, int32& OutWidth, int32& OutHeight)
+    {
+        const int32 Target = ClampPreviewResolution(kTexturePreviewResolution);
+        OutWidth = Target;
+        OutHeight = Target;
+    }
 
-        // Ensure materials/textures are resident before the first capture
-        ForceComponentTexturesResident(Comp);
+    // Pick a stable "good for vision" view direction.
+    // Heuristic: look along the *thinnest* horizontal axis (X or Y). That usually produces
+    // a readable side-profile (e.g. pistols) instead of a front/back view.
+    static FVector ChooseStableViewDirFromBoxExtent(const FVector& BoxExtent)
+    {
+        const bool bUseX = (BoxExtent.X < BoxExtent.Y);
+        const FVector Horizontal = bUseX ? FVector(-1.f, 0.f, 0.f) : FVector(0.f, -1.f, 0.f);
+        return (Horizontal + FVector(0.f, 0.f, 0.05f)).GetSafeNormal();
+    }
 
-        Comp->UpdateBounds();
-        const FVector CenterOffset = -Comp->Bounds.Origin;
-        const FVector ViewDir = FVector(1.f, 0.f, 0.02f).GetSafeNormal();
-        Comp->SetWorldLocation(CenterOffset);
-        
-        // Rotate mesh: base rotation + 90° around Z-axis
-        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
-        BaseRotation.Yaw += 90.f;  // Add 90° rotation towards camera
-        Comp->SetWorldRotation(BaseRotation);
-        Comp->UpdateBounds();
-        OutDistance = ComputeCameraDistanceFromBounds(Comp->Bounds.SphereRadius, kDefaultFov, kDistancePadding);
 
-        // Pre-roll to let streaming/shaders settle before the first frame
-        WarmupWorld(World, kWarmupSeconds);
-        ForceComponentTexturesResident(Comp);
+    static void SetupDefaultLights(FPreviewScene& Scene)
+    {
+        // Enhanced 3-point lighting for 360° view
+        // Key Light (Main) - Front-left, brighter
+        UDirectionalLightComponent* Key = NewObject<UDirectionalLightComponent>(GetTransientPackage());
+        Key->Intensity = 2.0f;  // Increased from 1.25
+		Key->SetCastShadows(true);
+        Key->LightColor = FColor::White;
+        Scene.AddComponent(Key, FTransform(FRotator(-30.f, 45.f, 0.f), FVector::ZeroVector));
 
-        OutFrames.Reset();
+        // Fill Light (Secondary) - Front-right
+        UDirectionalLightComponent* Fill = NewObject<UDirectionalLightComponent>(GetTransientPackage());
+        Fill->Intensity = 1.2f;  // Increased from 0.625
+		Fill->SetCastShadows(false);
+        Fill->LightColor = FColor::White;
+        Scene.AddComponent(Fill, FTransform(FRotator(-20.f, -120.f, 0.f), FVector::ZeroVector));
+
+        // Rim Light (Back) - From behind for edge definition
+        UDirectionalLightComponent* Rim = NewObject<UDirectionalLightComponent>(GetTransientPackage());
+        Rim->Intensity = 1.0f;  // Increased from 0.75
+		Rim->SetCastShadows(false);
+        Rim->LightColor = FColor::White;
+        Scene.AddComponent(Rim, FTransform(FRotator(20.f, 180.f, 0.f), FVector::ZeroVector));
+
+        // Additional Side Lights for 360° coverage
+        UDirectionalLightComponent* SideLeft = NewObject<UDirectionalLightComponent>(GetTransientPackage());
+        SideLeft->Intensity = 0.8f;
+		SideLeft->SetCastShadows(false);
+        SideLeft->LightColor = FColor::White;
+        Scene.AddComponent(SideLeft, FTransform(FRotator(-25.f, -90.f, 0.f), FVector::ZeroVector));
+
+        UDirectionalLightComponent* SideRight = NewObject<UDirectionalLightComponent>(GetTransientPackage());
+        SideRight->Intensity = 0.8f;
+		SideRight->SetCastShadows(false);
+        SideRight->LightColor = FColor::White;
+        Scene.AddComponent(SideRight, FTransform(FRotator(-25.f, 90.f, 0.f), FVector::ZeroVector));
+
+        // Sky Light - Overall ambient for consistent 360° lighting
+        USkyLightComponent* Sky = NewObject<USkyLightComponent>(GetTransientPackage());
+        Sky->Intensity = 0.5f;  // Increased from 0.25
+        Sky->LightColor = FColor::White;
+        Sky->bLowerHemisphereIsBlack = false;
+        Scene.AddComponent(Sky, FTransform::Identity);
+    }
+
+    static bool InitMaterialCaptureContext(FMaterialCaptureContext& Ctx)
+    {
+        SetupDefaultLights(Ctx.Scene);
+
+        Ctx.World = Ctx.Scene.GetWorld();
+        if (!Ctx.World)
+        {
+            return false;
+        }
+
+        UStaticMesh* Sphere = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+        if (!Sphere)
+        {
+            return false;
+        }
+
+        Ctx.Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
+        Ctx.Comp->SetStaticMesh(Sphere);
+        Ctx.Comp->SetMobility(EComponentMobility::Movable);
+        Ctx.Comp->RegisterComponentWithWorld(Ctx.World);
+        Ctx.Comp->SetWorldScale3D(FVector(2.0f));
+        Ctx.Comp->SetWorldRotation(FRotator(0.f, 270.f, 0.f));  // 270Жј
+        Ctx.Comp->UpdateBounds();
+
+        Ctx.Scene.AddComponent(Ctx.Comp, FTransform::Identity);
+        Ctx.Comp->MarkRenderStateDirty();
+
+        const FBoxSphereBounds B = Ctx.Comp->Bounds;
+        const float Radius = B.SphereRadius;
+        Ctx.Distance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.05f);
+        Ctx.ViewDir = FVector(1.f, 0.f, 0.f);
+        return true;
+    }
+
+    static TUniquePtr<FCaptureStage> CreateCaptureStage()
+    {
+        TUniquePtr<FCaptureStage> Stage = MakeUnique<FCaptureStage>();
+        SetupDefaultLights(Stage->Scene);
+        Stage->World = Stage->Scene.GetWorld();
+        return Stage;
+    }
+
+    // Stage for one capture: pooled during batches, temporary otherwise. The subject is removed on scope exit.
+    struct FScopedCaptureStage
+    {
+        TUniquePtr<FCaptureStage> Owned;
+        FCaptureStage* Stage = nullptr;
+
+        explicit FScopedCaptureStage(ECaptureStageKind Kind)
+        {
+            if (GCaptureStagePool)
+            {
+                TUniquePtr<FCaptureStage>& Pooled = GCaptureStagePool->Stages[(int32)Kind];
+                if (!Pooled)
+                {
+                    Pooled = CreateCaptureStage();
+                }
+                Stage = Pooled.Get();
+            }
+            else
+            {
+                Owned = CreateCaptureStage();
+                Stage = Owned.Get();
+            }
+            ++Stage->Uses;
+        }
+
+        ~FScopedCaptureStage()
+        {
+            Stage->ClearSubjects();
+        }
+
+        FCaptureStage* operator->() const { return Stage; }
+    };
+
+    static void ForceComponentTexturesResident(UPrimitiveComponent* Comp)
+{
+    if (!Comp)
+    {
+        return;
+    }
+
+    TSet<UTexture*> UniqueTextures;
+
+    Comp->bForceMipStreaming = true;
+
+    TArray<UTexture*> Used;
+    Comp->GetUsedTextures(Used, EMaterialQualityLevel::High);
+    for (UTexture* Tex : Used)
+    {
+        if (Tex)
+        {
+            UniqueTextures.Add(Tex);
+        }
+    }
+
+    for (UTexture* Tex : UniqueTextures)
+    {
+        Tex->SetForceMipLevelsToBeResident(30.0f);
+    }
+
+    // Only requests residency; WaitForCaptureReady waits for exactly these textures.
+    Comp->MarkRenderStateDirty();
+}
+
+    // ============================================================================
+    // CAPTURE RIG
+    // ============================================================================
+    // One scene capture per preview world, render targets per resolution and the
+    // readback buffer stay alive across frames and assets instead of spawning an
+    // actor, allocating a render target and a pixel array for every frame.
+    // Capture actors belong to their world (weak here, so temporary worlds can go);
+    // render targets are owned by the rig.
+    // ============================================================================
+    class FCaptureRig : public FGCObject
+    {
+    public:
+        virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+        {
+            Collector.AddReferencedObjects(RenderTargets);
+        }
+
+        virtual FString GetReferencerName() const override
+        {
+            return TEXT("AssetSnapshot::FCaptureRig");
+        }
+
+        USceneCaptureComponent2D* GetCapture(UWorld* World)
+        {
+            for (auto It = Captures.CreateIterator(); It; ++It)
+            {
+                if (!It->Key.IsValid() || !It->Value.IsValid())
+                {
+                    It.RemoveCurrent();
+                }
+            }
+            if (const TWeakObjectPtr<USceneCaptureComponent2D>* Existing = Captures.Find(World))
+            {
+                return Existing->Get();
+            }
+
+            AActor* CaptureActor = World->SpawnActor<AActor>();
+            USceneCaptureComponent2D* Capture = NewObject<USceneCaptureComponent2D>(CaptureActor);
+            Capture->RegisterComponentWithWorld(World);
+            CaptureActor->SetRootComponent(Capture);
+
+            Capture->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+            Capture->bCaptureEveryFrame = false;
+            Capture->bCaptureOnMovement = false;
+            Capture->PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_RenderScenePrimitives;
+
+            // Make sure post process / exposure doesn't blow out and doesn't add noise
+            Capture->PostProcessSettings.bOverride_AutoExposureMethod = true;
+            Capture->PostProcessSettings.AutoExposureMethod = EAutoExposureMethod::AEM_Manual;
+            Capture->PostProcessSettings.bOverride_AutoExposureBias = true;
+            Capture->PostProcessSettings.AutoExposureBias = 0.0f;
+
+            Capture->PostProcessSettings.bOverride_MotionBlurAmount = true;
+            Capture->PostProcessSettings.MotionBlurAmount = 0.0f;
+            Capture->PostProcessSettings.bOverride_VignetteIntensity = true;
+            Capture->PostProcessSettings.VignetteIntensity = 0.0f;
+            Capture->PostProcessSettings.bOverride_SceneFringeIntensity = true;
+            Capture->PostProcessSettings.SceneFringeIntensity = 0.0f;
+
+            Captures.Add(World, Capture);
+            return Capture;
+        }
+
+        // Slot > 0: extra targets for frames still being read back (pipelined captures).
+        UTextureRenderTarget2D* GetRenderTarget(int32 Resolution, int32 Slot = 0)
+        {
+            const FIntPoint Key(Resolution, Slot);
+            if (TObjectPtr<UTextureRenderTarget2D>* Existing = RenderTargets.Find(Key))
+            {
+                return *Existing;
+            }
+
+            UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
+            RT->InitCustomFormat(Resolution, Resolution, PF_B8G8R8A8, false);
+            RT->ClearColor = FLinearColor::Black;
+            RT->TargetGamma = 1.8f;  // Compromise between too dark (1.0) and too bright (2.2)
+            RT->UpdateResourceImmediate(true);
+            RenderTargets.Add(Key, RT);
+            return RT;
+        }
+
+        TArray<FColor> Pixels;
+
+    private:
+        TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<USceneCaptureComponent2D>> Captures;
+        TMap<FIntPoint, TObjectPtr<UTextureRenderTarget2D>> RenderTargets;
+    };
+
+    static FCaptureRig* GCaptureRig = nullptr;
+
+    // Installs a rig for the scope unless an outer scope (the batch) already did.
+    struct FScopedCaptureRig
+    {
+        TUniquePtr<FCaptureRig> Owned;
+
+        FScopedCaptureRig()
+        {
+            if (!GCaptureRig)
+            {
+                Owned = MakeUnique<FCaptureRig>();
+                GCaptureRig = Owned.Get();
+            }
+        }
+
+        ~FScopedCaptureRig()
+        {
+            if (Owned)
+            {
+                GCaptureRig = nullptr;
+            }
+        }
+    };
+
+    // Positions the rig camera and submits one capture. No readback.
+    static UTextureRenderTarget2D* RenderPreviewSceneFrame(
+        FPreviewScene& Scene,
+        const FVector& LookAt,
+        float Distance,
+        float FovDeg,
+        int32 Resolution,
+        const FVector& ViewDirFromLookAt,
+        float YawRotationDegrees,
+        int32 TargetSlot = 0)
+    {
+        UWorld* World = Scene.GetWorld();
+        if (!World || !GCaptureRig)
+        {
+            return nullptr;
+        }
+
+        USceneCaptureComponent2D* Capture = GCaptureRig->GetCapture(World);
+        UTextureRenderTarget2D* RT = GCaptureRig->GetRenderTarget(Resolution, TargetSlot);
+        Capture->TextureTarget = RT;
+        Capture->FOVAngle = FovDeg;
+
+        // Position camera using a stable view direction
+        FVector ViewDir = ViewDirFromLookAt.IsNearlyZero() ? FVector(0.f, -1.f, 0.f) : ViewDirFromLookAt.GetSafeNormal();
+        
+        // Rotate camera around asset for 360° view
+        if (FMath::Abs(YawRotationDegrees) > 0.01f)
+        {
+            FRotator Rotation(0.f, YawRotationDegrees, 0.f);
+            ViewDir = Rotation.RotateVector(ViewDir);
+        }
+        
+        const FVector CamPos = LookAt + (ViewDir * Distance);
+        const FRotator CamRot = (LookAt - CamPos).Rotation();
+        Capture->SetWorldLocationAndRotation(CamPos, CamRot);
+
+        Capture->CaptureScene();
+        return RT;
+    }
+
+    // Warmup frame: renders like a kept frame (streaming, shaders, temporal history)
+    // but skips readback and encoding.
+    static bool WarmupPreviewSceneFrame(
+        FPreviewScene& Scene,
+        const FVector& LookAt,
+        float Distance,
+        float FovDeg,
+        int32 Resolution,
+        const FVector& ViewDirFromLookAt,
+        float YawRotationDegrees = 0.0f)
+    {
+        FScopedCaptureRig Rig;
+        return RenderPreviewSceneFrame(Scene, LookAt, Distance, FovDeg, Resolution, ViewDirFromLookAt, YawRotationDegrees) != nullptr;
+    }
+
+    // Renders one frame and reads it back synchronously.
+    static bool ReadPreviewSceneFrame(
+        FPreviewScene& Scene,
+        const FVector& LookAt,
+        float Distance,
+        float FovDeg,
+        int32 Resolution,
+        const FVector& ViewDirFromLookAt,
+        float YawRotationDegrees,
+        TArray<FColor>& OutPixels)
+    {
+        FScopedCaptureRig Rig;
+        UTextureRenderTarget2D* RT = RenderPreviewSceneFrame(Scene, LookAt, Distance, FovDeg, Resolution, ViewDirFromLookAt, YawRotationDegrees);
+        if (!RT)
+        {
+            return false;
+        }
+        FlushRenderingCommands();
+
+        FTextureRenderTargetResource* Res = RT->GameThread_GetRenderTargetResource();
+        if (!Res)
+        {
+            return false;
+        }
+
+        FReadSurfaceDataFlags Flags(RCM_UNorm);
+        Flags.SetLinearToGamma(true);
+        return Res->ReadPixels(OutPixels, Flags) && OutPixels.Num() == Resolution * Resolution;
+    }
+
+    static bool CapturePreviewSceneToWebPBytes(
+        FPreviewScene& Scene,
+        const FVector& LookAt,
+        float Distance,
+        float FovDeg,
+        int32 Resolution,
+        TArray<uint8>& OutWebP,
+        const FVector& ViewDirFromLookAt,
+        float YawRotationDegrees = 0.0f,  // 360° view rotation
+        EWebPContent Content = EWebPContent::Scene,
+        TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe>* OutPixels = nullptr,
+        FIntRect* OutCrop = nullptr)  // auto-crop only applies when the caller records the rect
+    {
+        FScopedCaptureRig Rig;
+        TArray<FColor>& Pixels = GCaptureRig->Pixels;
+        if (!ReadPreviewSceneFrame(Scene, LookAt, Distance, FovDeg, Resolution, ViewDirFromLookAt, YawRotationDegrees, Pixels))
+        {
+            return false;
+        }
+
+        if (OutPixels)
+        {
+            *OutPixels = MakeShared<TArray<FColor>, ESPMode::ThreadSafe>(Pixels);
+        }
+        const FIntRect Crop = OutCrop ? ComputeCropRect(Pixels, Resolution) : FIntRect();
+        if (OutCrop)
+        {
+            *OutCrop = Crop;
+        }
+        return EncodeWebPFromBGRA(Pixels, Resolution, Resolution, OutWebP, GetWebPEncodeOptions(Content), Crop);
+    }
+
+    // ============================================================================
+    // CAPTURE READINESS
+    // ============================================================================
+    // Instead of fixed pauses and global streaming waits, ticks the preview world
+    // until the subject itself is ready: its textures fully streamed in, its
+    // materials' shader maps complete, and two consecutive low-res probe renders
+    // identical. Bounded per capture class; the time spent is recorded in meta.
+    // ============================================================================
+    enum class ECaptureGateClass : uint8
+    {
+        Mesh,
+        Blueprint,
+        Niagara,
+        Material,
+        Anim
+    };
+
+    static const float kGateTickSeconds = 1.f / 30.f;
+    static const int32 kGateProbeResolution = 64;
+    static const int32 kGateProbeTolerance = 1;  // per channel, absorbs dithering
+
+    static float GetCaptureGateLimitSeconds(ECaptureGateClass GateClass)
+    {
+        switch (GateClass)
+        {
+        case ECaptureGateClass::Mesh: return 6.0f;
+        case ECaptureGateClass::Blueprint: return 8.0f;
+        case ECaptureGateClass::Niagara: return 4.0f;
+        case ECaptureGateClass::Material: return 10.0f;
+        case ECaptureGateClass::Anim: return 8.0f;
+        }
+        return 8.0f;
+    }
+
+    // Accumulated per exported asset (reset in ExportPlannedAsset).
+    static double GCaptureWaitSeconds = 0.0;
+    static bool GCaptureWaitTimedOut = false;
+
+    static bool AreTexturesReady(const TArray<UTexture*>& Textures)
+    {
+        for (UTexture* Tex : Textures)
+        {
+            if (!Tex)
+            {
+                continue;
+            }
+#if WITH_EDITOR
+            if (Tex->IsCompiling())
+            {
+                return false;
+            }
+#endif
+            if (Tex->HasPendingInitOrStreaming() || !Tex->IsFullyStreamedIn())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool AreShaderMapsReady(const TArray<UMaterialInterface*>& Materials, ERHIFeatureLevel::Type FeatureLevel)
+    {
+        for (UMaterialInterface* Mat : Materials)
+        {
+            const FMaterialResource* Res = Mat ? Mat->GetMaterialResource(FeatureLevel) : nullptr;
+            if (Res && (!Res->IsCompilationFinished() || !Res->IsGameThreadShaderMapComplete()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if WITH_EDITOR
+    // Compile waits are scoped to the subject: its meshes and textures are finished
+    // explicitly, everything else in the editor keeps compiling in the background.
+    static void FinishMeshCompilation(UObject* Asset)
+    {
+        if (UStaticMesh* SM = Cast<UStaticMesh>(Asset))
+        {
+            if (SM->IsCompiling())
+            {
+                FStaticMeshCompilingManager::Get().FinishCompilation({ SM });
+            }
+        }
+        else if (USkinnedAsset* Skinned = Cast<USkinnedAsset>(Asset))
+        {
+            if (Skinned->IsCompiling())
+            {
+                FSkinnedAssetCompilingManager::Get().FinishCompilation({ Skinned });
+            }
+        }
+    }
+
+    static void FinishSubjectCompilation(const TArray<UPrimitiveComponent*>& Subjects, const TArray<UTexture*>& Textures)
+    {
+        for (UPrimitiveComponent* Comp : Subjects)
+        {
+            if (const UStaticMeshComponent* SMC = Cast<UStaticMeshComponent>(Comp))
+            {
+                FinishMeshCompilation(SMC->GetStaticMesh());
+            }
+            else if (const USkinnedMeshComponent* SKC = Cast<USkinnedMeshComponent>(Comp))
+            {
+                FinishMeshCompilation(SKC->GetSkinnedAsset());
+            }
+        }
+
+        TArray<UTexture*> CompilingTextures;
+        for (UTexture* Tex : Textures)
+        {
+            if (Tex && Tex->IsCompiling())
+            {
+                CompilingTextures.Add(Tex);
+            }
+        }
+        if (CompilingTextures.Num() > 0)
+        {
+            FTextureCompilingManager::Get().FinishCompilation(CompilingTextures);
+        }
+    }
+
+    // Last resort after the gate timed out: block on the subject's own shader maps only.
+    static void FinishSubjectShaderMaps(const TArray<UMaterialInterface*>& Materials, ERHIFeatureLevel::Type FeatureLevel)
+    {
+        for (UMaterialInterface* Mat : Materials)
+        {
+            FMaterialResource* Res = Mat ? Mat->GetMaterialResource(FeatureLevel) : nullptr;
+            if (Res && !Res->IsGameThreadShaderMapComplete())
+            {
+                Res->FinishCompilation();
+            }
+        }
+    }
+
+    // Applies results of compiles that already finished (any owner) without waiting.
+    static void ProcessFinishedCompilation()
+    {
+        FAssetCompilingManager::Get().ProcessAsyncTasks(true);
+        if (GShaderCompilingManager)
+        {
+            GShaderCompilingManager->ProcessAsyncResults(true, false);
+        }
+    }
+#endif
+
+    static bool ProbesMatch(const TArray<FColor>& A, const TArray<FColor>& B)
+    {
+        if (A.Num() == 0 || A.Num() != B.Num())
+        {
+            return false;
+        }
+        for (int32 i = 0; i < A.Num(); ++i)
+        {
+            if (FMath::Abs((int32)A[i].R - (int32)B[i].R) > kGateProbeTolerance
+                || FMath::Abs((int32)A[i].G - (int32)B[i].G) > kGateProbeTolerance
+                || FMath::Abs((int32)A[i].B - (int32)B[i].B) > kGateProbeTolerance)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool RenderProbe(FPreviewScene& Scene, const FVector& LookAt, float Distance, const FVector& ViewDir, TArray<FColor>& OutPixels)
+    {
+        UTextureRenderTarget2D* RT = RenderPreviewSceneFrame(Scene, LookAt, Distance, kDefaultFov, kGateProbeResolution, ViewDir, 0.0f);
+        if (!RT)
+        {
+            return false;
+        }
+        FlushRenderingCommands();
+        FTextureRenderTargetResource* Res = RT->GameThread_GetRenderTargetResource();
+        return Res && Res->ReadPixels(OutPixels);
+    }
+
+    static bool IsMaterialTimeDependent(UMaterialInterface* Mat);
+
+    // Subjects whose image changes from tick to tick never produce two matching
+    // probes: particles, animated skeletal meshes, ticking actors, and materials
+    // driven by time.
+    static bool IsSubjectTimeVarying(const TArray<UPrimitiveComponent*>& Subjects, const TArray<UMaterialInterface*>& Materials, ECaptureGateClass GateClass)
+    {
+        if (GateClass == ECaptureGateClass::Niagara)
+        {
+            return true;
+        }
+        for (UPrimitiveComponent* Comp : Subjects)
+        {
+            if (!Comp)
+            {
+                continue;
+            }
+            // Skinned meshes tick even in their reference pose; only an anim instance moves them.
+            const USkeletalMeshComponent* SKC = Cast<USkeletalMeshComponent>(Comp);
+            if (SKC ? SKC->GetAnimInstance() != nullptr : Comp->IsComponentTickEnabled())
+            {
+                return true;
+            }
+            const AActor* Owner = Comp->GetOwner();
+            if (Owner && Owner->IsActorTickEnabled())
+            {
+                return true;
+            }
+        }
+        for (UMaterialInterface* Mat : Materials)
+        {
+            if (Mat && IsMaterialTimeDependent(Mat))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Ticks the world until the subject is ready or the class limit is hit. Probes
+    // are skipped for subjects that never settle (see IsSubjectTimeVarying); those
+    // are ready once their textures and shaders are.
+    static bool WaitForCaptureReady(
+        FPreviewScene& Scene,
+        const TArray<UPrimitiveComponent*>& Subjects,
+        const FVector& LookAt,
+        float Distance,
+        const FVector& ViewDir,
+        ECaptureGateClass GateClass)
+    {
+        UWorld* World = Scene.GetWorld();
+        if (!World)
+        {
+            return false;
+        }
+
+        FScopedCaptureRig Rig;
+        TArray<UTexture*> Textures;
+        TArray<UMaterialInterface*> Materials;
+        for (UPrimitiveComponent* Comp : Subjects)
+        {
+            if (!Comp)
+            {
+                continue;
+            }
+            TArray<UTexture*> Used;
+            Comp->GetUsedTextures(Used, EMaterialQualityLevel::High);
+            for (UTexture* Tex : Used)
+            {
+                Textures.AddUnique(Tex);
+            }
+            TArray<UMaterialInterface*> UsedMaterials;
+            Comp->GetUsedMaterials(UsedMaterials);
+            for (UMaterialInterface* Mat : UsedMaterials)
+            {
+                Materials.AddUnique(Mat);
+            }
+        }
+
+#if WITH_EDITOR
+        FinishSubjectCompilation(Subjects, Textures);
+#endif
+
+        const bool bProbe = !IsSubjectTimeVarying(Subjects, Materials, GateClass);
+        const float LimitSeconds = GetCaptureGateLimitSeconds(GateClass);
+        const double StartSec = FPlatformTime::Seconds();
+        TArray<FColor> PrevProbe;
+        TArray<FColor> Probe;
+        int32 Probes = 0;
+        bool bReady = false;
+        while (true)
+        {
+#if WITH_EDITOR
+            ProcessFinishedCompilation();
+#endif
+            World->Tick(LEVELTICK_All, kGateTickSeconds);
+            IStreamingManager::Get().Tick(kGateTickSeconds);
+            FlushRenderingCommands();
+
+            if (AreTexturesReady(Textures) && AreShaderMapsReady(Materials, World->GetFeatureLevel()))
+            {
+                if (!bProbe)
+                {
+                    bReady = true;
+                    break;
+                }
+                if (RenderProbe(Scene, LookAt, Distance, ViewDir, Probe))
+                {
+                    ++Probes;
+                    if (ProbesMatch(PrevProbe, Probe))
+                    {
+                        bReady = true;
+                        break;
+                    }
+                    Swap(PrevProbe, Probe);
+                }
+            }
+            else
+            {
+                PrevProbe.Reset();
+            }
+
+            if (FPlatformTime::Seconds() - StartSec >= LimitSeconds)
+            {
+                break;
+            }
+            IdleWithPrefetch(0.01f);
+        }
+
+#if WITH_EDITOR
+        if (!bReady && !AreShaderMapsReady(Materials, World->GetFeatureLevel()))
+        {
+            // Rendering with fallback shaders would bake the default material into the preview.
+            FinishSubjectShaderMaps(Materials, World->GetFeatureLevel());
+        }
+#endif
+
+        const double Waited = FPlatformTime::Seconds() - StartSec;
+        GCaptureWaitSeconds += Waited;
+        GCaptureWaitTimedOut |= !bReady;
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Capture %s after %.2fs (%d texture(s), %d material(s), %s)"),
+            bReady ? TEXT("ready") : TEXT("ready TIMED OUT"), Waited, Textures.Num(), Materials.Num(),
+            bProbe ? *FString::Printf(TEXT("%d probe(s)"), Probes) : TEXT("time-varying, not probed"));
+        return bReady;
+    }
+
+    static bool WaitForCaptureReady(
+        FPreviewScene& Scene,
+        UPrimitiveComponent* Subject,
+        const FVector& LookAt,
+        float Distance,
+        const FVector& ViewDir,
+        ECaptureGateClass GateClass)
+    {
+        TArray<UPrimitiveComponent*> Subjects;
+        Subjects.Add(Subject);
+        return WaitForCaptureReady(Scene, Subjects, LookAt, Distance, ViewDir, GateClass);
+    }
+
+    static bool WaitForCaptureReady(
+        FPreviewScene& Scene,
+        AActor* Subject,
+        const FVector& LookAt,
+        float Distance,
+        const FVector& ViewDir,
+        ECaptureGateClass GateClass)
+    {
+        TArray<UPrimitiveComponent*> Subjects;
+        if (Subject)
+        {
+            Subject->GetComponents<UPrimitiveComponent>(Subjects);
+        }
+        return WaitForCaptureReady(Scene, Subjects, LookAt, Distance, ViewDir, GateClass);
+    }
+
+    // ============================================================================
+    // SHADER PRECOMPILE
+    // ============================================================================
+    // Materials of a batch are loaded up front and their shader maps submitted to
+    // the background compiler, so the ShaderCompileWorkers run at full width while
+    // other assets are captured. The batch then takes materials in completion
+    // order instead of stalling on each one in turn.
+    // ============================================================================
+    // Parent whose shaders a material instance reuses unchanged: only constant
+    // instances without static permutations (switches, base property overrides).
+    static UMaterialInterface* GetShaderSharingParent(UMaterialInterface* Mat)
+    {
+        const UMaterialInstanceConstant* MIC = Cast<UMaterialInstanceConstant>(Mat);
+        if (!MIC || MIC->bHasStaticPermutationResource)
+        {
+            return nullptr;
+        }
+        return MIC->Parent;
+    }
+
+    // Material whose shader maps Mat renders with: the top of its chain of
+    // shader-sharing parents (Mat itself when it compiles its own).
+    static UMaterialInterface* GetShaderSharingRoot(UMaterialInterface* Mat)
+    {
+        UMaterialInterface* Root = Mat;
+        for (int32 Depth = 0; Depth < 32; ++Depth)  // parent cycles are rejected on save, but stay bounded
+        {
+            UMaterialInterface* Parent = GetShaderSharingParent(Root);
+            if (!Parent)
+            {
+                break;
+            }
+            Root = Parent;
+        }
+        return Root;
+    }
+
+    struct FShaderPrecompile
+    {
+        TMap<int32, TStrongObjectPtr<UMaterialInterface>> Pending;  // by batch index
+        ERHIFeatureLevel::Type FeatureLevel = GMaxRHIFeatureLevel;
+        int32 Submitted = 0;
+        int32 Consumed = 0;
+
+        void Submit(int32 Index, UMaterialInterface* Mat)
+        {
+            // Loading usually starts the compile already; only (re)submit what is neither done nor in flight.
+            FMaterialResource* Res = Mat->GetMaterialResource(FeatureLevel);
+            if (!Res || (Res->IsCompilationFinished() && !Res->IsGameThreadShaderMapComplete()))
+            {
+                Mat->CacheShaders(EMaterialShaderPrecompileMode::Background);
+            }
+            Pending.Add(Index, TStrongObjectPtr<UMaterialInterface>(Mat));
+            ++Submitted;
+        }
+
+        bool IsPending(int32 Index) const
+        {
+            return Pending.Contains(Index);
+        }
+
+        bool IsReady(int32 Index) const
+        {
+            const TStrongObjectPtr<UMaterialInterface>* Mat = Pending.Find(Index);
+            TArray<UMaterialInterface*> Materials;
+            Materials.Add(Mat ? Mat->Get() : nullptr);
+            return AreShaderMapsReady(Materials, FeatureLevel);
+        }
+
+        // Lowest ready batch index of an instance rendering with the same shader maps
+        // as Instance, or INDEX_NONE. Direct siblings (same parent, so the capture's
+        // dynamic instance is reused) come before relatives further up the chain.
+        int32 FindReadySibling(UMaterialInterface* Instance) const
+        {
+            UMaterialInterface* Parent = GetShaderSharingParent(Instance);
+            if (!Parent)
+            {
+                return INDEX_NONE;
+            }
+            const UMaterialInterface* Root = GetShaderSharingRoot(Parent);
+            int32 Best = INDEX_NONE;
+            int32 BestRank = MAX_int32;
+            for (const TPair<int32, TStrongObjectPtr<UMaterialInterface>>& Pair : Pending)
+            {
+                UMaterialInterface* OtherParent = GetShaderSharingParent(Pair.Value.Get());
+                if (!OtherParent)
+                {
+                    continue;
+                }
+                const int32 Rank = OtherParent == Parent ? 0 : (GetShaderSharingRoot(OtherParent) == Root ? 1 : MAX_int32);
+                if (Rank == MAX_int32 || Rank > BestRank || (Rank == BestRank && Pair.Key > Best) || !IsReady(Pair.Key))
+                {
+                    continue;
+                }
+                Best = Pair.Key;
+                BestRank = Rank;
+            }
+            return Best;
+        }
+
+        // Lowest batch index whose shaders are complete, or INDEX_NONE.
+        int32 FindReady() const
+        {
+#if WITH_EDITOR
+            ProcessFinishedCompilation();
+#endif
+            int32 Best = INDEX_NONE;
+            for (const TPair<int32, TStrongObjectPtr<UMaterialInterface>>& Pair : Pending)
+            {
+                if ((Best == INDEX_NONE || Pair.Key < Best) && IsReady(Pair.Key))
+                {
+                    Best = Pair.Key;
+                }
+            }
+            return Best;
+        }
+
+        int32 FindFirstPending() const
+        {
+            int32 First = INDEX_NONE;
+            for (const TPair<int32, TStrongObjectPtr<UMaterialInterface>>& Pair : Pending)
+            {
+                First = (First == INDEX_NONE) ? Pair.Key : FMath::Min(First, Pair.Key);
+            }
+            return First;
+        }
+
+        void Release(int32 Index)
+        {
+            if (Pending.Remove(Index) > 0)
+            {
+                ++Consumed;
+            }
+        }
+
+        void LogProgress() const
+        {
+            int32 Ready = 0;
+            for (const TPair<int32, TStrongObjectPtr<UMaterialInterface>>& Pair : Pending)
+            {
+                Ready += IsReady(Pair.Key) ? 1 : 0;
+            }
+            const int32 Remaining = GShaderCompilingManager ? GShaderCompilingManager->GetNumRemainingJobs() : 0;
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Shader precompile: %d of %d material(s) captured, %d waiting with shaders ready, %d shader job(s) remaining"),
+                Consumed, Submitted, Ready, Remaining);
+        }
+    };
+
+    // ============================================================================
+    // PIPELINED READBACK
+    // ============================================================================
+    // Multi-frame captures submit frame N+1 while frame N is copied back and
+    // encoded: each frame renders into its own ring slot, the GPU copy goes to an
+    // FRHIGPUTextureReadback, and only once the copy reports ready is it mapped
+    // on the render thread; the game thread only waits for a slot when it needs
+    // to reuse it (or at Flush).
+    // ============================================================================
+    static const int32 kReadbackRingSize = 3;
+    static const double kReadbackReadyTimeoutSeconds = 1.0;
+
+    struct FReadbackSlot
+    {
+        TUniquePtr<FRHIGPUTextureReadback> Readback;
+        FPixelBuffer Pixels = GPixelBufferPool.Acquire();
+        FRenderCommandFence Fence;
+        int32 Resolution = 0;
+        int32 Step = 0;
+        bool bPending = false;
+    };
+
+    class FPipelinedFrameCapture
+    {
+    public:
+        // bSkipDuplicates: turntables drop frames identical to the previous one (see ShouldStop);
+        // animations keep every sample so frame times stay evenly spaced.
+        explicit FPipelinedFrameCapture(TArray<FZipEntry>& InOutFrames, bool bInSkipDuplicates = false)
+            : OutFrames(InOutFrames)
+            , bSkipDuplicates(bInSkipDuplicates)
+        {
+            const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+            bPipelined = !Settings || Settings->bPipelinedReadback;
+            EncodeOptions = GetWebPEncodeOptions();
+            bKeepPixels = ShouldKeepFramePixels();
+        }
+
+        ~FPipelinedFrameCapture()
+        {
+            Flush();
+            for (FReadbackSlot& Slot : Slots)
+            {
+                GPixelBufferPool.Release(Slot.Pixels);
+            }
+        }
+
+        void Submit(
+            FPreviewScene& Scene,
+            const FVector& LookAt,
+            float Distance,
+            float FovDeg,
+            int32 Resolution,
+            const FVector& ViewDirFromLookAt,
+            float YawRotationDegrees = 0.0f)
+        {
+            if (!bPipelined)
+            {
+                UTextureRenderTarget2D* RT = RenderPreviewSceneFrame(Scene, LookAt, Distance, FovDeg, Resolution, ViewDirFromLookAt, YawRotationDegrees);
+                FTextureRenderTargetResource* Res = RT ? RT->GameThread_GetRenderTargetResource() : nullptr;
+                if (!Res)
+                {
+                    return;
+                }
+                FPixelBuffer Pixels = GPixelBufferPool.Acquire();
+                FReadSurfaceDataFlags Flags(RCM_UNorm);
+                Flags.SetLinearToGamma(true);
+                const int32 Step = Submitted++;
+                if (Res->ReadPixels(*Pixels, Flags) && Pixels->Num() == Resolution * Resolution
+                    && !(bSkipDuplicates && Duplicates.IsDuplicate(*Pixels, Resolution)))
+                {
+                    AddFrame(Pixels, Resolution, Step);
+                }
+                else
+                {
+                    GPixelBufferPool.Release(Pixels);
+                }
+                return;
+            }
+
+            RetireFinished();
+            const int32 SlotIndex = Submitted % kReadbackRingSize;
+            FReadbackSlot& Slot = Slots[SlotIndex];
+            if (Slot.bPending)
+            {
+                Complete(Slot);
+            }
+
+            UTextureRenderTarget2D* RT = RenderPreviewSceneFrame(Scene, LookAt, Distance, FovDeg, Resolution, ViewDirFromLookAt, YawRotationDegrees, SlotIndex);
+            FTextureRenderTargetResource* Res = RT ? RT->GameThread_GetRenderTargetResource() : nullptr;
+            if (!Res)
+            {
+                return;
+            }
+            if (!Slot.Readback.IsValid())
+            {
+                Slot.Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("AssetSnapshotFrameReadback"));
+            }
+
+            // Only the GPU copy is queued here, right behind the capture; Complete maps it once
+            // it has landed, so the game thread keeps ticking the next frame meanwhile.
+            FRHIGPUTextureReadback* Readback = Slot.Readback.Get();
+            ENQUEUE_RENDER_COMMAND(AssetSnapshotReadbackCopy)(
+                [Readback, Res](FRHICommandListImmediate& RHICmdList)
+                {
+                    Readback->EnqueueCopy(RHICmdList, Res->GetRenderTargetTexture());
+                });
+            Slot.Fence.BeginFence();
+            Slot.Resolution = Resolution;
+            Slot.Step = Submitted;
+            Slot.bPending = true;
+            Order.Add(SlotIndex);
+            ++Submitted;
+        }
+
+        // Enough identical frames in a row were seen; further turntable views would repeat them.
+        // Frames whose copy already landed are checked first, so this trails Submit by the
+        // frames still on the GPU rather than by the whole ring.
+        bool ShouldStop()
+        {
+            if (bSkipDuplicates && bPipelined)
+            {
+                RetireFinished();
+            }
+            return bSkipDuplicates && Duplicates.ShouldStop();
+        }
+
+        // Waits for every readback still in flight, in submission order; encodes may still be running.
+        void Flush()
+        {
+            for (const int32 SlotIndex : TArray<int32>(Order))
+            {
+                if (Slots[SlotIndex].bPending)
+                {
+                    Complete(Slots[SlotIndex]);
+                }
+            }
+            Order.Reset();
+        }
+
+    private:
+        // Completes the oldest slots whose copy is done, without waiting for any other.
+        void RetireFinished()
+        {
+            while (Order.Num() > 0)
+            {
+                FReadbackSlot& Oldest = Slots[Order[0]];
+                if (!Oldest.Fence.IsFenceComplete() || !Oldest.Readback->IsReady())
+                {
+                    break;
+                }
+                Complete(Oldest);
+            }
+        }
+
+        void Complete(FReadbackSlot& Slot)
+        {
+            // Past the fence the copy is queued; the GPU may still be writing it.
+            Slot.Fence.Wait();
+            const double ReadyStartSec = FPlatformTime::Seconds();
+            while (!Slot.Readback->IsReady() && FPlatformTime::Seconds() - ReadyStartSec < kReadbackReadyTimeoutSeconds)
+            {
+                FPlatformProcess::Sleep(0.001f);
+            }
+
+            // Map in a second command; Lock only blocks there if the copy was still not ready.
+            FRHIGPUTextureReadback* Readback = Slot.Readback.Get();
+            FPixelBuffer Pixels = Slot.Pixels;
+            const int32 Resolution = Slot.Resolution;
+            ENQUEUE_RENDER_COMMAND(AssetSnapshotReadbackMap)(
+                [Readback, Pixels, Resolution](FRHICommandListImmediate& RHICmdList)
+                {
+                    int32 RowPitchInPixels = 0;
+                    const FColor* Src = static_cast<const FColor*>(Readback->Lock(RowPitchInPixels));
+                    if (!Src || RowPitchInPixels < Resolution)
+                    {
+                        Pixels->Reset();
+                        Readback->Unlock();
+                        return;
+                    }
+                    Pixels->SetNumUninitialized(Resolution * Resolution, EAllowShrinking::No);
+                    for (int32 Row = 0; Row < Resolution; ++Row)
+                    {
+                        FMemory::Memcpy(Pixels->GetData() + Row * Resolution, Src + Row * RowPitchInPixels, Resolution * sizeof(FColor));
+                    }
+                    Readback->Unlock();
+                });
+            Slot.Fence.BeginFence();
+            Slot.Fence.Wait();
+            Slot.bPending = false;
+            Order.RemoveAt(0);
+
+            // The filled buffer goes to the encoder; the slot reads the next frame into a fresh one.
+            if (Slot.Pixels->Num() == Slot.Resolution * Slot.Resolution
+                && !(bSkipDuplicates && Duplicates.IsDuplicate(*Slot.Pixels, Slot.Resolution)))
+            {
+                AddFrame(Slot.Pixels, Slot.Resolution, Slot.Step);
+                Slot.Pixels = GPixelBufferPool.Acquire();
+            }
+        }
+
+        void AddFrame(const FPixelBuffer& Pixels, int32 Resolution, int32 Step)
+        {
+            FZipEntry Frame;
+            Frame.NameInZip = FString::Printf(TEXT("%d.webp"), OutFrames.Num());
+            Frame.CropRect = ComputeCropRect(*Pixels, Resolution);
+            Frame.CaptureStep = Step;
+            if (NeedsStillEncode(OutFrames.Num()))
+            {
+                Frame.PendingData = LaunchWebPEncode(Pixels, Resolution, Resolution, EncodeOptions, Frame.CropRect);
+            }
+            if (bKeepPixels)
+            {
+                Frame.SourcePixels = Pixels;
+                Frame.SourceResolution = Resolution;
+            }
+            OutFrames.Add(MoveTemp(Frame));
+        }
+
+        TArray<FZipEntry>& OutFrames;
+        FScopedCaptureRig Rig;
+        FReadbackSlot Slots[kReadbackRingSize];
+        TArray<int32> Order;
+        FWebPEncodeOptions EncodeOptions;
+        FDuplicateFrameFilter Duplicates;
+        int32 Submitted = 0;
+        bool bPipelined = true;
+        bool bKeepPixels = false;
+        bool bSkipDuplicates = false;
+    };
+
+    static bool CaptureStaticMeshMultiFrame(UStaticMesh* SM, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance)
+    {
+        if (!SM)
+        {
+            return false;
+        }
+
+        FScopedCaptureStage Stage(ECaptureStageKind::StaticMesh);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
+        Comp->SetStaticMesh(SM);
+        Comp->SetMobility(EComponentMobility::Movable);
+        Comp->RegisterComponentWithWorld(World);
+        Comp->SetForcedLodModel(1);
+
+        Stage->AddSubject(Comp);
+        Comp->UpdateBounds();
+
+        const FVector CenterOffset = -Comp->Bounds.Origin;
+        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();
+        Comp->SetWorldLocation(CenterOffset);
+        
+        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
+        BaseRotation.Yaw += 90.f;  // 90° rotation
+        Comp->SetWorldRotation(BaseRotation);
+        Comp->UpdateBounds();
+
+        // Ensure textures are resident before capture (prevents low-mip blur on first pass).
+        ForceComponentTexturesResident(Comp);
+
+        const float Radius = Comp->Bounds.SphereRadius;
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, kDistancePadding);
+
+        OutFrames.Reset();
+        const int32 FramesToKeep = GetStaticMeshFrameCount();
+        const int32 FramesToDiscard = GetCapture360DiscardCount();
+        const int32 FramesTotal = FramesToKeep + FramesToDiscard;
+        OutFrames.Reserve(FramesToKeep);
+        FPipelinedFrameCapture Pipeline(OutFrames, true);
+
+        // Wait until textures/shaders of this mesh are ready (bounded).
+        WaitForCaptureReady(Scene, Comp, Comp->Bounds.Origin, OutDistance, ViewDir, ECaptureGateClass::Mesh);
+
+        // Now capture frames (skip first 3, keep rest)
+        for (int32 i = 0; i < FramesTotal; ++i)
+        {
+            if (i > 0)
+            {
+                World->Tick(LEVELTICK_All, kCapture360FrameInterval);
+                FlushRenderingCommands();
+            }
+
+            // 360° camera rotation
+            float CameraYaw = 0.0f;
+            if (i >= FramesToDiscard)
+            {
+                const int32 FrameIndex = i - FramesToDiscard;
+                CameraYaw = (360.0f / (float)FramesToKeep) * FrameIndex;
+            }
+
+            if (i < FramesToDiscard)
+            {
+                WarmupPreviewSceneFrame(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, ViewDir, CameraYaw);
+                continue;
+            }
+
+            Pipeline.Submit(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, ViewDir, CameraYaw);
+            if (Pipeline.ShouldStop())
+            {
+                break;
+            }
+        }
+
+        Pipeline.Flush();
+        return OutFrames.Num() > 0;
+    }
+
+    static bool CaptureStaticMesh(UStaticMesh* SM, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
+    {
+        // Legacy single-frame wrapper for backward compatibility
+        TArray<FZipEntry> Frames;
+        if (!CaptureStaticMeshMultiFrame(SM, Resolution, Frames, OutDistance))
+        {
+            return false;
+        }
+        ResolveZipEntries(Frames);
+        if (Frames.Num() > 0 && Frames[0].Data.Num() > 0)
+        {
+            OutWebP = MoveTemp(Frames[0].Data);  // Return first frame
+            return true;
+        }
+        return false;
+    }
+
+    static bool CaptureSkeletalMesh(USkeletalMesh* SK, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
+    {
+        if (!SK)
+        {
+            return false;
+        }
+
+        FScopedCaptureStage Stage(ECaptureStageKind::SkeletalMesh);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        USkeletalMeshComponent* Comp = NewObject<USkeletalMeshComponent>(GetTransientPackage());
+        Comp->SetSkeletalMesh(SK);
+        Comp->SetMobility(EComponentMobility::Movable);
+        Comp->RegisterComponentWithWorld(World);
+        Comp->SetForcedLOD(1);
+
+        Stage->AddSubject(Comp);
+        Comp->UpdateBounds();
+
+        const FVector CenterOffset = -Comp->Bounds.Origin;
+        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();  // Y-axis
+        Comp->SetWorldLocation(CenterOffset);
+        
+        // Rotate mesh: base rotation + 90° around Z-axis
+        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
+        BaseRotation.Yaw += 90.f;  // Add 90° rotation towards camera
+        Comp->SetWorldRotation(BaseRotation);
+        Comp->UpdateBounds();
+
+        // Ensure textures are resident before capture (prevents silver previews while streaming is pending).
+        ForceComponentTexturesResident(Comp);
+
+        const float Radius = Comp->Bounds.SphereRadius;
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, kDistancePadding);
+        WaitForCaptureReady(Scene, Comp, Comp->Bounds.Origin, OutDistance, ViewDir, ECaptureGateClass::Mesh);
+        return CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir);
+    }
+
+    static bool CaptureSkeletalMeshMultiFrame(USkeletalMesh* SK, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance)
+    {
+        if (!SK)
+        {
+            return false;
+        }
+
+        FScopedCaptureStage Stage(ECaptureStageKind::SkeletalMesh);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        USkeletalMeshComponent* Comp = NewObject<USkeletalMeshComponent>(GetTransientPackage());
+        Comp->SetSkeletalMesh(SK);
+        Comp->SetMobility(EComponentMobility::Movable);
+        Comp->RegisterComponentWithWorld(World);
+        Comp->SetForcedLOD(1);
+
+        Stage->AddSubject(Comp);
+        Comp->UpdateBounds();
+
+        const FVector CenterOffset = -Comp->Bounds.Origin;
+        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();
+        Comp->SetWorldLocation(CenterOffset);
+        
+        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
+        BaseRotation.Yaw += 90.f;  // 90° rotation
+        Comp->SetWorldRotation(BaseRotation);
+        Comp->UpdateBounds();
+
+        // Ensure textures are resident before capture (prevents low-mip blur on first pass).
+        ForceComponentTexturesResident(Comp);
+
+        const float Radius = Comp->Bounds.SphereRadius;
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, kDistancePadding);
+
+        OutFrames.Reset();
+        const int32 FramesToKeep = GetSkeletalMeshFrameCount();
+        const int32 FramesToDiscard = GetCapture360DiscardCount();
+        const int32 FramesTotal = FramesToKeep + FramesToDiscard;
+        OutFrames.Reserve(FramesToKeep);
+        FPipelinedFrameCapture Pipeline(OutFrames, true);
+
+        // Wait until textures/shaders of this mesh are ready (bounded).
+        WaitForCaptureReady(Scene, Comp, Comp->Bounds.Origin, OutDistance, ViewDir, ECaptureGateClass::Mesh);
+
+        // Now capture frames (skip first 3, keep rest)
+        for (int32 i = 0; i < FramesTotal; ++i)
+        {
+            if (i > 0)
+            {
+                World->Tick(LEVELTICK_All, kCapture360FrameInterval);
+                FlushRenderingCommands();
+            }
+
+            // 360° camera rotation
+            float CameraYaw = 0.0f;
+            if (i >= FramesToDiscard)
+            {
+                const int32 FrameIndex = i - FramesToDiscard;
+                CameraYaw = (360.0f / (float)FramesToKeep) * FrameIndex;
+            }
+
+            if (i < FramesToDiscard)
+            {
+                WarmupPreviewSceneFrame(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, ViewDir, CameraYaw);
+                continue;
+            }
+
+            Pipeline.Submit(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, ViewDir, CameraYaw);
+            if (Pipeline.ShouldStop())
+            {
+                break;
+            }
+        }
+
+        Pipeline.Flush();
+        return OutFrames.Num() > 0;
+    }
+
+    // Streaming-only wait before one frame is retaken: ticks until the component's
+    // own textures are resident, without the probe renders of the full gate.
+    static const float kFrameRetryStreamingSeconds = 2.0f;
+
+    static void WaitForComponentTextures(UWorld* World, UPrimitiveComponent* Comp, float LimitSeconds)
+    {
+        if (!World || !Comp)
+        {
+            return;
+        }
+        TArray<UTexture*> Textures;
+        Comp->GetUsedTextures(Textures, EMaterialQualityLevel::High);
+        ForceComponentTexturesResident(Comp);
+
+        const double StartSec = FPlatformTime::Seconds();
+        while (!AreTexturesReady(Textures) && FPlatformTime::Seconds() - StartSec < LimitSeconds)
+        {
+#if WITH_EDITOR
+            ProcessFinishedCompilation();
+#endif
+            World->Tick(LEVELTICK_All, kGateTickSeconds);
+            IStreamingManager::Get().Tick(kGateTickSeconds);
+            FlushRenderingCommands();
+            IdleWithPrefetch(0.01f);
+        }
+        GCaptureWaitSeconds += FPlatformTime::Seconds() - StartSec;
+    }
+
+    enum class EMaterialFrameResult : uint8
+    {
+        Captured,
+        Duplicate,
+        Failed
+    };
+
+    // Appends a kept material frame and starts its encode (the poster's only, when packing).
+    static void AddMaterialFrame(const FPixelBuffer& Pixels, int32 Resolution, int32 Step, const FFrameStats& Stats, TArray<FZipEntry>& Frames)
+    {
+        const bool bStill = NeedsStillEncode(Frames.Num());
+        FZipEntry& Frame = Frames.AddDefaulted_GetRef();
+        Frame.NameInZip = FString::Printf(TEXT("%d.webp"), Frames.Num() - 1);
+        Frame.CaptureStep = Step;
+        if (ShouldKeepFramePixels())
+        {
+            Frame.SourcePixels = Pixels;
+            Frame.SourceResolution = Resolution;
+        }
+        Frame.CropRect = ComputeCropRect(*Pixels, Resolution);
+        if (bStill)
+        {
+            Frame.PendingData = LaunchWebPEncode(Pixels, Resolution, Resolution, GetWebPEncodeOptions(EWebPContent::MaterialSwatch), Frame.CropRect);
+        }
+        GCaptureFrameStats.Add(MakeShared<FJsonValueObject>(Stats.ToJson()));
+    }
+
+    // One material frame: read back, judge from pixel statistics (retaking just this
+    // frame after a streaming wait when it fails), drop duplicates, then encode async.
+    static EMaterialFrameResult CaptureMaterialFrame(
+        FPreviewScene& Scene,
+        UPrimitiveComponent* Comp,
+        UMaterialInterface* Mat,
+        float Distance,
+        const FVector& ViewDir,
+        int32 Resolution,
+        int32 FrameIndex,
+        FDuplicateFrameFilter& Duplicates,
+        TArray<FZipEntry>& Frames,
+        FFrameStats& OutStats)
+    {
+        FPixelBuffer Pixels = GPixelBufferPool.Acquire();
+        const FVector LookAt = Comp->Bounds.Origin;
+        if (!ReadPreviewSceneFrame(Scene, LookAt, Distance, kDefaultFov, Resolution, ViewDir, 0.0f, *Pixels))
+        {
+            GPixelBufferPool.Release(Pixels);
+            return EMaterialFrameResult::Failed;
+        }
+        OutStats = AnalyzeFrame(*Pixels);
+        bool bRetried = false;
+        if (OutStats.IsLowQuality())
+        {
+            bRetried = true;
+            WaitForComponentTextures(Scene.GetWorld(), Comp, kFrameRetryStreamingSeconds);
+            if (!ReadPreviewSceneFrame(Scene, LookAt, Distance, kDefaultFov, Resolution, ViewDir, 0.0f, *Pixels))
+            {
+                GPixelBufferPool.Release(Pixels);
+                return EMaterialFrameResult::Failed;
+            }
+            OutStats = AnalyzeFrame(*Pixels);
+        }
+
+        UE_LOG(
+            LogAssetSnapshot,
+            Log,
+            TEXT("Material capture %s frame %d: luma %.1f (variance %.1f), %.1f%% background%s%s"),
+            Mat ? *Mat->GetName() : TEXT("<null>"),
+            FrameIndex,
+            OutStats.LumaMean,
+            OutStats.LumaVariance,
+            OutStats.BackgroundFraction * 100.0f,
+            bRetried ? TEXT(", retaken") : TEXT(""),
+            OutStats.IsLowQuality() ? TEXT(" (low quality)") : TEXT(""));
+
+        if (Duplicates.IsDuplicate(*Pixels, Resolution))
+        {
+            GPixelBufferPool.Release(Pixels);
+            return EMaterialFrameResult::Duplicate;
+        }
+
+        AddMaterialFrame(Pixels, Resolution, FrameIndex, OutStats, Frames);
+        return EMaterialFrameResult::Captured;
+    }
+
+    // ============================================================================
+    // MATERIAL ANIMATION ANALYSIS
+    // ============================================================================
+    // A material only needs several frames when its output changes over time.
+    // The base material graph (and every function it calls) is scanned once per
+    // batch for time-driven expressions (Time, Panner, Rotator, the Flipbook
+    // function's Time node) and dynamic parameters; static materials get a single
+    // frame. Custom HLSL and material layers cannot be inspected (instances may
+    // swap the layer functions), so they count as time-driven.
+    // ============================================================================
+#if WITH_EDITOR
+    static TMap<FObjectKey, bool> GMaterialTimeDependenceCache;
+
+    static bool AreExpressionsTimeDependent(TConstArrayView<TObjectPtr<UMaterialExpression>> Expressions, TSet<const UObject*>& Visited)
+    {
+        for (const TObjectPtr<UMaterialExpression>& Expression : Expressions)
+        {
+            if (!Expression)
+            {
+                continue;
+            }
+            if (Expression->IsA<UMaterialExpressionTime>() || Expression->IsA<UMaterialExpressionPanner>()
+                || Expression->IsA<UMaterialExpressionRotator>() || Expression->IsA<UMaterialExpressionDynamicParameter>()
+                || Expression->IsA<UMaterialExpressionCustom>() || Expression->IsA<UMaterialExpressionMaterialAttributeLayers>())
+            {
+                return true;
+            }
+            const UMaterialExpressionMaterialFunctionCall* Call = Cast<UMaterialExpressionMaterialFunctionCall>(Expression);
+            UMaterialFunctionInterface* Function = (Call && Call->MaterialFunction) ? Call->MaterialFunction->GetBaseFunction() : nullptr;
+            bool bAlreadyVisited = false;
+            if (Function)
+            {
+                Visited.Add(Function, &bAlreadyVisited);
+            }
+            if (Function && !bAlreadyVisited && AreExpressionsTimeDependent(Function->GetExpressions(), Visited))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+#endif
+
+    static bool IsMaterialTimeDependent(UMaterialInterface* Mat)
+    {
+#if WITH_EDITOR
+        UMaterial* Base = Mat ? Mat->GetMaterial() : nullptr;
+        if (!Base)
+        {
+            return true;
+        }
+        if (const bool* Cached = GMaterialTimeDependenceCache.Find(FObjectKey(Base)))
+        {
+            return *Cached;
+        }
+        TSet<const UObject*> Visited;
+        const bool bTimeDependent = AreExpressionsTimeDependent(Base->GetExpressions(), Visited);
+        GMaterialTimeDependenceCache.Add(FObjectKey(Base), bTimeDependent);
+        return bTimeDependent;
+#else
+        // Graphs are editor-only data; keep the full frame count.
+        return true;
+#endif
+    }
+
+    // Graphs may have been edited since the last batch.
+    static void ResetMaterialTimeDependenceCache()
+    {
+#if WITH_EDITOR
+        GMaterialTimeDependenceCache.Reset();
+#endif
+    }
+
+    static int32 GetMaterialCaptureFrameCount(UMaterialInterface* Mat)
+    {
+        return IsMaterialTimeDependent(Mat) ? GetMaterialFrameCount() : 1;
+    }
+
+    // ============================================================================
+    // MATERIAL ATLAS
+    // ============================================================================
+    // Batches stage up to K x K static materials at once in the shared material
+    // scene: one sphere per material on a grid, same lights. Only the readiness
+    // wait is shared; each cell is still its own scene capture, taken with the
+    // lone capture's perspective camera moved over its sphere, so framing and
+    // viewing angle are those of a capture of its own. The grid spacing keeps
+    // neighbours out of every frustum, and spheres only shadow themselves, as
+    // the lone sphere does. Cells are kept until their material comes up in the
+    // batch; cells that look blank or low quality are dropped and captured alone
+    // instead. The first atlas of a batch is checked against a lone capture of
+    // its first material; on a mismatch that atlas is discarded and atlasing is
+    // off for the rest of the batch.
+    // ============================================================================
+    static const float kMaterialAtlasSpacing = 1.5f;            // cell pitch, in lone frame widths
+    static const float kMaterialAtlasMaxMeanDifference = 4.0f;  // per channel, 8-bit
+
+    struct FMaterialAtlasCell
+    {
+        FPixelBuffer Pixels = GPixelBufferPool.Acquire();
+        FFrameStats Stats;
+        int32 Resolution = 0;
+        int32 Grid = 0;
+    };
+
+    static TMap<FObjectKey, FMaterialAtlasCell> GMaterialAtlasCells;
+
+    // Grid size the exported material was rendered in (reset in ExportPlannedAsset); 0 = alone.
+    static int32 GCaptureAtlasGrid = 0;
+
+    // Materials per atlas capture (< 2 = atlas off).
+    static int32 GetMaterialAtlasCapacity(const FMaterialCaptureContext& Ctx, int32 Resolution)
+    {
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        const int32 Grid = Resolution > 0 && Settings && !Ctx.bAtlasDisabled ? Settings->MaterialAtlasGridSize : 1;
+        return Grid > 1 ? Grid * Grid : 1;
+    }
+
+    static bool HasMaterialAtlasFrame(UMaterialInterface* Mat)
+    {
+        return Mat && GMaterialAtlasCells.Contains(FObjectKey(Mat));
+    }
+
+    // Renders Mat alone on the shared sphere and logs how far its atlas cell is off.
+    // False when the cell cannot stand in for a lone capture.
+    static bool VerifyMaterialAtlasCell(FMaterialCaptureContext& Ctx, UMaterialInterface* Mat, const TArray<FColor>& CellPixels, int32 Resolution)
+    {
+        UMaterialInterface* Previous = Ctx.Comp->GetMaterial(0);
+        Ctx.Comp->SetMaterial(0, Mat);
+        Ctx.Comp->MarkRenderStateDirty();
+        TArray<FColor> Lone;
+        const bool bRead = ReadPreviewSceneFrame(Ctx.Scene, Ctx.Comp->Bounds.Origin, Ctx.Distance, kDefaultFov, Resolution, Ctx.ViewDir, 0.0f, Lone);
+        Ctx.Comp->SetMaterial(0, Previous);
+        Ctx.Comp->MarkRenderStateDirty();
+        if (!bRead || Lone.Num() != CellPixels.Num())
+        {
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Material atlas check: lone capture of %s failed"), *Mat->GetName());
+            return false;
+        }
+
+        uint64 Sum = 0;
+        for (int32 p = 0; p < Lone.Num(); ++p)
+        {
+            Sum += FMath::Abs(Lone[p].R - CellPixels[p].R) + FMath::Abs(Lone[p].G - CellPixels[p].G) + FMath::Abs(Lone[p].B - CellPixels[p].B);
+        }
+        const float MeanDifference = (float)((double)Sum / (3.0 * Lone.Num()));
+        const bool bMatches = MeanDifference <= kMaterialAtlasMaxMeanDifference;
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Material atlas check: cell of %s differs from its lone capture by %.2f per channel on average%s"),
+            *Mat->GetName(), MeanDifference, bMatches ? TEXT("") : TEXT(" (MISMATCH)"));
+        return bMatches;
+    }
+
+    static bool CaptureMaterialAtlas(FMaterialCaptureContext& Ctx, const TArray<UMaterialInterface*>& Materials, int32 Resolution)
+    {
+        const int32 Grid = FMath::CeilToInt(FMath::Sqrt((float)Materials.Num()));
+        if (!Ctx.World || !Ctx.Comp || Materials.Num() < 2)
+        {
+            return false;
+        }
+
+        const double StartSec = FPlatformTime::Seconds();
+        const FTransform BaseTransform = Ctx.Comp->GetComponentTransform();
+        const FVector Center = Ctx.Comp->Bounds.Origin;
+        const float CellWorld = 2.0f * Ctx.Distance * FMath::Tan(FMath::DegreesToRadians(kDefaultFov * 0.5f)) * kMaterialAtlasSpacing;
+        while (Ctx.AtlasComps.Num() < Materials.Num())
+        {
+            UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
+            Comp->SetStaticMesh(Ctx.Comp->GetStaticMesh());
+            Comp->SetMobility(EComponentMobility::Movable);
+            // Neighbours must not shadow each other; a lone sphere only shadows itself.
+            Comp->bSelfShadowOnly = true;
+            Comp->SetVisibility(false);
+            Ctx.Scene.AddComponent(Comp, BaseTransform);
+            Ctx.AtlasComps.Add(Comp);
+        }
+
+        // Looking back along ViewDir (+X), screen right is -Y and screen down is -Z.
+        TArray<UPrimitiveComponent*> Subjects;
+        TArray<FVector> CellCenters;
+        for (int32 k = 0; k < Materials.Num(); ++k)
+        {
+            const float Col = (float)(k % Grid) - (Grid - 1) * 0.5f;
+            const float Row = (float)(k / Grid) - (Grid - 1) * 0.5f;
+            const FVector Offset(0.f, -Col * CellWorld, -Row * CellWorld);
+            FTransform CellTransform = BaseTransform;
+            CellTransform.SetLocation(BaseTransform.GetLocation() + Offset);
+            CellCenters.Add(Center + Offset);
+
+            UStaticMeshComponent* Comp = Ctx.AtlasComps[k];
+            Comp->SetWorldTransform(CellTransform);
+            Comp->SetMaterial(0, Materials[k]);
+            Comp->SetVisibility(true);
+            Comp->MarkRenderStateDirty();
+            ForceComponentTexturesResident(Comp);
+            Subjects.Add(Comp);
+        }
+        Ctx.Comp->SetVisibility(false);
+
+        WaitForCaptureReady(Ctx.Scene, Subjects, Center, Ctx.Distance * Grid * kMaterialAtlasSpacing, Ctx.ViewDir, ECaptureGateClass::Material);
+
+        TArray<FMaterialAtlasCell> Cells;
+        Cells.Reserve(Materials.Num());
+        for (int32 k = 0; k < Materials.Num(); ++k)
+        {
+            // A failed read leaves Resolution at 0 and the cell is dropped below.
+            FMaterialAtlasCell& Cell = Cells.AddDefaulted_GetRef();
+            if (ReadPreviewSceneFrame(Ctx.Scene, CellCenters[k], Ctx.Distance, kDefaultFov, Resolution, Ctx.ViewDir, 0.0f, *Cell.Pixels))
+            {
+                Cell.Stats = AnalyzeFrame(*Cell.Pixels);
+                Cell.Resolution = Resolution;
+                Cell.Grid = Grid;
+            }
+        }
+
+        for (UStaticMeshComponent* Comp : Ctx.AtlasComps)
+        {
+            Comp->SetMaterial(0, nullptr);
+            Comp->SetVisibility(false);
+        }
+        Ctx.Comp->SetVisibility(true);
+
+        if (!Ctx.bAtlasVerified && Cells[0].Resolution == Resolution)
+        {
+            Ctx.bAtlasVerified = true;
+            if (!VerifyMaterialAtlasCell(Ctx, Materials[0], *Cells[0].Pixels, Resolution))
+            {
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Material atlas cells do not match lone captures; atlas discarded and disabled for this batch"));
+                Ctx.bAtlasDisabled = true;
+                for (FMaterialAtlasCell& Cell : Cells)
+                {
+                    GPixelBufferPool.Release(Cell.Pixels);
+                }
+                return false;
+            }
+        }
+
+        int32 Kept = 0;
+        for (int32 k = 0; k < Materials.Num(); ++k)
+        {
+            FMaterialAtlasCell& Cell = Cells[k];
+            if (Cell.Resolution != Resolution || Cell.Stats.IsLowQuality())
+            {
+                GPixelBufferPool.Release(Cell.Pixels);
+                continue;
+            }
+            GMaterialAtlasCells.Add(FObjectKey(Materials[k]), MoveTemp(Cell));
+            ++Kept;
+        }
+
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Material atlas: %d of %d material(s) captured (one capture each, one shared %dx%d readiness wait) in %.2fs"),
+            Kept, Materials.Num(), Grid, Grid, FPlatformTime::Seconds() - StartSec);
+        return Kept > 0;
+    }
+
+    // Takes the material's atlas cell, if one was rendered, as its only frame.
+    static bool TakeMaterialAtlasFrame(UMaterialInterface* Mat, int32 Resolution, TArray<FZipEntry>& Frames, FFrameStats& OutStats)
+    {
+        const FMaterialAtlasCell* Found = Mat ? GMaterialAtlasCells.Find(FObjectKey(Mat)) : nullptr;
+        if (!Found)
+        {
+            return false;
+        }
+        const FMaterialAtlasCell Cell = *Found;
+        GMaterialAtlasCells.Remove(FObjectKey(Mat));
+        if (Cell.Resolution != Resolution || IsMaterialTimeDependent(Mat))
+        {
+            GPixelBufferPool.Release(Cell.Pixels);
+            return false;
+        }
+        OutStats = Cell.Stats;
+        GCaptureAtlasGrid = Cell.Grid;
+        AddMaterialFrame(Cell.Pixels, Resolution, 0, OutStats, Frames);
+        return true;
+    }
+
+    // Exported material instance was captured through the shared dynamic instance (reset in ExportPlannedAsset).
+    static bool GCaptureViaDynamicInstance = false;
+
+    static bool CaptureMaterialOnSharedSphereMultiFrame(
+        FMaterialCaptureContext& Ctx,
+        UMaterialInterface* Mat,
+        int32 Resolution,
+        TArray<FZipEntry>& OutFrames,
+        float& OutDistance,
+        bool& OutLowQuality)
+    {
+        OutLowQuality = false;
+        if (!Mat || !Ctx.Comp || !Ctx.World)
+        {
+            return false;
+        }
+
+        OutDistance = Ctx.Distance;
+        OutFrames.Reset();
+        FFrameStats AtlasStats;
+        if (TakeMaterialAtlasFrame(Mat, Resolution, OutFrames, AtlasStats))
+        {
+            return true;
+        }
+
+        // Instances of the parent already on the sphere only swap parameters on the
+        // shared dynamic instance: shaders and warmup are the parent's, so only this
+        // instance's textures are waited for.
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        UMaterialInstanceConstant* MIC = Cast<UMaterialInstanceConstant>(Mat);
+        UMaterialInterface* Parent = GetShaderSharingParent(Mat);
+        bool bSameParent = false;
+        if (Parent && Settings && Settings->bMaterialInstanceFastPath)
+        {
+            bSameParent = Ctx.InstanceMid.IsValid() && Ctx.InstanceMid->Parent == Parent && Ctx.Comp->GetMaterial(0) == Ctx.InstanceMid.Get();
+            if (!Ctx.InstanceMid.IsValid() || Ctx.InstanceMid->Parent != Parent)
+            {
+                Ctx.InstanceMid.Reset(UMaterialInstanceDynamic::Create(Parent, GetTransientPackage()));
+            }
+            Ctx.InstanceMid->CopyParameterOverrides(MIC);
+            Ctx.Comp->SetMaterial(0, Ctx.InstanceMid.Get());
+            GCaptureViaDynamicInstance = true;
+        }
+        else
+        {
+            Ctx.Comp->SetMaterial(0, Mat);
+        }
+        Ctx.Comp->MarkRenderStateDirty();
+        ForceComponentTexturesResident(Ctx.Comp);
+
+        const int32 FramesTotal = GetMaterialCaptureFrameCount(Mat);
+        OutFrames.Reserve(FramesTotal);
+
+        if (bSameParent)
+        {
+            WaitForComponentTextures(Ctx.World, Ctx.Comp, GetCaptureGateLimitSeconds(ECaptureGateClass::Material));
+        }
+        else
+        {
+            WaitForCaptureReady(Ctx.Scene, Ctx.Comp, Ctx.Comp->Bounds.Origin, Ctx.Distance, Ctx.ViewDir, ECaptureGateClass::Material);
+        }
+
+        FDuplicateFrameFilter Duplicates;
+        bool bAnyPicture = false;
+        for (int32 i = 0; i < FramesTotal && !Duplicates.ShouldStop(); ++i)
+        {
+            if (i > 0)
+            {
+                // World time drives material animation; no wall-clock wait needed.
+                Ctx.World->Tick(LEVELTICK_All, kCaptureMaterialFrameInterval);
+                FlushRenderingCommands();
+            }
+
+            FFrameStats Stats;
+            if (CaptureMaterialFrame(Ctx.Scene, Ctx.Comp, Mat, Ctx.Distance, Ctx.ViewDir, Resolution, i, Duplicates, OutFrames, Stats) == EMaterialFrameResult::Captured)
+            {
+                OutLowQuality |= Stats.IsLowQuality();
+                bAnyPicture |= !Stats.IsBlank();
+            }
+        }
+
+        // Only black frames: report no picture rather than a black swatch.
+        return bAnyPicture;
+    }
+
+    static bool CaptureMaterialOnSphereMultiFrame(UMaterialInterface* Mat, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance, bool& OutLowQuality)
+    {
+        OutLowQuality = false;
+        if (!Mat)
+        {
+            return false;
+        }
+
+        FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
+        SetupDefaultLights(Scene);
+
+        UWorld* World = Scene.GetWorld();
+        if (!World)
+        {
+            return false;
+        }
+
+        UStaticMesh* Sphere = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+        if (!Sphere)
+        {
+            return false;
+        }
+
+        UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
+        Comp->SetStaticMesh(Sphere);
+        Comp->SetMobility(EComponentMobility::Movable);
+        Comp->RegisterComponentWithWorld(World);
+        Comp->SetWorldScale3D(FVector(2.0f));
+        Comp->SetWorldRotation(FRotator(0.f, 270.f, 0.f));  // 270°
+        Comp->UpdateBounds();
+
+        Scene.AddComponent(Comp, FTransform::Identity);
+        Comp->SetMaterial(0, Mat);
+        Comp->MarkRenderStateDirty();
+
+        // Ensure textures are resident before capture (prevents low-mip blur on first pass).
+        ForceComponentTexturesResident(Comp);
+
+        const FBoxSphereBounds B = Comp->Bounds;
+        const float Radius = B.SphereRadius;
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.05f);
+        const FVector ViewDir = FVector(1.f, 0.f, 0.f);
+
+        OutFrames.Reset();
+        const int32 FramesTotal = GetMaterialCaptureFrameCount(Mat);
+        OutFrames.Reserve(FramesTotal);
+
+        // Wait until textures/shader maps of this material are ready (bounded).
+        WaitForCaptureReady(Scene, Comp, Comp->Bounds.Origin, OutDistance, ViewDir, ECaptureGateClass::Material);
+
+        // Now capture frames; a static material stops after a few identical ones.
+        FDuplicateFrameFilter Duplicates;
+        bool bAnyPicture = false;
+        for (int32 i = 0; i < FramesTotal && !Duplicates.ShouldStop(); ++i)
+        {
+            if (i > 0)
+            {
+                // World time drives material animation; no wall-clock wait needed.
+                World->Tick(LEVELTICK_All, kCaptureMaterialFrameInterval);
+                FlushRenderingCommands();
+            }
+
+            // NO camera rotation for materials (static view, animated material)
+            FFrameStats Stats;
+            if (CaptureMaterialFrame(Scene, Comp, Mat, OutDistance, ViewDir, Resolution, i, Duplicates, OutFrames, Stats) == EMaterialFrameResult::Captured)
+            {
+                OutLowQuality |= Stats.IsLowQuality();
+                bAnyPicture |= !Stats.IsBlank();
+            }
+        }
+
+        return bAnyPicture;
+    }
+
+    static bool CaptureMaterialOnCube(UMaterialInterface* Mat, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance)
+    {
+        if (!Mat)
+        {
+            return false;
+        }
+
+		FPreviewScene Scene{ FPreviewScene::ConstructionValues() };
+        SetupDefaultLights(Scene);
+
+        UWorld* World = Scene.GetWorld();
+        if (!World)
+        {
+            return false;
+        }
+
+        // Use SPHERE for materials, not cube
+        UStaticMesh* Sphere = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+        if (!Sphere)
+        {
+            return false;
+        }
+
+        UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(GetTransientPackage());
+        Comp->SetStaticMesh(Sphere);
+        Comp->SetMobility(EComponentMobility::Movable);
+        Comp->RegisterComponentWithWorld(World);
+        Comp->SetWorldScale3D(FVector(2.0f));
+        Comp->SetWorldRotation(FRotator(0.f, 270.f, 0.f));  // 270° (was 90°, +180° correction)
+        Comp->UpdateBounds();
+
+        Scene.AddComponent(Comp, FTransform::Identity);
+        Comp->SetMaterial(0, Mat);
+        Comp->MarkRenderStateDirty();
+
+        // Force textures
+        ForceComponentTexturesResident(Comp);
+
+        const FBoxSphereBounds B = Comp->Bounds;
+        const float Radius = B.SphereRadius;
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.05f);
+        const FVector ViewDir = FVector(1.f, 0.f, 0.f);
+        WaitForCaptureReady(Scene, Comp, Comp->Bounds.Origin, OutDistance, ViewDir, ECaptureGateClass::Material);
+        return CapturePreviewSceneToWebPBytes(
+            Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir, 0.0f, EWebPContent::MaterialSwatch);
+    }
+
+    static bool CaptureTexture2D(UTexture2D* Tex, int32 Resolution, TArray<uint8>& OutWebP)
+    {
+        if (!Tex)
+        {
+            return false;
+        }
+
+        Tex->SetForceMipLevelsToBeResident(30.0f);
+        Tex->WaitForStreaming();
+
+        int32 Width = 0;
+        int32 Height = 0;
+        ComputeTextureCaptureSize(Tex, Resolution, Width, Height);
+
+        UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
+        RT->InitCustomFormat(Width, Height, PF_B8G8R8A8, false);
+        RT->ClearColor = FLinearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        RT->TargetGamma = 1.8f;  // Compromise between too dark (1.0) and too bright (2.2)
+        RT->UpdateResourceImmediate(true);
+
+        FTextureRenderTargetResource* RTRes = RT->GameThread_GetRenderTargetResource();
+        if (!RTRes)
+        {
+            return false;
+        }
+
+        // Draw the texture onto the render target using a Canvas (no custom material needed)
+        FCanvas Canvas(RTRes, nullptr, FGameTime::GetTimeSinceAppStart(), GMaxRHIFeatureLevel);
+        Canvas.Clear(RT->ClearColor);
+
+        FCanvasTileItem Tile(FVector2D(0, 0), Tex->GetResource(), FVector2D(Width, Height), FLinearColor::White);
+        Tile.BlendMode = SE_BLEND_Opaque;
+        Canvas.DrawItem(Tile);
+        Canvas.Flush_GameThread();
+        FlushRenderingCommands();
+
+        TArray<FColor> Pixels;
+        Pixels.SetNumUninitialized(Width * Height);
+        FReadSurfaceDataFlags Flags(RCM_UNorm);
+        Flags.SetLinearToGamma(true);
+        const bool bOk = RTRes->ReadPixels(Pixels, Flags);
+        if (!bOk)
+        {
+            return false;
+        }
+
+        if (!EncodeWebPFromBGRA(Pixels, Width, Height, OutWebP, GetWebPEncodeOptions()))
+        {
+            return false;
+        }
+        return true;
+    }
+
+    static bool CaptureBlueprint(UBlueprint* BP, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance, TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe>* OutPixels = nullptr, FIntRect* OutCrop = nullptr)
+    {
+        if (!BP || !BP->GeneratedClass)
+        {
+            return false;
+        }
+
+        UClass* Cls = BP->GeneratedClass;
+        if (!Cls->IsChildOf(AActor::StaticClass()))
+        {
+            return false;
+        }
+
+        FScopedCaptureStage Stage(ECaptureStageKind::Blueprint);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        FActorSpawnParameters Params;
+        Params.ObjectFlags = RF_Transient;
+        Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        AActor* A = World->SpawnActor<AActor>(Cls, FTransform::Identity, Params);
+        if (!A)
+        {
+            return false;
+        }
+        Stage->TrackActor(A);
+
+        // Center actor
+        const FBox Box = A->GetComponentsBoundingBox(true);
+        const FVector Center = Box.GetCenter();
+        A->SetActorLocation(-Center);
+        
+        // Rotate actor 90° around Z-axis
+        FRotator ActorRotation = A->GetActorRotation();
+        ActorRotation.Yaw += 90.f;  // Add 90° rotation towards camera
+        A->SetActorRotation(ActorRotation);
+
+        const float Radius = Box.GetExtent().Size();
+        const float BlueprintPadding = FMath::Max(1.05f, kDistancePadding * 0.75f);
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, BlueprintPadding);
+        const FVector ViewDir = ChooseStableViewDirFromBoxExtent(Box.GetExtent());
+        WaitForCaptureReady(Scene, A, FVector::ZeroVector, OutDistance, ViewDir, ECaptureGateClass::Blueprint);
+        return CapturePreviewSceneToWebPBytes(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir, 0.0f, EWebPContent::Scene, OutPixels, OutCrop);
+    }
+
+    static bool CaptureBlueprintMultiFrame(UBlueprint* BP, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance)
+    {
+        OutFrames.Reset();
+        if (!BP || !BP->GeneratedClass)
+        {
+            return false;
+        }
+
+        UClass* Cls = BP->GeneratedClass;
+        if (!Cls->IsChildOf(AActor::StaticClass()))
+        {
+            return false;
+        }
+
+        FScopedCaptureStage Stage(ECaptureStageKind::Blueprint);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        FActorSpawnParameters Params;
+        Params.ObjectFlags = RF_Transient;
+        Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        AActor* A = World->SpawnActor<AActor>(Cls, FTransform::Identity, Params);
+        if (!A)
+        {
+            return false;
+        }
+        Stage->TrackActor(A);
+
+        const FBox Box = A->GetComponentsBoundingBox(true);
+        const FVector Center = Box.GetCenter();
+        A->SetActorLocation(-Center);
+
+        const FRotator ActorRotation = A->GetActorRotation();
+        A->SetActorRotation(ActorRotation + FRotator(0.f, 90.f, 0.f));
+
+        const float Radius = Box.GetExtent().Size();
+        const float BlueprintPadding = FMath::Max(1.05f, kDistancePadding * 0.75f);
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, BlueprintPadding);
+        const FVector ViewDir = ChooseStableViewDirFromBoxExtent(Box.GetExtent());
+        WaitForCaptureReady(Scene, A, FVector::ZeroVector, OutDistance, ViewDir, ECaptureGateClass::Blueprint);
+
+        const int32 FramesToKeep = GetBlueprintFrameCount();
+        const int32 FramesToDiscard = GetCapture360DiscardCount();
+        const int32 FramesTotal = FramesToKeep + FramesToDiscard;
+        OutFrames.Reserve(FramesToKeep);
+        FPipelinedFrameCapture Pipeline(OutFrames, true);
+        for (int32 i = 0; i < FramesTotal; ++i)
+        {
+            if (i > 0)
+            {
+                World->Tick(LEVELTICK_All, kCapture360FrameInterval);
+                FlushRenderingCommands();
+            }
+
+            float CameraYaw = 0.0f;
+            if (i >= FramesToDiscard)
+            {
+                const int32 FrameIndex = i - FramesToDiscard;
+                CameraYaw = (360.0f / (float)FramesToKeep) * FrameIndex;
+            }
+
+            if (i < FramesToDiscard)
+            {
+                WarmupPreviewSceneFrame(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, ViewDir, CameraYaw);
+                continue;
+            }
+
+            Pipeline.Submit(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, ViewDir, CameraYaw);
+            if (Pipeline.ShouldStop())
+            {
+                break;
+            }
+        }
+
+        Pipeline.Flush();
+        return OutFrames.Num() > 0;
+    }
+
+#if ASSETSNAPSHOT_WITH_NIAGARA
+    static bool CaptureNiagara(UNiagaraSystem* Sys, int32 Resolution, TArray<uint8>& OutWebP, float& OutDistance, TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe>* OutPixels = nullptr, FIntRect* OutCrop = nullptr)
+    {
+        if (!Sys)
+        {
+            return false;
+        }
+
+        FScopedCaptureStage Stage(ECaptureStageKind::Niagara);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        AActor* A = World->SpawnActor<AActor>();
+        Stage->TrackActor(A);
+        UNiagaraComponent* Comp = NewObject<UNiagaraComponent>(A);
+        Comp->SetAsset(Sys);
+        Comp->SetAutoActivate(true);
+        Comp->RegisterComponentWithWorld(World);
+        A->SetRootComponent(Comp);
+        A->SetActorLocation(FVector::ZeroVector);
+        
+        // Rotate actor 90° around Z-axis
+        FRotator ActorRotation = A->GetActorRotation();
+        ActorRotation.Yaw += 90.f;  // Add 90° rotation towards camera
+        A->SetActorRotation(ActorRotation);
+
+        // Let it simulate a bit
+        for (int32 i = 0; i < 30; ++i)
+        {
+            const float Dt = 1.f / 60.f;
+            World->Tick(LEVELTICK_All, Dt);
+            IStreamingManager::Get().Tick(Dt);
+        }
+        FlushRenderingCommands();
+
+        ForceComponentTexturesResident(Comp);
+
+        const FBoxSphereBounds B = Comp->Bounds;
+        const float Radius = FMath::Max(100.f, B.SphereRadius);
+        OutDistance = ComputeCameraDistanceFromBounds(Radius, kDefaultFov, 1.35f);
+        const FVector ViewDir = FVector(0.f, -1.f, 0.05f).GetSafeNormal();  // Y-axis
+        WaitForCaptureReady(Scene, Comp, FVector::ZeroVector, OutDistance, ViewDir, ECaptureGateClass::Niagara);
+        return CapturePreviewSceneToWebPBytes(Scene, FVector::ZeroVector, OutDistance, kDefaultFov, Resolution, OutWebP, ViewDir, 0.0f, EWebPContent::Scene, OutPixels, OutCrop);
+    }
+#endif
+
+    static bool CaptureAnimSequence(UAnimSequence* Anim, int32 Resolution, TArray<FZipEntry>& OutFrames, float& OutDistance, float& OutAnimLen)
+    {
+        if (!Anim)
+        {
+            return false;
+        }
+
+        OutAnimLen = Anim->GetPlayLength();
+        const int32 FrameCount = FMath::Clamp(GetAnimFrameCount(), 1, 32);
+
+        USkeletalMesh* PreviewMesh = nullptr;
+#if WITH_EDITOR
+        PreviewMesh = Anim->GetPreviewMesh();
+#endif
+        if (!PreviewMesh && Anim->GetSkeleton())
+        {
+#if WITH_EDITOR
+            PreviewMesh = Anim->GetSkeleton()->GetPreviewMesh();
+#endif
+        }
+        if (!PreviewMesh)
+        {
+            return false;
+        }
+#if WITH_EDITOR
+        FinishMeshCompilation(PreviewMesh);
+#endif
+
+        FScopedCaptureStage Stage(ECaptureStageKind::Anim);
+        FPreviewScene& Scene = Stage->Scene;
+        UWorld* World = Stage->World;
+        if (!World)
+        {
+            return false;
+        }
+
+        USkeletalMeshComponent* Comp = NewObject<USkeletalMeshComponent>(GetTransientPackage());
+        Comp->SetSkeletalMesh(PreviewMesh);
+        Comp->SetMobility(EComponentMobility::Movable);
+        Comp->RegisterComponentWithWorld(World);
+        Stage->AddSubject(Comp);
+        Comp->SetForcedLOD(1);
+
+        Comp->SetAnimationMode(EAnimationMode::AnimationSingleNode);
+        Comp->SetAnimation(Anim);
+        Comp->Stop();
+
+        // Ensure materials/textures are resident before the first capture
+        ForceComponentTexturesResident(Comp);
+
+        Comp->UpdateBounds();
+        const FVector CenterOffset = -Comp->Bounds.Origin;
+        const FVector ViewDir = FVector(1.f, 0.f, 0.02f).GetSafeNormal();
+        Comp->SetWorldLocation(CenterOffset);
+        
+        // Rotate mesh: base rotation + 90° around Z-axis
+        FRotator BaseRotation = FRotationMatrix::MakeFromX(-ViewDir).Rotator();
+        BaseRotation.Yaw += 90.f;  // Add 90° rotation towards camera
+        Comp->SetWorldRotation(BaseRotation);
+        Comp->UpdateBounds();
+        OutDistance = ComputeCameraDistanceFromBounds(Comp->Bounds.SphereRadius, kDefaultFov, kDistancePadding);
+
+        // Let streaming/shaders of the preview mesh settle before the first frame
+        WaitForCaptureReady(Scene, Comp, Comp->Bounds.Origin, OutDistance, ViewDir, ECaptureGateClass::Anim);
+
+        OutFrames.Reset();
         OutFrames.Reserve(FrameCount);
+        FPipelinedFrameCapture Pipeline(OutFrames);
+
+        for (int32 i = 0; i < FrameCount; ++i)
+        {
+            const float Alpha = (FrameCount <= 1) ? 0.f : (float)i / (float)(FrameCount - 1);
+            const float T = OutAnimLen * Alpha;
+
+            if (UAnimSingleNodeInstance* Inst = Cast<UAnimSingleNodeInstance>(Comp->GetAnimInstance()))
+            {
+                Inst->SetPlaying(false);
+                Inst->SetPosition(T, false);
+            }
+            Comp->TickAnimation(0.f, false);
+            Comp->RefreshBoneTransforms();
+            Comp->RefreshFollowerComponents();
+            Comp->UpdateComponentToWorld();
+            Comp->FinalizeBoneTransform();
+            Comp->MarkRenderDynamicDataDirty();
+
+            World->Tick(LEVELTICK_All, 1.f / 30.f);
+
+            // The pose update is queued ahead of the capture; no flush needed per frame.
+            Pipeline.Submit(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, ViewDir);
+        }
+
+        Pipeline.Flush();
+        return OutFrames.Num() > 0;
+    }
+
+    static TSharedPtr<FJsonObject> MeshStatsToJson(const FMeshStats& S)
+    {
+        TSharedPtr<FJsonObject> J = MakeShared<FJsonObject>();
+        J->SetNumberField(TEXT("triangles"), (double)S.Triangles);
+        J->SetNumberField(TEXT("polygons"), (double)S.Triangles);
+        J->SetNumberField(TEXT("vertices"), (double)S.Vertices);
+        J->SetNumberField(TEXT("lods"), (double)S.LODs);
+        J->SetBoolField(TEXT("nanite_enabled"), S.bNaniteEnabled);
+        J->SetStringField(TEXT("collision_complexity"), S.CollisionComplexity);
+
+        TSharedPtr<FJsonObject> Size = MakeShared<FJsonObject>();
+        Size->SetNumberField(TEXT("x"), S.ApproxSize.X);
+        Size->SetNumberField(TEXT("y"), S.ApproxSize.Y);
+        Size->SetNumberField(TEXT("z"), S.ApproxSize.Z);
+        J->SetObjectField(TEXT("approx_size_cm"), Size);
+        J->SetNumberField(TEXT("approx_size_max_cm"), (double)FMath::Max3(S.ApproxSize.X, S.ApproxSize.Y, S.ApproxSize.Z));
+        return J;
+    }
+
+    static FString SerializeJson(const TSharedRef<FJsonObject>& Root)
+    {
+        FString Out;
+        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Out);
+        FJsonSerializer::Serialize(Root, Writer);
+        return Out;
+    }
+
+    enum class EAssetExportStatus : uint8
+    {
+        Exported,
+        SkippedOnServer,
+        SkippedExisting,
+        Skipped,
+        Failed
+    };
+
+    static const TCHAR* AssetExportStatusToString(EAssetExportStatus Status)
+    {
+        switch (Status)
+        {
+        case EAssetExportStatus::Exported: return TEXT("exported");
+        case EAssetExportStatus::SkippedOnServer: return TEXT("skipped_server");
+        case EAssetExportStatus::SkippedExisting: return TEXT("skipped_existing");
+        case EAssetExportStatus::Skipped: return TEXT("skipped");
+        default: return TEXT("failed");
+        }
+    }
+
+    struct FAssetExportResult
+    {
+        EAssetExportStatus Status = EAssetExportStatus::Failed;
+        FString HashMain;
+        FString HashFull;
+        FString ZipPath;
+
+        bool Finish(EAssetExportStatus InStatus)
+        {
+            Status = InStatus;
+            return Status == EAssetExportStatus::Exported;
+        }
+    };
+
+    // Everything needed to decide skip/export without loading the asset.
+    struct FAssetExportPlan
+    {
+        FString PackageName;
+        FString MainFileAbs;
+        FString HashMain;
+        FString ZipPath;
+        bool bReplaceZip = false;
+        // Metadata-only: ZipPath is <hash>.meta.json, no capture, no upload.
+        bool bMetadataOnly = false;
+    };
+
+    // Returns true if the asset must be loaded and exported; otherwise OutResult holds the skip/fail status.
+    static bool PlanAssetExport(const FString& PackageName, FAssetExportPlan& OutPlan, FAssetExportResult& OutResult, bool bMetadataOnly = false);
+    // Server hash check PlanAssetExport would run (false = none). BeginPlanServerCheck starts it
+    // ahead of time and returns true while its answer is still outstanding.
+    static bool GetServerHashCheckTarget(bool bMetadataOnly, FString& OutBaseUrl, FString& OutPathTemplate);
+    static bool BeginPlanServerCheck(const FString& PackageName, bool bMetadataOnly);
+    // Tail of an export that needs the finished encodes: failed previews dropped,
+    // meta.json and the zip written, the upload queued. Batch loops hold it until
+    // the next asset has been loaded and captured, so one asset's WebP encodes
+    // overlap the next one's work instead of stalling the game thread.
+    struct FPendingAssetWrite
+    {
+        TSharedPtr<FJsonObject> Root;
+        TArray<TSharedPtr<FJsonValue>> PreviewFiles;
+        TArray<FZipEntry> ZipEntries;
+        FString ZipPath;
+        FString HashMain;
+        FString UploadEventBody;
+        FString UploadResolvePath;
+        bool bCaptured = false;
+
+        bool IsSet() const { return Root.IsValid(); }
+    };
+
+    // With OutDeferred, a captured asset returns with its write pending there and
+    // OutResult is only finished by FinishAssetWrite; other outcomes finish as usual.
+    static bool ExportPlannedAsset(UObject* Asset, const FAssetExportPlan& Plan, FAssetExportResult& OutResult, FPendingAssetWrite* OutDeferred = nullptr);
+    static bool FinishAssetWrite(FPendingAssetWrite& Write, FAssetExportResult& OutResult);
+    static bool ExportAssetBuildWithResult(UObject* Asset, FAssetExportResult& OutResult);
+
+    // ============================================================================
+    // BATCH CHECKPOINT JOURNAL
+    // ============================================================================
+    // <export>/_journal/<batch key>.jsonl, append-only, one JSON record per line:
+    //   {"type":"batch", "path", "include", "exclude", "assets":[ordered object paths]}
+    //   {"type":"asset", "index", "object_path", "status", "hash_main", "hash_full", "zip",
+    //    "load_seconds", "export_seconds", "finished_utc"}
+    //   {"type":"end", "exported", "skipped", "failed", "seconds"}
+    // The batch key only depends on the path and the effective class filters, so
+    // "aeb <path> --resume" finds the journal of the interrupted run.
+    // ============================================================================
+    struct FBatchJournal
+    {
+        FString Path;
+        // Object path -> journal record of assets finished by a previous run.
+        TMap<FString, TSharedPtr<FJsonObject>> FinishedRecords;
+        int32 LastFinishedIndex = INDEX_NONE;
+    };
+
+    static FString MakeBatchKey(const FString& GamePath, const TArray<FString>& IncludeClasses, const TArray<FString>& ExcludeClasses, bool bMetadataOnly)
+    {
+        const FString Raw = FString::Printf(TEXT("%s|%s|%s%s"),
+            *GamePath.ToLower(),
+            *FString::Join(IncludeClasses, TEXT(",")),
+            *FString::Join(ExcludeClasses, TEXT(",")),
+            bMetadataOnly ? TEXT("|meta") : TEXT(""));
+
+        FTCHARToUTF8 Utf8(*Raw);
+        blake3_hasher Hasher;
+        blake3_hasher_init(&Hasher);
+        blake3_hasher_update(&Hasher, Utf8.Get(), (size_t)Utf8.Length());
+        uint8 Out[8];
+        blake3_hasher_finalize(&Hasher, Out, sizeof(Out));
+
+        FString Readable = FPaths::MakeValidFileName(GamePath.Replace(TEXT("/"), TEXT("_")), TCHAR('_'));
+        Readable.RemoveFromStart(TEXT("_"));
+        return FString::Printf(TEXT("%s_%s"), *Readable.Left(48), *ToLowerHex(Out, sizeof(Out)));
+    }
+
+    static TSharedRef<FJsonObject> MakeBatchJournalHeader(
+        const FString& GamePath,
+        const TArray<FString>& IncludeClasses,
+        const TArray<FString>& ExcludeClasses,
+        const TArray<FAssetData>& Ordered)
+    {
+        auto ToJsonArray = [](const TArray<FString>& Values)
+        {
+            TArray<TSharedPtr<FJsonValue>> Out;
+            Out.Reserve(Values.Num());
+            for (const FString& V : Values)
+            {
+                Out.Add(MakeShared<FJsonValueString>(V));
+            }
+            return Out;
+        };
+
+        TArray<FString> ObjectPaths;
+        ObjectPaths.Reserve(Ordered.Num());
+        for (const FAssetData& AD : Ordered)
+        {
+            ObjectPaths.Add(AD.GetObjectPathString());
+        }
+
+        TSharedRef<FJsonObject> Header = MakeShared<FJsonObject>();
+        Header->SetStringField(TEXT("type"), TEXT("batch"));
+        Header->SetStringField(TEXT("started_utc"), FDateTime::UtcNow().ToIso8601());
+        Header->SetStringField(TEXT("path"), GamePath);
+        Header->SetArrayField(TEXT("include"), ToJsonArray(IncludeClasses));
+        Header->SetArrayField(TEXT("exclude"), ToJsonArray(ExcludeClasses));
+        Header->SetArrayField(TEXT("assets"), ToJsonArray(ObjectPaths));
+        return Header;
+    }
+
+    // Loads finished assets from an existing journal. Returns false if the journal
+    // is missing or was written for a different ordered asset list.
+    static bool LoadBatchJournal(FBatchJournal& Journal, const TArray<FAssetData>& Ordered)
+    {
+        TArray<FString> Lines;
+        if (!FFileHelper::LoadFileToStringArray(Lines, *Journal.Path) || Lines.Num() == 0)
+        {
+            return false;
+        }
+
+        bool bHeaderMatches = false;
+        for (const FString& Line : Lines)
+        {
+            TSharedPtr<FJsonObject> Obj;
+            TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Line);
+            if (Line.IsEmpty() || !FJsonSerializer::Deserialize(Reader, Obj) || !Obj.IsValid())
+            {
+                continue;
+            }
+
+            FString Type;
+            Obj->TryGetStringField(TEXT("type"), Type);
+            if (Type == TEXT("batch"))
+            {
+                const TArray<TSharedPtr<FJsonValue>>* AssetsJson = nullptr;
+                bHeaderMatches = Obj->TryGetArrayField(TEXT("assets"), AssetsJson) && AssetsJson->Num() == Ordered.Num();
+                for (int32 i = 0; bHeaderMatches && i < Ordered.Num(); ++i)
+                {
+                    bHeaderMatches = (*AssetsJson)[i]->AsString() == Ordered[i].GetObjectPathString();
+                }
+                Journal.FinishedRecords.Reset();
+                Journal.LastFinishedIndex = INDEX_NONE;
+            }
+            else if (Type == TEXT("asset") && bHeaderMatches)
+            {
+                FString ObjectPath;
+                int32 Index = INDEX_NONE;
+                Obj->TryGetStringField(TEXT("object_path"), ObjectPath);
+                Obj->TryGetNumberField(TEXT("index"), Index);
+                if (!ObjectPath.IsEmpty())
+                {
+                    Journal.FinishedRecords.Add(ObjectPath, Obj);
+                    Journal.LastFinishedIndex = FMath::Max(Journal.LastFinishedIndex, Index);
+                }
+            }
+        }
+        return bHeaderMatches;
+    }
+
+    // Index is the position in the full sorted batch (before sharding).
+    static TSharedRef<FJsonObject> MakeBatchAssetRecord(
+        int32 Index,
+        const FAssetData& AD,
+        const FAssetExportResult& Result,
+        double LoadSeconds,
+        double ExportSeconds)
+    {
+        TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+        Record->SetStringField(TEXT("type"), TEXT("asset"));
+        Record->SetNumberField(TEXT("index"), (double)Index);
+        Record->SetStringField(TEXT("object_path"), AD.GetObjectPathString());
+        Record->SetStringField(TEXT("class"), AD.AssetClassPath.GetAssetName().ToString());
+        Record->SetStringField(TEXT("status"), AssetExportStatusToString(Result.Status));
+        Record->SetStringField(TEXT("hash_main"), Result.HashMain);
+        Record->SetStringField(TEXT("hash_full"), Result.HashFull);
+        Record->SetStringField(TEXT("zip"), Result.ZipPath);
+        Record->SetNumberField(TEXT("load_seconds"), LoadSeconds);
+        Record->SetNumberField(TEXT("export_seconds"), ExportSeconds);
+        Record->SetStringField(TEXT("finished_utc"), FDateTime::UtcNow().ToIso8601());
+        return Record;
+    }
+
+    static TSharedRef<FJsonObject> AppendBatchJournalAsset(
+        const FBatchJournal& Journal,
+        int32 Index,
+        const FAssetData& AD,
+        const FAssetExportResult& Result,
+        double LoadSeconds,
+        double ExportSeconds)
+    {
+        TSharedRef<FJsonObject> Record = MakeBatchAssetRecord(Index, AD, Result, LoadSeconds, ExportSeconds);
+        if (!Journal.Path.IsEmpty())
+        {
+            AppendJsonLine(Journal.Path, Record);
+        }
+        return Record;
+    }
+
+    static TSharedRef<FJsonObject> MakeBatchEndRecord(const FAssetSnapshotExportSummary& Summary, double Seconds)
+    {
+        TSharedRef<FJsonObject> EndRecord = MakeShared<FJsonObject>();
+        EndRecord->SetStringField(TEXT("type"), TEXT("end"));
+        EndRecord->SetNumberField(TEXT("exported"), (double)Summary.Exported);
+        EndRecord->SetNumberField(TEXT("skipped"), (double)Summary.Skipped);
+        EndRecord->SetNumberField(TEXT("failed"), (double)Summary.Failed);
+        EndRecord->SetNumberField(TEXT("resumed"), (double)Summary.Resumed);
+        EndRecord->SetNumberField(TEXT("seconds"), Seconds);
+        EndRecord->SetStringField(TEXT("finished_utc"), FDateTime::UtcNow().ToIso8601());
+        return EndRecord;
+    }
+
+    static int64 GetRegistryDiskSize(IAssetRegistry& AR, FName PackageName)
+    {
+        const TOptional<FAssetPackageData> PackageData = AR.GetAssetPackageDataCopy(PackageName);
+        return PackageData.IsSet() ? FMath::Max<int64>(PackageData->DiskSize, 1) : 1;
+    }
+
+    // ============================================================================
+    // SHARDS AND MANIFESTS
+    // ============================================================================
+    // --shard=i/N picks a stable, size-balanced subset of the sorted asset list:
+    // largest packages first (registry DiskSize), each to the currently lightest
+    // shard, ties to the lower shard index. Every process computes the same
+    // assignment, so N editors can split one pack without coordination.
+    // Each batch writes <export>/_manifests/<key>[.shard-i-of-N].json; merging
+    // combines a complete shard set into <key>.json.
+    // ============================================================================
+    static void SelectShard(
+        const TArray<FAssetData>& Sorted,
+        int32 ShardIndex,
+        int32 ShardCount,
+        TArray<int32>& OutIndices,
+        int64& OutShardBytes,
+        int64& OutTotalBytes)
+    {
+        OutIndices.Reset();
+        OutShardBytes = 0;
+        OutTotalBytes = 0;
+
+        IAssetRegistry& AR = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+        TArray<int64> Sizes;
+        TArray<int32> Order;
+        Sizes.SetNum(Sorted.Num());
+        Order.Reserve(Sorted.Num());
+        for (int32 i = 0; i < Sorted.Num(); ++i)
+        {
+            Sizes[i] = GetRegistryDiskSize(AR, Sorted[i].PackageName);
+            OutTotalBytes += Sizes[i];
+            Order.Add(i);
+        }
+
+        Order.Sort([&Sizes](int32 A, int32 B)
+        {
+            return Sizes[A] != Sizes[B] ? Sizes[A] > Sizes[B] : A < B;
+        });
+
+        TArray<int64> Load;
+        Load.Init(0, ShardCount);
+        for (const int32 Index : Order)
+        {
+            int32 Lightest = 0;
+            for (int32 s = 1; s < ShardCount; ++s)
+            {
+                if (Load[s] < Load[Lightest])
+                {
+                    Lightest = s;
+                }
+            }
+            Load[Lightest] += Sizes[Index];
+            if (Lightest == ShardIndex)
+            {
+                OutIndices.Add(Index);
+                OutShardBytes += Sizes[Index];
+            }
+        }
+        OutIndices.Sort();
+    }
+
+    static FString GetManifestDir()
+    {
+        return UAssetSnapshotBPLibrary::GetDefaultExportRoot() / TEXT("_manifests");
+    }
+
+    static FString GetShardSuffix(int32 ShardIndex, int32 ShardCount)
+    {
+        return ShardCount > 1 ? FString::Printf(TEXT(".shard-%d-of-%d"), ShardIndex, ShardCount) : FString();
+    }
+
+    // Sets the asset list and its status counters on a manifest.
+    static void SetManifestAssets(const TSharedRef<FJsonObject>& Manifest, const TArray<TSharedPtr<FJsonValue>>& Assets)
+    {
+        int32 NumExported = 0;
+        int32 NumFailed = 0;
+        for (const TSharedPtr<FJsonValue>& Value : Assets)
+        {
+            const TSharedPtr<FJsonObject>* Obj = nullptr;
+            FString Status;
+            if (Value.IsValid() && Value->TryGetObject(Obj) && (*Obj)->TryGetStringField(TEXT("status"), Status))
+            {
+                NumExported += Status == AssetExportStatusToString(EAssetExportStatus::Exported) ? 1 : 0;
+                NumFailed += Status == AssetExportStatusToString(EAssetExportStatus::Failed) ? 1 : 0;
+            }
+        }
+        Manifest->SetArrayField(TEXT("assets"), Assets);
+        Manifest->SetNumberField(TEXT("exported"), (double)NumExported);
+        Manifest->SetNumberField(TEXT("failed"), (double)NumFailed);
+        Manifest->SetNumberField(TEXT("skipped"), (double)(Assets.Num() - NumExported - NumFailed));
+    }
+
+    static bool WriteBatchManifest(
+        const FString& FilePath,
+        const FString& BatchKey,
+        const FString& GamePath,
+        const TArray<FString>& IncludeClasses,
+        const TArray<FString>& ExcludeClasses,
+        int32 ShardIndex,
+        int32 ShardCount,
+        int32 TotalAssets,
+        const TArray<TSharedPtr<FJsonObject>>& AssetRecords)
+    {
+        TSharedRef<FJsonObject> Manifest = MakeBatchJournalHeader(GamePath, IncludeClasses, ExcludeClasses, TArray<FAssetData>());
+        Manifest->SetStringField(TEXT("type"), TEXT("manifest"));
+        Manifest->RemoveField(TEXT("started_utc"));
+        Manifest->SetStringField(TEXT("batch_key"), BatchKey);
+        Manifest->SetNumberField(TEXT("shard_index"), (double)ShardIndex);
+        Manifest->SetNumberField(TEXT("shard_count"), (double)ShardCount);
+        Manifest->SetNumberField(TEXT("total_assets"), (double)TotalAssets);
+        Manifest->SetStringField(TEXT("finished_utc"), FDateTime::UtcNow().ToIso8601());
+
+        TArray<TSharedPtr<FJsonValue>> Assets;
+        Assets.Reserve(AssetRecords.Num());
+        for (const TSharedPtr<FJsonObject>& Record : AssetRecords)
+        {
+            if (Record.IsValid())
+            {
+                Assets.Add(MakeShared<FJsonValueObject>(Record));
+            }
+        }
+        SetManifestAssets(Manifest, Assets);
+
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+        return FFileHelper::SaveStringToFile(SerializeJson(Manifest), *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+    }
+
+    // Merges every complete "<key>.shard-i-of-N.json" set into "<key>.json".
+    static int32 MergeShardManifests(const FString& BatchKeyFilter)
+    {
+        struct FShardSet
+        {
+            FString BatchKey;
+            int32 Count = 0;
+            TMap<int32, FString> Files;
+        };
+
+        const FString Dir = GetManifestDir();
+        TArray<FString> Names;
+        IFileManager::Get().FindFiles(Names, *(Dir / TEXT("*.json")), true, false);
+
+        TMap<FString, FShardSet> Sets;
+        for (const FString& Name : Names)
+        {
+            const int32 Pos = Name.Find(TEXT(".shard-"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+            if (Pos == INDEX_NONE)
+            {
+                continue;
+            }
+            const FString BatchKey = Name.Left(Pos);
+            if (!BatchKeyFilter.IsEmpty() && BatchKey != BatchKeyFilter)
+            {
+                continue;
+            }
+
+            FString Spec = Name.Mid(Pos + 7);
+            Spec.RemoveFromEnd(TEXT(".json"));
+            FString IndexStr;
+            FString CountStr;
+            if (!Spec.Split(TEXT("-of-"), &IndexStr, &CountStr))
+            {
+                continue;
+            }
+            const int32 ShardIndex = FCString::Atoi(*IndexStr);
+            const int32 ShardCount = FCString::Atoi(*CountStr);
+            if (ShardCount <= 1 || ShardIndex < 0 || ShardIndex >= ShardCount)
+            {
+                continue;
+            }
+
+            FShardSet& Set = Sets.FindOrAdd(BatchKey + TEXT("|") + CountStr);
+            Set.BatchKey = BatchKey;
+            Set.Count = ShardCount;
+            Set.Files.Add(ShardIndex, Dir / Name);
+        }
+
+        int32 Merged = 0;
+        for (const TPair<FString, FShardSet>& Pair : Sets)
+        {
+            const FShardSet& Set = Pair.Value;
+            if (Set.Files.Num() != Set.Count)
+            {
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Manifest merge: %s has %d of %d shard(s); skipping."), *Set.BatchKey, Set.Files.Num(), Set.Count);
+                continue;
+            }
+
+            TSharedPtr<FJsonObject> First;
+            TArray<TSharedPtr<FJsonValue>> Assets;
+            bool bOk = true;
+            for (int32 ShardIndex = 0; ShardIndex < Set.Count && bOk; ++ShardIndex)
+            {
+                FString Text;
+                TSharedPtr<FJsonObject> Shard;
+                const TArray<TSharedPtr<FJsonValue>>* ShardAssets = nullptr;
+                bOk = FFileHelper::LoadFileToString(Text, *Set.Files[ShardIndex])
+                    && FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Shard)
+                    && Shard.IsValid()
+                    && Shard->TryGetArrayField(TEXT("assets"), ShardAssets);
+                if (bOk)
+                {
+                    Assets.Append(*ShardAssets);
+                    if (!First.IsValid())
+                    {
+                        First = Shard;
+                    }
+                }
+                else
+                {
+                    UE_LOG(LogAssetSnapshot, Warning, TEXT("Manifest merge: cannot read %s"), *Set.Files[ShardIndex]);
+                }
+            }
+            if (!bOk || !First.IsValid())
+            {
+                continue;
+            }
+
+            auto GetIndex = [](const TSharedPtr<FJsonValue>& Value)
+            {
+                const TSharedPtr<FJsonObject>* Obj = nullptr;
+                int32 Index = MAX_int32;
+                if (Value.IsValid() && Value->TryGetObject(Obj))
+                {
+                    (*Obj)->TryGetNumberField(TEXT("index"), Index);
+                }
+                return Index;
+            };
+            Assets.Sort([&GetIndex](const TSharedPtr<FJsonValue>& A, const TSharedPtr<FJsonValue>& B)
+            {
+                return GetIndex(A) < GetIndex(B);
+            });
+
+            TSharedRef<FJsonObject> Manifest = MakeShared<FJsonObject>();
+            Manifest->Values = First->Values;
+            Manifest->RemoveField(TEXT("shard_index"));
+            Manifest->SetStringField(TEXT("finished_utc"), FDateTime::UtcNow().ToIso8601());
+            SetManifestAssets(Manifest, Assets);
+
+            int32 TotalAssets = 0;
+            Manifest->TryGetNumberField(TEXT("total_assets"), TotalAssets);
+            if (TotalAssets != Assets.Num())
+            {
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Manifest merge: %s lists %d of %d asset(s)."), *Set.BatchKey, Assets.Num(), TotalAssets);
+            }
+
+            const FString OutPath = Dir / (Set.BatchKey + TEXT(".json"));
+            if (FFileHelper::SaveStringToFile(SerializeJson(Manifest), *OutPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+            {
+                UE_LOG(LogAssetSnapshot, Log, TEXT("Manifest merge: wrote %s (%d shard(s), %d asset(s))"), *OutPath, Set.Count, Assets.Num());
+                ++Merged;
+            }
+        }
+        return Merged;
+    }
+
+    // ============================================================================
+    // WORK QUEUE (coordinator / workers)
+    // ============================================================================
+    // A coordinator process resolves the batch, owns journal and manifest, and
+    // serves the queue on the HTTP listener:
+    //   POST /work/next       {"worker"}                  -> {"status":"work"|"wait"|"done", ...item}
+    //   POST /work/result     {"worker","lease","record"} -> {"ok"}
+    //   POST /work/heartbeat  {"worker","leases"}         -> {"ok"}
+    // Workers pull one asset at a time (plus the few they prefetch), so slow
+    // assets do not hold up a static shard. Leases without a heartbeat (worker
+    // crashed) or running too long (renderer hang) are re-queued; an asset that
+    // loses kWorkMaxAttempts leases is recorded as failed. The queue hands out the
+    // highest estimated cost first. The coordinator is served from the core
+    // ticker, so the editor (or the commandlet's loop) keeps running meanwhile.
+    // ============================================================================
+    static const double kWorkHeartbeatIntervalSeconds = 10.0;
+    static const double kWorkHeartbeatTimeoutSeconds = 60.0;
+    static const double kWorkLeaseMaxSeconds = 900.0;
+    static const int32 kWorkMaxAttempts = 2;
+    static const float kWorkRequestTimeoutSeconds = 10.0f;
+    static const double kWorkCoordinatorLostSeconds = 60.0;
+    static const double kWorkDoneGraceSeconds = 5.0;
+
+    // Rough capture seconds per class until real timings come in.
+    static double GetDefaultClassCostSeconds(FName ClassName)
+    {
+        if (ClassName == TEXT("Material") || ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
+        {
+            return 6.0;
+        }
+        if (ClassName == TEXT("AnimSequence") || ClassName == TEXT("NiagaraSystem"))
+        {
+            return 8.0;
+        }
+        if (ClassName == TEXT("SkeletalMesh") || ClassName == TEXT("Blueprint"))
+        {
+            return 5.0;
+        }
+        return 4.0;
+    }
+
+    struct FWorkItem
+    {
+        int32 LocalIndex = INDEX_NONE;
+        int32 GlobalIndex = INDEX_NONE;
+        FName ClassName;
+        double SizeFactor = 1.0;
+        int32 Attempts = 0;
+        FString Lease;
+        FString Worker;
+        double LeaseStartSec = 0.0;
+        double LastHeartbeatSec = 0.0;
+        bool bDone = false;
+    };
+
+    struct FClassCost
+    {
+        double TotalSeconds = 0.0;
+        int32 Samples = 0;
+    };
+
+    struct FWorkQueue
+    {
+        TArray<FWorkItem> Items;
+        TArray<FAssetData> Assets;
+        TArray<TSharedPtr<FJsonObject>> Records;
+        TMap<FString, int32> Leases;
+        TMap<FName, FClassCost> ClassCosts;
+        FString JournalPath;
+        bool bMetadataOnly = false;
+        int32 Remaining = 0;
+
+        double EstimateCost(const FWorkItem& Item) const
+        {
+            const FClassCost* Observed = ClassCosts.Find(Item.ClassName);
+            const double ClassSeconds = (Observed && Observed->Samples > 0)
+                ? Observed->TotalSeconds / Observed->Samples
+                : GetDefaultClassCostSeconds(Item.ClassName);
+            return ClassSeconds * Item.SizeFactor;
+        }
+
+        int32 PickNext() const
+        {
+            int32 Best = INDEX_NONE;
+            double BestCost = -1.0;
+            for (int32 i = 0; i < Items.Num(); ++i)
+            {
+                const FWorkItem& Item = Items[i];
+                if (Item.bDone || !Item.Lease.IsEmpty())
+                {
+                    continue;
+                }
+                const double Cost = EstimateCost(Item);
+                if (Cost > BestCost)
+                {
+                    Best = i;
+                    BestCost = Cost;
+                }
+            }
+            return Best;
+        }
+
+        void Complete(int32 ItemIndex, const TSharedRef<FJsonObject>& Record)
+        {
+            FWorkItem& Item = Items[ItemIndex];
+            if (Item.bDone)
+            {
+                return;
+            }
+            if (!Item.Lease.IsEmpty())
+            {
+                Leases.Remove(Item.Lease);
+                Item.Lease.Reset();
+            }
+            Item.bDone = true;
+            --Remaining;
+
+            double LoadSeconds = 0.0;
+            double ExportSeconds = 0.0;
+            if (Record->TryGetNumberField(TEXT("load_seconds"), LoadSeconds) && Record->TryGetNumberField(TEXT("export_seconds"), ExportSeconds) && ExportSeconds > 0.0)
+            {
+                FClassCost& Cost = ClassCosts.FindOrAdd(Item.ClassName);
+                Cost.TotalSeconds += (LoadSeconds + ExportSeconds) / Item.SizeFactor;
+                ++Cost.Samples;
+            }
+
+            // The coordinator's view is authoritative for the index.
+            Record->SetNumberField(TEXT("index"), (double)Item.GlobalIndex);
+            Records[Item.LocalIndex] = Record;
+            AppendJsonLine(JournalPath, Record);
+        }
+
+        void ExpireLeases()
+        {
+            const double NowSec = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Items.Num(); ++i)
+            {
+                FWorkItem& Item = Items[i];
+                if (Item.bDone || Item.Lease.IsEmpty())
+                {
+                    continue;
+                }
+                const bool bSilent = NowSec - Item.LastHeartbeatSec > kWorkHeartbeatTimeoutSeconds;
+                const bool bTooLong = NowSec - Item.LeaseStartSec > kWorkLeaseMaxSeconds;
+                if (!bSilent && !bTooLong)
+                {
+                    continue;
+                }
+
+                const FAssetData& AD = Assets[Item.LocalIndex];
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Work queue: lease of %s on %s expired (%s, attempt %d)"),
+                    *AD.GetObjectPathString(), *Item.Worker, bSilent ? TEXT("no heartbeat") : TEXT("too long"), Item.Attempts);
+                Leases.Remove(Item.Lease);
+                Item.Lease.Reset();
+                if (Item.Attempts >= kWorkMaxAttempts)
+                {
+                    FAssetExportResult Failed;
+                    Failed.Finish(EAssetExportStatus::Failed);
+                    TSharedRef<FJsonObject> Record = MakeBatchAssetRecord(Item.GlobalIndex, AD, Failed, 0.0, 0.0);
+                    Record->SetStringField(TEXT("worker"), Item.Worker);
+                    Record->SetStringField(TEXT("error"), bSilent ? TEXT("worker lost") : TEXT("lease timeout"));
+                    Complete(i, Record);
+                }
+            }
+        }
+    };
+
+    static TSharedPtr<FJsonObject> ParseRequestJson(const FHttpServerRequest& Request)
+    {
+        FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()), Request.Body.Num());
+        TSharedPtr<FJsonObject> Obj;
+        FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(Text.Length(), Text.Get())), Obj);
+        return Obj;
+    }
+
+    static void RespondJson(const FHttpResultCallback& OnComplete, const TSharedRef<FJsonObject>& Body, EHttpServerResponseCodes Code = EHttpServerResponseCodes::Ok)
+    {
+        TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(SerializeJson(Body), TEXT("application/json"));
+        Resp->Code = Code;
+        OnComplete(MoveTemp(Resp));
+    }
+
+    struct FWorkCoordinator
+    {
+        FWorkQueue Queue;
+        TSharedPtr<IHttpRouter> Router;
+        TArray<FHttpRouteHandle> Routes;
+        FTSTicker::FDelegateHandle TickerHandle;
+        double LastReportSec = 0.0;
+        double DoneSinceSec = 0.0;
+        // Journal end record, manifest and the caller's callback, once the queue is done.
+        TFunction<void(const FWorkQueue&)> OnFinished;
+    };
+
+    static TSharedPtr<FWorkCoordinator> GWorkCoordinator;
+
+    static void StopWorkCoordinator()
+    {
+        const TSharedPtr<FWorkCoordinator> Coordinator = MoveTemp(GWorkCoordinator);
+        if (!Coordinator.IsValid())
+        {
+            return;
+        }
+        for (const FHttpRouteHandle& Route : Coordinator->Routes)
+        {
+            if (Route.IsValid())
+            {
+                Coordinator->Router->UnbindRoute(Route);
+            }
+        }
+        Coordinator->Routes.Reset();
+        if (Coordinator->TickerHandle.IsValid())
+        {
+            FTSTicker::GetCoreTicker().RemoveTicker(Coordinator->TickerHandle);
+            Coordinator->TickerHandle.Reset();
+        }
+        if (Coordinator->OnFinished)
+        {
+            const TFunction<void(const FWorkQueue&)> OnFinished = MoveTemp(Coordinator->OnFinished);
+            OnFinished(Coordinator->Queue);
+        }
+    }
+
+    // Binds the queue routes and serves them from the core ticker until every
+    // item is done. Returns right away; false if the port cannot be listened on.
+    static bool StartWorkCoordinator(const TSharedRef<FWorkCoordinator>& Coordinator, int32 Port)
+    {
+        TSharedPtr<IHttpRouter> Router = Port > 0 ? FHttpServerModule::Get().GetHttpRouter(Port) : nullptr;
+        if (!Router.IsValid())
+        {
+            UE_LOG(LogAssetSnapshot, Error, TEXT("Work queue: cannot listen on port %d"), Port);
+            return false;
+        }
+
+        // Routes are unbound before the coordinator is released.
+        FWorkQueue* QueuePtr = &Coordinator->Queue;
+        TArray<FHttpRouteHandle>& Routes = Coordinator->Routes;
+        Coordinator->Router = Router;
+        Routes.Add(Router->BindRoute(FHttpPath(TEXT("/work/next")), EHttpServerRequestVerbs::VERB_POST,
+            FHttpRequestHandler::CreateLambda([QueuePtr](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+            {
+                const TSharedPtr<FJsonObject> Body = ParseRequestJson(Request);
+                FString Worker;
+                if (Body.IsValid())
+                {
+                    Body->TryGetStringField(TEXT("worker"), Worker);
+                }
+
+                TSharedRef<FJsonObject> Resp = MakeShared<FJsonObject>();
+                const int32 ItemIndex = QueuePtr->PickNext();
+                if (ItemIndex == INDEX_NONE)
+                {
+                    Resp->SetStringField(TEXT("status"), QueuePtr->Remaining > 0 ? TEXT("wait") : TEXT("done"));
+                    RespondJson(OnComplete, Resp);
+                    return true;
+                }
+
+                FWorkItem& Item = QueuePtr->Items[ItemIndex];
+                const FAssetData& AD = QueuePtr->Assets[Item.LocalIndex];
+                Item.Lease = FGuid::NewGuid().ToString(EGuidFormats::Digits);
+                Item.Worker = Worker;
+                Item.LeaseStartSec = FPlatformTime::Seconds();
+                Item.LastHeartbeatSec = Item.LeaseStartSec;
+                ++Item.Attempts;
+                QueuePtr->Leases.Add(Item.Lease, ItemIndex);
+
+                Resp->SetStringField(TEXT("status"), TEXT("work"));
+                Resp->SetStringField(TEXT("lease"), Item.Lease);
+                Resp->SetNumberField(TEXT("index"), (double)Item.GlobalIndex);
+                Resp->SetStringField(TEXT("object_path"), AD.GetObjectPathString());
+                Resp->SetStringField(TEXT("class"), Item.ClassName.ToString());
+                Resp->SetBoolField(TEXT("metadata_only"), QueuePtr->bMetadataOnly);
+                UE_LOG(LogAssetSnapshot, Log, TEXT("Work queue: %s -> %s (attempt %d, est %.1fs, %d left)"),
+                    *AD.GetObjectPathString(), *Worker, Item.Attempts, QueuePtr->EstimateCost(Item), QueuePtr->Remaining);
+                RespondJson(OnComplete, Resp);
+                return true;
+            })));
+
+        Routes.Add(Router->BindRoute(FHttpPath(TEXT("/work/result")), EHttpServerRequestVerbs::VERB_POST,
+            FHttpRequestHandler::CreateLambda([QueuePtr](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+            {
+                const TSharedPtr<FJsonObject> Body = ParseRequestJson(Request);
+                const TSharedPtr<FJsonObject>* Record = nullptr;
+                FString Lease;
+                FString Worker;
+                int32 GlobalIndex = INDEX_NONE;
+                TSharedRef<FJsonObject> Resp = MakeShared<FJsonObject>();
+                if (!Body.IsValid() || !Body->TryGetObjectField(TEXT("record"), Record) || !(*Record)->TryGetNumberField(TEXT("index"), GlobalIndex))
+                {
+                    Resp->SetBoolField(TEXT("ok"), false);
+                    RespondJson(OnComplete, Resp, EHttpServerResponseCodes::BadRequest);
+                    return true;
+                }
+                Body->TryGetStringField(TEXT("lease"), Lease);
+                Body->TryGetStringField(TEXT("worker"), Worker);
+
+                // Match by lease first; a result for a re-queued lease is still accepted once.
+                int32 ItemIndex = INDEX_NONE;
+                if (const int32* Leased = QueuePtr->Leases.Find(Lease))
+                {
+                    ItemIndex = *Leased;
+                }
+                else
+                {
+                    ItemIndex = QueuePtr->Items.IndexOfByPredicate([GlobalIndex](const FWorkItem& Item) { return Item.GlobalIndex == GlobalIndex; });
+                }
+
+                if (ItemIndex != INDEX_NONE)
+                {
+                    (*Record)->SetStringField(TEXT("worker"), Worker);
+                    QueuePtr->Complete(ItemIndex, Record->ToSharedRef());
+                }
+                Resp->SetBoolField(TEXT("ok"), ItemIndex != INDEX_NONE);
+                RespondJson(OnComplete, Resp);
+                return true;
+            })));
+
+        Routes.Add(Router->BindRoute(FHttpPath(TEXT("/work/heartbeat")), EHttpServerRequestVerbs::VERB_POST,
+            FHttpRequestHandler::CreateLambda([QueuePtr](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+            {
+                const TSharedPtr<FJsonObject> Body = ParseRequestJson(Request);
+                TArray<FString> Leases;
+                if (Body.IsValid())
+                {
+                    Body->TryGetStringArrayField(TEXT("leases"), Leases);
+                    FString Lease;
+                    if (Body->TryGetStringField(TEXT("lease"), Lease))
+                    {
+                        Leases.Add(Lease);
+                    }
+                }
+                bool bKnown = false;
+                for (const FString& Lease : Leases)
+                {
+                    if (const int32* Leased = QueuePtr->Leases.Find(Lease))
+                    {
+                        QueuePtr->Items[*Leased].LastHeartbeatSec = FPlatformTime::Seconds();
+                        bKnown = true;
+                    }
+                }
+                TSharedRef<FJsonObject> Resp = MakeShared<FJsonObject>();
+                Resp->SetBoolField(TEXT("ok"), bKnown);
+                RespondJson(OnComplete, Resp, bKnown ? EHttpServerResponseCodes::Ok : EHttpServerResponseCodes::NotFound);
+                return true;
+            })));
+
+        FHttpServerModule::Get().StartAllListeners();
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Work queue: serving %d asset(s) on port %d (POST /work/next)"), Coordinator->Queue.Remaining, Port);
+
+        // The HTTP server and the outbox run on the same ticker; nothing here blocks.
+        Coordinator->LastReportSec = FPlatformTime::Seconds();
+        const TWeakPtr<FWorkCoordinator> WeakCoordinator = Coordinator;
+        Coordinator->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateLambda([WeakCoordinator](float DeltaTime)
+            {
+                const TSharedPtr<FWorkCoordinator> Pinned = WeakCoordinator.Pin();
+                if (!Pinned.IsValid())
+                {
+                    return false;
+                }
+                FWorkQueue& Queue = Pinned->Queue;
+                const double NowSec = FPlatformTime::Seconds();
+                Queue.ExpireLeases();
+
+                if (Queue.Remaining <= 0)
+                {
+                    // Keep answering "done" briefly so idle workers exit cleanly.
+                    Pinned->DoneSinceSec = Pinned->DoneSinceSec > 0.0 ? Pinned->DoneSinceSec : NowSec;
+                    if (NowSec - Pinned->DoneSinceSec > kWorkDoneGraceSeconds)
+                    {
+                        Pinned->TickerHandle.Reset();
+                        StopWorkCoordinator();
+                        return false;
+                    }
+                }
+                if (NowSec - Pinned->LastReportSec > 30.0)
+                {
+                    UE_LOG(LogAssetSnapshot, Log, TEXT("Work queue: %d of %d remaining, %d leased"), Queue.Remaining, Queue.Items.Num(), Queue.Leases.Num());
+                    Pinned->LastReportSec = NowSec;
+                }
+                return true;
+            }),
+            0.1f);
+        GWorkCoordinator = Coordinator;
+        return true;
+    }
+
+    // Synchronous JSON POST to the coordinator (same wait pattern as the backend calls).
+    static bool PostWorkJson(const FString& Url, const TSharedRef<FJsonObject>& Body, TSharedPtr<FJsonObject>& OutResponse)
+    {
+        TSharedRef<TAtomic<bool>> bDone = MakeShared<TAtomic<bool>>(false);
+        TSharedRef<TAtomic<bool>> bAbandoned = MakeShared<TAtomic<bool>>(false);
+        TSharedRef<FString> ResponseText = MakeShared<FString>();
+
+        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+        Request->SetURL(Url);
+        Request->SetVerb(TEXT("POST"));
+        Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+        Request->SetContentAsString(SerializeJson(Body));
+        Request->SetTimeout(kWorkRequestTimeoutSeconds);
+        Request->OnProcessRequestComplete().BindLambda(
+            [bDone, bAbandoned, ResponseText](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSucceeded)
+            {
+                if (bAbandoned->Load())
+                {
+                    return;
+                }
+                if (bSucceeded && Resp.IsValid() && Resp->GetResponseCode() == 200)
+                {
+                    *ResponseText = Resp->GetContentAsString();
+                }
+                bDone->Store(true);
+            });
+        Request->ProcessRequest();
+
+        const double Start = FPlatformTime::Seconds();
+        while (!bDone->Load() && (FPlatformTime::Seconds() - Start) < kWorkRequestTimeoutSeconds)
+        {
+            FHttpModule::Get().GetHttpManager().Tick(0.01f);
+            FPlatformProcess::Sleep(0.01f);
+        }
+        if (!bDone->Load())
+        {
+            bAbandoned->Store(true);
+            Request->CancelRequest();
+            return false;
+        }
+
+        OutResponse.Reset();
+        return !ResponseText->IsEmpty()
+            && FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(*ResponseText), OutResponse)
+            && OutResponse.IsValid();
+    }
+
+    // Heartbeats are sent from a thread of their own, so loads, mesh builds, GC
+    // and result posts on the game thread cannot starve them; the HTTP thread
+    // delivers the requests and nobody waits for the answer.
+    struct FWorkerHeartbeat
+    {
+        FString BaseUrl;
+        FString WorkerId;
+
+        ~FWorkerHeartbeat()
+        {
+            Stop();
+        }
+
+        void Start()
+        {
+            Wake = FPlatformProcess::GetSynchEventFromPool(false);
+            Sender = Async(EAsyncExecution::Thread, [this]()
+            {
+                while (!bStop.Load())
+                {
+                    Send();
+                    Wake->Wait(FTimespan::FromSeconds(kWorkHeartbeatIntervalSeconds));
+                }
+            });
+        }
+
+        void Stop()
+        {
+            if (!Wake)
+            {
+                return;
+            }
+            bStop.Store(true);
+            Wake->Trigger();
+            Sender.Wait();
+            FPlatformProcess::ReturnSynchEventToPool(Wake);
+            Wake = nullptr;
+        }
+
+        void AddLease(const FString& Lease)
+        {
+            FScopeLock Guard(&Lock);
+            Leases.Add(Lease);
+        }
+
+        void RemoveLease(const FString& Lease)
+        {
+            FScopeLock Guard(&Lock);
+            Leases.Remove(Lease);
+        }
+
+    private:
+        FCriticalSection Lock;
+        TArray<FString> Leases;
+        TAtomic<bool> bStop{ false };
+        FEvent* Wake = nullptr;
+        TFuture<void> Sender;
+
+        void Send()
+        {
+            TArray<TSharedPtr<FJsonValue>> LeaseValues;
+            {
+                FScopeLock Guard(&Lock);
+                for (const FString& Lease : Leases)
+                {
+                    LeaseValues.Add(MakeShared<FJsonValueString>(Lease));
+                }
+            }
+            if (LeaseValues.Num() == 0)
+            {
+                return;
+            }
+
+            TSharedRef<FJsonObject> Body = MakeShared<FJsonObject>();
+            Body->SetStringField(TEXT("worker"), WorkerId);
+            Body->SetArrayField(TEXT("leases"), LeaseValues);
+            TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+            Request->SetURL(BaseUrl + TEXT("/work/heartbeat"));
+            Request->SetVerb(TEXT("POST"));
+            Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+            Request->SetContentAsString(SerializeJson(Body));
+            Request->SetTimeout(kWorkRequestTimeoutSeconds);
+            Request->ProcessRequest();
+        }
+    };
+
+    // An asset leased from the coordinator, planned when it was handed out.
+    struct FWorkerLease
+    {
+        FString Lease;
+        FString ObjectPath;
+        int32 GlobalIndex = INDEX_NONE;
+        int32 Slot = INDEX_NONE; // prefetch / precompile key
+        bool bMetadataOnly = false;
+        bool bExport = false;
+        FAssetData AD;
+        FAssetExportPlan Plan;
+        FAssetExportResult Result;
+    };
+
+    static int32 RunExportWorker(const FString& CoordinatorUrl, FAssetSnapshotExportSummary& Summary)
+    {
+        const FString BaseUrl = NormalizeBaseUrl(CoordinatorUrl);
+        const FString WorkerId = FString::Printf(TEXT("%s-%u"), FPlatformProcess::ComputerName(), FPlatformProcess::GetCurrentProcessId());
+        IAssetRegistry& AR = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Work queue worker %s pulling from %s"), *WorkerId, *BaseUrl);
+        ResetMaterialTimeDependenceCache();
+
+        FWorkerHeartbeat Heartbeat;
+        Heartbeat.BaseUrl = BaseUrl;
+        Heartbeat.WorkerId = WorkerId;
+        Heartbeat.Start();
+
+        // Same lookahead as a local batch: the next leases load while one is
+        // captured, and their materials compile in the background once loaded.
+        FPackagePrefetcher Prefetcher;
+        FShaderPrecompile Precompile;
+        int32 MaxPrecompile = 0;
+        if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
+        {
+            Prefetcher.MaxAhead = FMath::Max(0, Settings->PrefetchAssetCount);
+            Prefetcher.BudgetBytes = (int64)FMath::Max(0, Settings->PrefetchMemoryBudgetMB) * 1024 * 1024;
+            MaxPrecompile = FMath::Max(0, Settings->ShaderPrecompileMaxMaterials);
+        }
+        GPackagePrefetcher = &Prefetcher;
+
+        FMaterialCaptureContext MaterialCtx;
+        bool bMaterialCtxTried = false;
+        FScopedCaptureRig CaptureRig;
+        FCaptureStagePool StagePool;
+        GCaptureStagePool = &StagePool;
+        int32 Exported = 0;
+        FBatchGCPolicy GCPolicy;
+        GCPolicy.Init();
+        double LastContactSec = FPlatformTime::Seconds();
+        TArray<FWorkerLease> Leased;
+        int32 NextSlot = 0;
+        bool bQueueDone = false;
+        bool bCoordinatorLost = false;
+        TWeakObjectPtr<UMaterialInterface> LastInstance;
+
+        // Leases one more asset; false when the coordinator has nothing for us right now.
+        auto PullNext = [&]() -> bool
+        {
+            TSharedRef<FJsonObject> NextBody = MakeShared<FJsonObject>();
+            NextBody->SetStringField(TEXT("worker"), WorkerId);
+            TSharedPtr<FJsonObject> Item;
+            if (!PostWorkJson(BaseUrl + TEXT("/work/next"), NextBody, Item))
+            {
+                if (FPlatformTime::Seconds() - LastContactSec > kWorkCoordinatorLostSeconds)
+                {
+                    UE_LOG(LogAssetSnapshot, Warning, TEXT("Work queue worker: coordinator %s unreachable, stopping."), *BaseUrl);
+                    bCoordinatorLost = true;
+                }
+                return false;
+            }
+            LastContactSec = FPlatformTime::Seconds();
+
+            FString Status;
+            Item->TryGetStringField(TEXT("status"), Status);
+            if (Status == TEXT("done"))
+            {
+                bQueueDone = true;
+                return false;
+            }
+            if (Status != TEXT("work"))
+            {
+                return false;
+            }
+
+            FWorkerLease& Next = Leased.AddDefaulted_GetRef();
+            Item->TryGetStringField(TEXT("lease"), Next.Lease);
+            Item->TryGetStringField(TEXT("object_path"), Next.ObjectPath);
+            Item->TryGetNumberField(TEXT("index"), Next.GlobalIndex);
+            Item->TryGetBoolField(TEXT("metadata_only"), Next.bMetadataOnly);
+            Next.Slot = NextSlot++;
+            Heartbeat.AddLease(Next.Lease);
+
+            Next.AD = AR.GetAssetByObjectPath(FSoftObjectPath(Next.ObjectPath));
+            if (!Next.AD.IsValid())
+            {
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Work queue worker: unknown asset %s"), *Next.ObjectPath);
+                Next.Result.Finish(EAssetExportStatus::Failed);
+            }
+            else
+            {
+                Next.bExport = PlanAssetExport(Next.AD.PackageName.ToString(), Next.Plan, Next.Result, Next.bMetadataOnly);
+            }
+            if (Next.bExport && Leased.Num() > 1 && !GCPolicy.IsUnderPressure())
+            {
+                const int64 EstimatedBytes = FMath::Max<int64>(0, IFileManager::Get().FileSize(*Next.Plan.MainFileAbs));
+                if (Prefetcher.CanRequest(EstimatedBytes))
+                {
+                    Prefetcher.Request(Next.Slot, Next.AD, EstimatedBytes);
+                }
+            }
+            return true;
+        };
+
+        // Prefetched materials go to the shader compiler as soon as their package is in.
+        auto SubmitLoadedMaterials = [&]()
+        {
+            for (const FWorkerLease& Ahead : Leased)
+            {
+                if (Ahead.bMetadataOnly || Precompile.IsPending(Ahead.Slot) || Precompile.Pending.Num() >= MaxPrecompile)
+                {
+                    continue;
+                }
+                if (UMaterialInterface* Mat = Cast<UMaterialInterface>(Prefetcher.PeekLoaded(Ahead.Slot)))
+                {
+                    Precompile.Submit(Ahead.Slot, Mat);
+                }
+            }
+        };
+
+        // Lease order, except that a lease whose shaders are already done (siblings of
+        // the instance just captured first) goes ahead of one still compiling.
+        auto PickNext = [&]() -> int32
+        {
+            const int32 Sibling = Precompile.FindReadySibling(LastInstance.Get());
+            const int32 Ready = Sibling != INDEX_NONE ? Sibling : Precompile.FindReady();
+            const int32 ReadyLease = Leased.IndexOfByPredicate([Ready](const FWorkerLease& L) { return L.Slot == Ready; });
+            if (Ready != INDEX_NONE && ReadyLease != INDEX_NONE)
+            {
+                return ReadyLease;
+            }
+            const int32 NotCompiling = Leased.IndexOfByPredicate([&Precompile](const FWorkerLease& L) { return !Precompile.IsPending(L.Slot); });
+            return NotCompiling != INDEX_NONE ? NotCompiling : 0;
+        };
+
+        // Posts a finished lease to the coordinator and lets it go.
+        auto ReportLease = [&](const FWorkerLease& Finished, double LoadSeconds, double ExportSeconds)
+        {
+            switch (Finished.Result.Status)
+            {
+            case EAssetExportStatus::Exported: ++Exported; break;
+            case EAssetExportStatus::Failed: ++Summary.Failed; break;
+            default: ++Summary.Skipped; break;
+            }
+            ++Summary.Total;
+
+            TSharedRef<FJsonObject> ResultBody = MakeShared<FJsonObject>();
+            ResultBody->SetStringField(TEXT("worker"), WorkerId);
+            ResultBody->SetStringField(TEXT("lease"), Finished.Lease);
+            TSharedRef<FJsonObject> Record = MakeBatchAssetRecord(Finished.GlobalIndex, Finished.AD, Finished.Result, LoadSeconds, ExportSeconds);
+            Record->SetStringField(TEXT("object_path"), Finished.ObjectPath);
+            ResultBody->SetObjectField(TEXT("record"), Record);
+            TSharedPtr<FJsonObject> Ack;
+            for (int32 Attempt = 0; Attempt < 3 && !PostWorkJson(BaseUrl + TEXT("/work/result"), ResultBody, Ack); ++Attempt)
+            {
+                IdleWithPrefetch(1.0f);
+            }
+            Heartbeat.RemoveLease(Finished.Lease);
+        };
+
+        // As in a local batch, a lease's zip is written (and its result posted) once
+        // the next lease has been captured; the heartbeat keeps it alive meanwhile.
+        struct FInFlightWrite
+        {
+            FWorkerLease Lease;
+            double LoadSeconds = 0.0;
+            double ExportSeconds = 0.0;
+            FPendingAssetWrite Write;
+        };
+        FInFlightWrite InFlight;
+        auto FinishInFlight = [&]()
+        {
+            if (!InFlight.Write.IsSet())
+            {
+                return;
+            }
+            const double WriteStartSec = FPlatformTime::Seconds();
+            FinishAssetWrite(InFlight.Write, InFlight.Lease.Result);
+            ReportLease(InFlight.Lease, InFlight.LoadSeconds, InFlight.ExportSeconds + (FPlatformTime::Seconds() - WriteStartSec));
+            InFlight = FInFlightWrite();
+        };
+
+        while (!bCoordinatorLost)
+        {
+            const int32 Window = 1 + Prefetcher.MaxAhead;
+            while (!bQueueDone && !bCoordinatorLost && Leased.Num() < Window)
+            {
+                if (!PullNext())
+                {
+                    break;
+                }
+            }
+            if (Leased.Num() == 0)
+            {
+                FinishInFlight();
+                if (bQueueDone || bCoordinatorLost)
+                {
+                    break;
+                }
+                IdleWithPrefetch(1.0f);
+                continue;
+            }
+            SubmitLoadedMaterials();
+
+            const int32 Pick = PickNext();
+            FWorkerLease Current = MoveTemp(Leased[Pick]);
+            Leased.RemoveAt(Pick);
+            LastInstance.Reset();
+
+            FAssetExportResult& Result = Current.Result;
+            FPendingAssetWrite Write;
+            double LoadSeconds = 0.0;
+            double ExportSeconds = 0.0;
+            if (Current.bExport)
+            {
+                const double LoadStartSec = FPlatformTime::Seconds();
+                UObject* Obj = Prefetcher.Acquire(Current.Slot, Current.AD);
+                LoadSeconds = FPlatformTime::Seconds() - LoadStartSec;
+                GCPolicy.NoteLoaded();
+
+                if (Obj && !Current.bMetadataOnly && !bMaterialCtxTried && Obj->IsA<UMaterialInterface>())
+                {
+                    bMaterialCtxTried = true;
+                    if (InitMaterialCaptureContext(MaterialCtx))
+                    {
+                        GMaterialCaptureContext = &MaterialCtx;
+                    }
+                }
+
+                if (!Obj)
+                {
+                    Result.Finish(EAssetExportStatus::Failed);
+                }
+                else
+                {
+                    const double ExportStartSec = FPlatformTime::Seconds();
+                    ExportPlannedAsset(Obj, Current.Plan, Result, &Write);
+                    LastInstance = Cast<UMaterialInstance>(Obj);
+                    ExportSeconds = FPlatformTime::Seconds() - ExportStartSec;
+                }
+            }
+            Precompile.Release(Current.Slot);
+
+            FinishInFlight();
+            if (Write.IsSet())
+            {
+                InFlight.Lease = MoveTemp(Current);
+                InFlight.LoadSeconds = LoadSeconds;
+                InFlight.ExportSeconds = ExportSeconds;
+                InFlight.Write = MoveTemp(Write);
+            }
+            else
+            {
+                ReportLease(Current, LoadSeconds, ExportSeconds);
+            }
+
+            PumpOutbox();
+#if WITH_EDITOR
+            GCPolicy.CollectIfNeeded();
+#endif
+        }
 
-        for (int32 i = 0; i < FrameCount; ++i)
+        FinishInFlight();
+        Prefetcher.FlushAll();
+        GPackagePrefetcher = nullptr;
+        Heartbeat.Stop();
+        GMaterialCaptureContext = nullptr;
+        GCaptureStagePool = nullptr;
+        GCPolicy.LogSummary();
+        Summary.Exported = Exported;
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Work queue worker %s finished: %d processed, %d exported, %d failed"), *WorkerId, Summary.Total, Exported, Summary.Failed);
+        return Exported;
+    }
+}
+
+FString UAssetSnapshotBPLibrary::GetDefaultExportRoot()
+{
+    return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() / TEXT("export"));
+}
+
+int32 UAssetSnapshotBPLibrary::ExportPathBuilds(const FString& InGamePath, const FString& InTypeFilter, const FString& InExcludeTypeFilter)
+{
+    return ExportPathBuildsNative(InGamePath, InTypeFilter, InExcludeTypeFilter, FAssetSnapshotExportOptions());
+}
+
+int32 UAssetSnapshotBPLibrary::ExportPathBuildsNative(
+    const FString& InGamePath,
+    const FString& InTypeFilter,
+    const FString& InExcludeTypeFilter,
+    const FAssetSnapshotExportOptions& Options,
+    FAssetSnapshotExportSummary* OutSummary)
+{
+    FAssetSnapshotExportSummary LocalSummary;
+    FAssetSnapshotExportSummary& Summary = OutSummary ? *OutSummary : LocalSummary;
+    Summary = FAssetSnapshotExportSummary();
+
+    if (Options.bCoordinator && AssetSnapshot::GWorkCoordinator.IsValid())
+    {
+        UE_LOG(LogAssetSnapshot, Error, TEXT("ExportPathBuilds: a work queue is already being served"));
+        return 0;
+    }
+
+    ++GAssetSnapshotExportBatchId;
+    GAssetSnapshotServerBatchId = GAssetSnapshotExportBatchId;
+    GAssetSnapshotServerChecked = false;
+    GAssetSnapshotServerAvailable = true;
+    GAssetSnapshotServerWarned = false;
+    GAssetSnapshotServerSkipKnown = false;
+    GAssetSnapshotServerSkipEnabled = true;
+    AssetSnapshot::ResetBackendBreaker();
+    AssetSnapshot::ResetMaterialTimeDependenceCache();
+    FString Path = InGamePath;
+    Path.TrimStartAndEndInline();
+
+    if (Path.IsEmpty())
+    {
+        UE_LOG(LogAssetSnapshot, Error, TEXT("ExportPathBuilds: empty path"));
+        return 0;
+    }
+
+    FAssetRegistryModule& ARM = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+    IAssetRegistry& AR = ARM.Get();
+
+    TArray<FAssetData> Assets;
+
+    if (Path.Contains(TEXT(".")))
+    {
+        const FSoftObjectPath SOP(Path);
+		const FAssetData AD = AR.GetAssetByObjectPath(SOP);
+        if (AD.IsValid())
         {
-            const float Alpha = (FrameCount <= 1) ? 0.f : (float)i / (float)(FrameCount - 1);
-            const float T = OutAnimLen * Alpha;
+            Assets.Add(AD);
+        }
+    }
 
-            if (UAnimSingleNodeInstance* Inst = Cast<UAnimSingleNodeInstance>(Comp->GetAnimInstance()))
+    if (Assets.Num() == 0)
+    {
+        // Directory path?
+        if (Path.StartsWith(TEXT("/Game")))
+        {
+            AR.GetAssetsByPath(FName(*Path), Assets, true);
+        }
+    }
+
+    if (Assets.Num() == 0)
+    {
+        // Maybe a package path without .ObjectName
+        if (Path.StartsWith(TEXT("/Game")) && !Path.Contains(TEXT(".")))
+        {
+            const FString AssetName = FPackageName::GetLongPackageAssetName(Path);
+            const FString ObjPath = Path + TEXT(".") + AssetName;
+            const FSoftObjectPath SOP(ObjPath);
+			const FAssetData AD = AR.GetAssetByObjectPath(SOP);
+            if (AD.IsValid())
             {
-                Inst->SetPlaying(false);
-                Inst->SetPosition(T, false);
+                Assets.Add(AD);
             }
-            Comp->TickAnimation(0.f, false);
-            Comp->RefreshBoneTransforms();
-            Comp->RefreshFollowerComponents();
-            Comp->UpdateComponentToWorld();
-            Comp->FinalizeBoneTransform();
-            Comp->MarkRenderDynamicDataDirty();
+        }
+    }
 
-            World->Tick(LEVELTICK_All, 1.f / 30.f);
-            FlushRenderingCommands();
+    if (Assets.Num() == 0)
+    {
+        UE_LOG(LogAssetSnapshot, Error, TEXT("No assets found for: %s"), *Path);
+        return 0;
+    }
 
-            TArray<uint8> WebP;
-            if (!CapturePreviewSceneToWebPBytes(Scene, Comp->Bounds.Origin, OutDistance, kDefaultFov, Resolution, WebP, ViewDir))
+    const TSet<FName> AllowedClasses = {
+        TEXT("StaticMesh"),
+        TEXT("SkeletalMesh"),
+        TEXT("Blueprint"),
+        TEXT("NiagaraSystem"),
+        TEXT("AnimSequence"),
+        TEXT("Material"),
+        TEXT("MaterialInstance"),
+        TEXT("MaterialInstanceConstant")
+    };
+
+    auto AddClassesForToken = [&AllowedClasses](const FString& Token, TSet<FName>& OutSet)
+    {
+        const FString Lower = Token.ToLower();
+        if (Lower == TEXT("animation") || Lower == TEXT("anim") || Lower == TEXT("animsequence"))
+        {
+            OutSet.Add(TEXT("AnimSequence"));
+        }
+        else if (Lower == TEXT("mesh") || Lower == TEXT("meshes"))
+        {
+            OutSet.Add(TEXT("StaticMesh"));
+            OutSet.Add(TEXT("SkeletalMesh"));
+        }
+        else if (Lower == TEXT("staticmesh"))
+        {
+            OutSet.Add(TEXT("StaticMesh"));
+        }
+        else if (Lower == TEXT("skeletalmesh"))
+        {
+            OutSet.Add(TEXT("SkeletalMesh"));
+        }
+        else if (Lower == TEXT("material") || Lower == TEXT("materials") || Lower == TEXT("mat"))
+        {
+            OutSet.Add(TEXT("Material"));
+            OutSet.Add(TEXT("MaterialInstance"));
+            OutSet.Add(TEXT("MaterialInstanceConstant"));
+        }
+        else if (Lower == TEXT("materialinstance") || Lower == TEXT("materialinstanceconstant"))
+        {
+            OutSet.Add(TEXT("MaterialInstance"));
+            OutSet.Add(TEXT("MaterialInstanceConstant"));
+        }
+        else if (Lower == TEXT("blueprint") || Lower == TEXT("bp"))
+        {
+            OutSet.Add(TEXT("Blueprint"));
+        }
+        else if (Lower == TEXT("niagara") || Lower == TEXT("niagarasystem"))
+        {
+            OutSet.Add(TEXT("NiagaraSystem"));
+        }
+        else
+        {
+            // Allow explicit class names like "StaticMesh"
+            OutSet.Add(FName(*Token));
+        }
+
+    };
+
+    FString FilterRaw = InTypeFilter;
+    FString ExcludeRaw = InExcludeTypeFilter;
+    const bool bHasCliInclude = !FilterRaw.TrimStartAndEnd().IsEmpty();
+    FString ServerIncludeRaw;
+    FString ServerExcludeRaw;
+    bool bGotServerFilters = false;
+    bool bUsedCache = false;
+    if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
+    {
+        if (!Settings->ImportBaseUrl.IsEmpty())
+        {
+            const bool bOk = AssetSnapshot::GetServerExportFilters(Settings->ImportBaseUrl, ServerIncludeRaw, ServerExcludeRaw);
+            GAssetSnapshotServerChecked = true;
+            GAssetSnapshotServerAvailable = bOk;
+            if (bOk)
+            {
+                bGotServerFilters = true;
+                if (!ServerIncludeRaw.IsEmpty() && !bHasCliInclude)
+                {
+                    FilterRaw = ServerIncludeRaw;
+                }
+
+                if (!ServerExcludeRaw.IsEmpty())
+                {
+                    if (ExcludeRaw.IsEmpty())
+                    {
+                        ExcludeRaw = ServerExcludeRaw;
+                    }
+                    else
+                    {
+                        ExcludeRaw = ExcludeRaw + TEXT(",") + ServerExcludeRaw;
+                    }
+                }
+            }
+            else if (!GAssetSnapshotServerWarned)
+            {
+                UE_LOG(LogAssetSnapshot, Warning, TEXT("Export filters: server settings unavailable (baseUrl='%s')"), *Settings->ImportBaseUrl);
+                GAssetSnapshotServerWarned = true;
+            }
+        }
+    }
+    UE_LOG(LogAssetSnapshot, Log, TEXT("Export filters: include='%s' exclude='%s' (server=%s)"),
+        *FilterRaw,
+        *ExcludeRaw,
+        bGotServerFilters ? TEXT("yes") : (bUsedCache ? TEXT("cache") : TEXT("no")));
+    FilterRaw.TrimStartAndEndInline();
+    auto ParseTokens = [](const FString& Raw, TArray<FString>& OutTokens)
+    {
+        FString Temp = Raw;
+        Temp.ReplaceInline(TEXT(";"), TEXT(","));
+        Temp.ReplaceInline(TEXT("|"), TEXT(","));
+        Temp.ReplaceInline(TEXT(" "), TEXT(","));
+        Temp.ParseIntoArray(OutTokens, TEXT(","), true);
+    };
+
+    TSet<FName> FilterClasses;
+    const bool bHasFilter = !FilterRaw.IsEmpty();
+    if (bHasFilter)
+    {
+        TArray<FString> Tokens;
+        ParseTokens(FilterRaw, Tokens);
+        for (FString T : Tokens)
+        {
+            T.TrimStartAndEndInline();
+            if (T.IsEmpty())
+            {
+                continue;
+            }
+            AddClassesForToken(T, FilterClasses);
+        }
+
+        if (bHasCliInclude && !ServerIncludeRaw.IsEmpty())
+        {
+            TSet<FName> ServerIncludeClasses;
+            TArray<FString> ServerTokens;
+            ParseTokens(ServerIncludeRaw, ServerTokens);
+            for (FString T : ServerTokens)
+            {
+                T.TrimStartAndEndInline();
+                if (T.IsEmpty())
+                {
+                    continue;
+                }
+                AddClassesForToken(T, ServerIncludeClasses);
+            }
+            if (ServerIncludeClasses.Num() > 0)
+            {
+                FilterClasses = FilterClasses.Intersect(ServerIncludeClasses);
+            }
+        }
+
+        // Keep only classes we can export.
+        FilterClasses = FilterClasses.Intersect(AllowedClasses);
+        if (FilterClasses.Num() == 0)
+        {
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Type filter did not match any exportable classes: %s"), *FilterRaw);
+            return 0;
+        }
+    }
+
+    ExcludeRaw.TrimStartAndEndInline();
+    TSet<FName> ExcludeClasses;
+    const bool bHasExclude = !ExcludeRaw.IsEmpty();
+    if (bHasExclude)
+    {
+        TArray<FString> Tokens;
+        ParseTokens(ExcludeRaw, Tokens);
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Exclude tokens: %s"), *FString::Join(Tokens, TEXT("|")));
+        for (FString T : Tokens)
+        {
+            T.TrimStartAndEndInline();
+            if (T.IsEmpty())
             {
                 continue;
             }
-
-            FZipEntry Frame;
-            Frame.NameInZip = FString::Printf(TEXT("%d.webp"), i);
-            Frame.Data = MoveTemp(WebP);
-            OutFrames.Add(MoveTemp(Frame));
+            AddClassesForToken(T, ExcludeClasses);
         }
-
-        return OutFrames.Num() > 0;
+        ExcludeClasses = ExcludeClasses.Intersect(AllowedClasses);
+        if (bHasFilter)
+        {
+            ExcludeClasses = ExcludeClasses.Difference(FilterClasses);
+        }
+        TArray<FString> ExcludeNames;
+        ExcludeNames.Reserve(ExcludeClasses.Num());
+        for (const FName& Name : ExcludeClasses)
+        {
+            ExcludeNames.Add(Name.ToString());
+        }
+        ExcludeNames.Sort();
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Export exclude classes: %s"), *FString::Join(ExcludeNames, TEXT(",")));
     }
 
-    static TSharedPtr<FJsonObject> MeshStatsToJson(const FMeshStats& S)
+    TArray<FAssetData> Filtered;
+    Filtered.Reserve(Assets.Num());
+    int32 LoggedExcludeChecks = 0;
+    for (const FAssetData& AD : Assets)
     {
-        TSharedPtr<FJsonObject> J = MakeShared<FJsonObject>();
-        J->SetNumberField(TEXT("triangles"), (double)S.Triangles);
-        J->SetNumberField(TEXT("polygons"), (double)S.Triangles);
-        J->SetNumberField(TEXT("vertices"), (double)S.Vertices);
-        J->SetNumberField(TEXT("lods"), (double)S.LODs);
-        J->SetBoolField(TEXT("nanite_enabled"), S.bNaniteEnabled);
-        J->SetStringField(TEXT("collision_complexity"), S.CollisionComplexity);
-
-        TSharedPtr<FJsonObject> Size = MakeShared<FJsonObject>();
-        Size->SetNumberField(TEXT("x"), S.ApproxSize.X);
-        Size->SetNumberField(TEXT("y"), S.ApproxSize.Y);
-        Size->SetNumberField(TEXT("z"), S.ApproxSize.Z);
-        J->SetObjectField(TEXT("approx_size_cm"), Size);
-        J->SetNumberField(TEXT("approx_size_max_cm"), (double)FMath::Max3(S.ApproxSize.X, S.ApproxSize.Y, S.ApproxSize.Z));
-        return J;
+        const FName ClassName = AD.AssetClassPath.GetAssetName();
+        if (bHasExclude
+            && (ClassName == TEXT("Material") || ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
+            && LoggedExcludeChecks < 10)
+        {
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Exclude check: class=%s excluded=%s raw='%s'"),
+                *ClassName.ToString(),
+                ExcludeClasses.Contains(ClassName) ? TEXT("yes") : TEXT("no"),
+                *ExcludeRaw);
+            ++LoggedExcludeChecks;
+        }
+        if (AllowedClasses.Contains(ClassName)
+            && (!bHasFilter || FilterClasses.Contains(ClassName))
+            && (!bHasExclude || !ExcludeClasses.Contains(ClassName)))
+        {
+            Filtered.Add(AD);
+        }
     }
 
-    static FString SerializeJson(const TSharedRef<FJsonObject>& Root)
+    if (Filtered.Num() == 0)
     {
-        FString Out;
-        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Out);
-        FJsonSerializer::Serialize(Root, Writer);
-        return Out;
+        UE_LOG(LogAssetSnapshot, Warning, TEXT("No matching asset types to export for: %s"), *Path);
+        return 0;
     }
-}
 
-FString UAssetSnapshotBPLibrary::GetDefaultExportRoot()
-{
-    return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() / TEXT("export"));
-}
+    auto GetSortKey = [](const FAssetData& AD)
+    {
+        const FName ClassName = AD.AssetClassPath.GetAssetName();
+        if (ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
+        {
+            return 0;
+        }
+        if (ClassName == TEXT("Material"))
+        {
+            return 1;
+        }
+        if (ClassName == TEXT("AnimSequence"))
+        {
+            return 2;
+        }
+        if (ClassName == TEXT("StaticMesh") || ClassName == TEXT("SkeletalMesh"))
+        {
+            return 3;
+        }
+        if (ClassName == TEXT("Blueprint"))
+        {
+            return 4;
+        }
+        if (ClassName == TEXT("NiagaraSystem"))
+        {
+            return 5;
+        }
+        return 5;
+    };
 
-int32 UAssetSnapshotBPLibrary::ExportPathBuilds(const FString& InGamePath, const FString& InTypeFilter, const FString& InExcludeTypeFilter)
-{
-    ++GAssetSnapshotExportBatchId;
-    GAssetSnapshotServerBatchId = GAssetSnapshotExportBatchId;
-    GAssetSnapshotServerChecked = false;
-    GAssetSnapshotServerAvailable = true;
-    GAssetSnapshotServerWarned = false;
-    GAssetSnapshotServerSkipKnown = false;
-    GAssetSnapshotServerSkipEnabled = true;
-    FString Path = InGamePath;
-    Path.TrimStartAndEndInline();
+    Filtered.Sort([&](const FAssetData& A, const FAssetData& B)
+    {
+        const int32 KeyA = GetSortKey(A);
+        const int32 KeyB = GetSortKey(B);
+        if (KeyA != KeyB)
+        {
+            return KeyA < KeyB;
+        }
+        return A.ObjectPath.ToString() < B.ObjectPath.ToString();
+    });
 
-    if (Path.IsEmpty())
+    // Static shard: a stable, size-balanced subset of the sorted list.
+    const int32 ShardCount = FMath::Max(1, Options.ShardCount);
+    const int32 ShardIndex = FMath::Clamp(Options.ShardIndex, 0, ShardCount - 1);
+    const int32 BatchTotal = Filtered.Num();
+    TArray<int32> GlobalIndices;
+    if (ShardCount > 1)
     {
-        UE_LOG(LogAssetSnapshot, Error, TEXT("ExportPathBuilds: empty path"));
-        return 0;
+        int64 ShardBytes = 0;
+        int64 TotalBytes = 0;
+        AssetSnapshot::SelectShard(Filtered, ShardIndex, ShardCount, GlobalIndices, ShardBytes, TotalBytes);
+        TArray<FAssetData> ShardAssets;
+        ShardAssets.Reserve(GlobalIndices.Num());
+        for (const int32 Index : GlobalIndices)
+        {
+            ShardAssets.Add(Filtered[Index]);
+        }
+        Filtered = MoveTemp(ShardAssets);
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Shard %d/%d: %d of %d asset(s), %lld of %lld bytes on disk"),
+            ShardIndex, ShardCount, Filtered.Num(), BatchTotal, ShardBytes, TotalBytes);
     }
-
-    FAssetRegistryModule& ARM = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-    IAssetRegistry& AR = ARM.Get();
-
-    TArray<FAssetData> Assets;
-
-    if (Path.Contains(TEXT(".")))
+    else
     {
-        const FSoftObjectPath SOP(Path);
-		const FAssetData AD = AR.GetAssetByObjectPath(SOP);
-        if (AD.IsValid())
+        GlobalIndices.Reserve(Filtered.Num());
+        for (int32 i = 0; i < Filtered.Num(); ++i)
         {
-            Assets.Add(AD);
+            GlobalIndices.Add(i);
         }
     }
 
-    if (Assets.Num() == 0)
+    bool bHasMaterials = false;
+    for (const FAssetData& AD : Filtered)
     {
-        // Directory path?
-        if (Path.StartsWith(TEXT("/Game")))
+        const FName ClassName = AD.AssetClassPath.GetAssetName();
+        if (ClassName == TEXT("Material") || ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
         {
-            AR.GetAssetsByPath(FName(*Path), Assets, true);
+            bHasMaterials = true;
+            break;
         }
     }
 
-    if (Assets.Num() == 0)
+    AssetSnapshot::FMaterialCaptureContext MaterialCtx;
+    if (bHasMaterials && !Options.bMetadataOnly && !Options.bCoordinator)
     {
-        // Maybe a package path without .ObjectName
-        if (Path.StartsWith(TEXT("/Game")) && !Path.Contains(TEXT(".")))
+        if (AssetSnapshot::InitMaterialCaptureContext(MaterialCtx))
         {
-            const FString AssetName = FPackageName::GetLongPackageAssetName(Path);
-            const FString ObjPath = Path + TEXT(".") + AssetName;
-            const FSoftObjectPath SOP(ObjPath);
-			const FAssetData AD = AR.GetAssetByObjectPath(SOP);
-            if (AD.IsValid())
-            {
-                Assets.Add(AD);
-            }
+            AssetSnapshot::GMaterialCaptureContext = &MaterialCtx;
+        }
+        else
+        {
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Failed to initialize shared material capture context; falling back to per-asset scenes."));
         }
     }
 
-    if (Assets.Num() == 0)
+    // Mesh, blueprint, Niagara and animation captures reuse one lit stage per kind,
+    // all captures one rig (scene captures, render targets, readback buffer).
+    AssetSnapshot::FScopedCaptureRig CaptureRig;
+    AssetSnapshot::FCaptureStagePool StagePool;
+    if (!Options.bMetadataOnly && !Options.bCoordinator)
     {
-        UE_LOG(LogAssetSnapshot, Error, TEXT("No assets found for: %s"), *Path);
-        return 0;
+        AssetSnapshot::GCaptureStagePool = &StagePool;
     }
 
-    const TSet<FName> AllowedClasses = {
-        TEXT("StaticMesh"),
-        TEXT("SkeletalMesh"),
-        TEXT("Blueprint"),
-        TEXT("NiagaraSystem"),
-        TEXT("AnimSequence"),
-        TEXT("Material"),
-        TEXT("MaterialInstance"),
-        TEXT("MaterialInstanceConstant")
-    };
-
-    auto AddClassesForToken = [&AllowedClasses](const FString& Token, TSet<FName>& OutSet)
+    // Checkpoint journal: one record per finished asset so an interrupted batch can resume.
+    TArray<FString> IncludeKeyNames;
+    for (const FName& Name : FilterClasses)
     {
-        const FString Lower = Token.ToLower();
-        if (Lower == TEXT("animation") || Lower == TEXT("anim") || Lower == TEXT("animsequence"))
-        {
-            OutSet.Add(TEXT("AnimSequence"));
-        }
-        else if (Lower == TEXT("mesh") || Lower == TEXT("meshes"))
-        {
-            OutSet.Add(TEXT("StaticMesh"));
-            OutSet.Add(TEXT("SkeletalMesh"));
-        }
-        else if (Lower == TEXT("staticmesh"))
-        {
-            OutSet.Add(TEXT("StaticMesh"));
-        }
-        else if (Lower == TEXT("skeletalmesh"))
+        IncludeKeyNames.Add(Name.ToString());
+    }
+    IncludeKeyNames.Sort();
+    TArray<FString> ExcludeKeyNames;
+    for (const FName& Name : ExcludeClasses)
+    {
+        ExcludeKeyNames.Add(Name.ToString());
+    }
+    ExcludeKeyNames.Sort();
+
+    const FString BatchKey = AssetSnapshot::MakeBatchKey(Path, IncludeKeyNames, ExcludeKeyNames, Options.bMetadataOnly);
+    const FString ShardSuffix = AssetSnapshot::GetShardSuffix(ShardIndex, ShardCount);
+    AssetSnapshot::FBatchJournal Journal;
+    Journal.Path = GetDefaultExportRoot() / TEXT("_journal") / (BatchKey + ShardSuffix + TEXT(".jsonl"));
+    bool bResuming = false;
+    if (Options.bResume)
+    {
+        bResuming = AssetSnapshot::LoadBatchJournal(Journal, Filtered);
+        if (bResuming)
         {
-            OutSet.Add(TEXT("SkeletalMesh"));
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Resuming batch from %s (%d asset(s) already done, last index %d)"),
+                *Journal.Path, Journal.FinishedRecords.Num(), Journal.LastFinishedIndex);
         }
-        else if (Lower == TEXT("material") || Lower == TEXT("materials") || Lower == TEXT("mat"))
+        else
         {
-            OutSet.Add(TEXT("Material"));
-            OutSet.Add(TEXT("MaterialInstance"));
-            OutSet.Add(TEXT("MaterialInstanceConstant"));
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Resume requested but no matching journal at %s; starting a new batch."), *Journal.Path);
         }
-        else if (Lower == TEXT("materialinstance") || Lower == TEXT("materialinstanceconstant"))
+    }
+    if (!bResuming)
+    {
+        Journal.FinishedRecords.Reset();
+        IFileManager::Get().Delete(*Journal.Path, false, true, true);
+        AssetSnapshot::AppendJsonLine(Journal.Path, AssetSnapshot::MakeBatchJournalHeader(Path, IncludeKeyNames, ExcludeKeyNames, Filtered));
+    }
+    Summary.JournalPath = Journal.Path;
+    Summary.BatchKey = BatchKey;
+
+    int32 Exported = 0;
+    const int32 Total = Filtered.Num();
+    const double BatchStartSec = FPlatformTime::Seconds();
+    AssetSnapshot::FBatchGCPolicy GCPolicy;
+    GCPolicy.Init();
+    Summary.Total = Total;
+
+    // Skip/export decisions are made lazily per index so the prefetcher can look
+    // ahead for the next capturable assets without loading skipped ones.
+    TArray<AssetSnapshot::FAssetExportPlan> Plans;
+    TArray<AssetSnapshot::FAssetExportResult> PlanResults;
+    TArray<uint8> PlanState; // 0 = undecided, 1 = export, 2 = no load needed
+    Plans.SetNum(Total);
+    PlanResults.SetNum(Total);
+    PlanState.Init(0, Total);
+
+    // Failed assets are retried on resume; everything else is final.
+    auto IsDoneInJournal = [&](int32 Index)
+    {
+        const TSharedPtr<FJsonObject>* Prev = Journal.FinishedRecords.Find(Filtered[Index].GetObjectPathString());
+        FString PrevStatus;
+        return Prev && (*Prev)->TryGetStringField(TEXT("status"), PrevStatus)
+            && PrevStatus != AssetSnapshot::AssetExportStatusToString(AssetSnapshot::EAssetExportStatus::Failed);
+    };
+    auto EnsurePlanned = [&](int32 Index)
+    {
+        if (PlanState[Index] == 0)
         {
-            OutSet.Add(TEXT("MaterialInstance"));
-            OutSet.Add(TEXT("MaterialInstanceConstant"));
+            const bool bExport = AssetSnapshot::PlanAssetExport(Filtered[Index].PackageName.ToString(), Plans[Index], PlanResults[Index], Options.bMetadataOnly);
+            PlanState[Index] = bExport ? 1 : 2;
         }
-        else if (Lower == TEXT("blueprint") || Lower == TEXT("bp"))
+        return PlanState[Index] == 1;
+    };
+
+    AssetSnapshot::FShaderPrecompile Precompile;
+    TBitArray<> Processed(false, Total);
+
+    // Server hash checks of the next undecided assets run while the current one
+    // is planned and captured; EnsurePlanned then mostly finds the answer waiting.
+    int32 ServerCheckCursor = 0;
+    auto StartServerChecksAhead = [&](int32 From)
+    {
+        ServerCheckCursor = FMath::Max(ServerCheckCursor, From);
+        while (ServerCheckCursor < Total && AssetSnapshot::CountServerHashChecksInFlight() < AssetSnapshot::kServerHashCheckMaxAhead)
         {
-            OutSet.Add(TEXT("Blueprint"));
+            const int32 j = ServerCheckCursor++;
+            if (PlanState[j] == 0 && !Processed[j] && !IsDoneInJournal(j))
+            {
+                AssetSnapshot::BeginPlanServerCheck(Filtered[j].PackageName.ToString(), Options.bMetadataOnly);
+            }
         }
-        else if (Lower == TEXT("niagara") || Lower == TEXT("niagarasystem"))
+    };
+
+    AssetSnapshot::FPackagePrefetcher Prefetcher;
+    if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
+    {
+        Prefetcher.MaxAhead = FMath::Max(0, Settings->PrefetchAssetCount);
+        Prefetcher.BudgetBytes = (int64)FMath::Max(0, Settings->PrefetchMemoryBudgetMB) * 1024 * 1024;
+    }
+    AssetSnapshot::GPackagePrefetcher = &Prefetcher;
+    int32 PrefetchCursor = 0;
+    auto FillPrefetch = [&](int32 After)
+    {
+        PrefetchCursor = FMath::Max(PrefetchCursor, After + 1);
+        StartServerChecksAhead(PrefetchCursor);
+        // Loading ahead under memory pressure only makes the next GC bigger.
+        if (Prefetcher.MaxAhead > 0 && GCPolicy.IsUnderPressure())
         {
-            OutSet.Add(TEXT("NiagaraSystem"));
+            return;
         }
-        else
+        while (PrefetchCursor < Total && Prefetcher.MaxAhead > 0)
         {
-            // Allow explicit class names like "StaticMesh"
-            OutSet.Add(FName(*Token));
+            const int32 j = PrefetchCursor;
+            if (!IsDoneInJournal(j) && !Processed[j] && PlanState[j] == 0
+                && (AssetSnapshot::BeginPlanServerCheck(Filtered[j].PackageName.ToString(), Options.bMetadataOnly)
+                    || AssetSnapshot::CountServerHashChecksInFlight() >= AssetSnapshot::kServerHashCheckMaxAhead))
+            {
+                // Lookahead never blocks on the server; continue after the next asset.
+                break;
+            }
+            if (IsDoneInJournal(j) || Processed[j] || Precompile.IsPending(j) || !EnsurePlanned(j))
+            {
+                ++PrefetchCursor;
+                continue;
+            }
+            // On-disk size of the main package is the memory estimate.
+            const int64 EstimatedBytes = FMath::Max<int64>(0, IFileManager::Get().FileSize(*Plans[j].MainFileAbs));
+            if (!Prefetcher.CanRequest(EstimatedBytes))
+            {
+                break;
+            }
+            Prefetcher.Request(j, Filtered[j], EstimatedBytes);
+            ++PrefetchCursor;
         }
-
     };
 
-    FString FilterRaw = InTypeFilter;
-    FString ExcludeRaw = InExcludeTypeFilter;
-    const bool bHasCliInclude = !FilterRaw.TrimStartAndEnd().IsEmpty();
-    FString ServerIncludeRaw;
-    FString ServerExcludeRaw;
-    bool bGotServerFilters = false;
-    bool bUsedCache = false;
-    if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
+    TArray<TSharedPtr<FJsonObject>> ManifestRecords;
+    ManifestRecords.SetNum(Total);
+
+    // Shader precompile: materials the batch will capture are loaded through the
+    // prefetcher and their shader maps submitted as each load lands, with at most
+    // ShaderPrecompileMaxMaterials loading or compiling at once. The loop below
+    // then prefers whatever finished.
+    const UAssetSnapshotSettings* PrecompileSettings = GetDefault<UAssetSnapshotSettings>();
+    const int32 MaxPrecompile = (PrecompileSettings && bHasMaterials && !Options.bMetadataOnly && !Options.bCoordinator)
+        ? FMath::Max(0, PrecompileSettings->ShaderPrecompileMaxMaterials) : 0;
+    TArray<int32> PrecompileLoads;
+    int32 PrecompileCursor = 0;
+    auto FeedPrecompile = [&]()
     {
-        if (!Settings->ImportBaseUrl.IsEmpty())
+        if (MaxPrecompile <= 0)
         {
-            const bool bOk = AssetSnapshot::GetServerExportFilters(Settings->ImportBaseUrl, ServerIncludeRaw, ServerExcludeRaw);
-            GAssetSnapshotServerChecked = true;
-            GAssetSnapshotServerAvailable = bOk;
-            if (bOk)
+            return;
+        }
+        for (int32 k = PrecompileLoads.Num() - 1; k >= 0; --k)
+        {
+            const int32 j = PrecompileLoads[k];
+            UObject* Loaded = nullptr;
+            if (Processed[j])
             {
-                bGotServerFilters = true;
-                if (!ServerIncludeRaw.IsEmpty() && !bHasCliInclude)
-                {
-                    FilterRaw = ServerIncludeRaw;
-                }
+                // The loop got there first and acquired it itself.
+                PrecompileLoads.RemoveAtSwap(k);
+                continue;
+            }
+            if (!Prefetcher.TakeFinished(j, Loaded))
+            {
+                continue;
+            }
+            PrecompileLoads.RemoveAtSwap(k);
+            if (UMaterialInterface* Mat = Cast<UMaterialInterface>(Loaded))
+            {
+                GCPolicy.NoteLoaded();
+                Precompile.Submit(j, Mat);
+            }
+        }
 
-                if (!ServerExcludeRaw.IsEmpty())
-                {
-                    if (ExcludeRaw.IsEmpty())
-                    {
-                        ExcludeRaw = ServerExcludeRaw;
-                    }
-                    else
-                    {
-                        ExcludeRaw = ExcludeRaw + TEXT(",") + ServerExcludeRaw;
-                    }
-                }
+        if (GCPolicy.IsUnderPressure())
+        {
+            return;
+        }
+        while (PrecompileCursor < Total && Precompile.Pending.Num() + PrecompileLoads.Num() < MaxPrecompile)
+        {
+            const int32 j = PrecompileCursor;
+            const FName ClassName = Filtered[j].AssetClassPath.GetAssetName();
+            const bool bIsMaterial = ClassName == TEXT("Material") || ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant");
+            if (!bIsMaterial || Processed[j] || IsDoneInJournal(j) || PlanState[j] == 2 || Prefetcher.Requests.Contains(j))
+            {
+                ++PrecompileCursor;
+                continue;
             }
-            else if (!GAssetSnapshotServerWarned)
+            // Planning never waits on the server here; continue with this asset next time.
+            if (PlanState[j] == 0
+                && (AssetSnapshot::BeginPlanServerCheck(Filtered[j].PackageName.ToString(), Options.bMetadataOnly)
+                    || AssetSnapshot::CountServerHashChecksInFlight() >= AssetSnapshot::kServerHashCheckMaxAhead))
             {
-                UE_LOG(LogAssetSnapshot, Warning, TEXT("Export filters: server settings unavailable (baseUrl='%s')"), *Settings->ImportBaseUrl);
-                GAssetSnapshotServerWarned = true;
+                break;
+            }
+            if (!EnsurePlanned(j))
+            {
+                ++PrecompileCursor;
+                continue;
+            }
+            const int64 EstimatedBytes = FMath::Max<int64>(0, IFileManager::Get().FileSize(*Plans[j].MainFileAbs));
+            if (!Prefetcher.CanRequest(EstimatedBytes, MaxPrecompile))
+            {
+                break;
             }
+            Prefetcher.Request(j, Filtered[j], EstimatedBytes);
+            PrecompileLoads.Add(j);
+            ++PrecompileCursor;
         }
-    }
-    UE_LOG(LogAssetSnapshot, Log, TEXT("Export filters: include='%s' exclude='%s' (server=%s)"),
-        *FilterRaw,
-        *ExcludeRaw,
-        bGotServerFilters ? TEXT("yes") : (bUsedCache ? TEXT("cache") : TEXT("no")));
-    FilterRaw.TrimStartAndEndInline();
-    auto ParseTokens = [](const FString& Raw, TArray<FString>& OutTokens)
-    {
-        FString Temp = Raw;
-        Temp.ReplaceInline(TEXT(";"), TEXT(","));
-        Temp.ReplaceInline(TEXT("|"), TEXT(","));
-        Temp.ReplaceInline(TEXT(" "), TEXT(","));
-        Temp.ParseIntoArray(OutTokens, TEXT(","), true);
     };
 
-    TSet<FName> FilterClasses;
-    const bool bHasFilter = !FilterRaw.IsEmpty();
-    if (bHasFilter)
+    // Coordinator: workers capture, this process only hands out assets and records
+    // results. The queue is served from the core ticker; counting, the journal end
+    // record and the manifest follow once it is done.
+    if (Options.bCoordinator)
     {
-        TArray<FString> Tokens;
-        ParseTokens(FilterRaw, Tokens);
-        for (FString T : Tokens)
-        {
-            T.TrimStartAndEndInline();
-            if (T.IsEmpty())
+        AssetSnapshot::GPackagePrefetcher = nullptr;
+        TSharedRef<AssetSnapshot::FWorkCoordinator> Coordinator = MakeShared<AssetSnapshot::FWorkCoordinator>();
+        AssetSnapshot::FWorkQueue& WorkQueue = Coordinator->Queue;
+        WorkQueue.Assets = Filtered;
+        WorkQueue.Records.SetNum(Total);
+        WorkQueue.JournalPath = Journal.Path;
+        WorkQueue.bMetadataOnly = Options.bMetadataOnly;
+        for (int32 i = 0; i < Total; ++i)
+        {
+            if (IsDoneInJournal(i))
             {
                 continue;
             }
-            AddClassesForToken(T, FilterClasses);
+            AssetSnapshot::FWorkItem& Item = WorkQueue.Items.AddDefaulted_GetRef();
+            Item.LocalIndex = i;
+            Item.GlobalIndex = GlobalIndices[i];
+            Item.ClassName = Filtered[i].AssetClassPath.GetAssetName();
+            const double SizeMB = (double)AssetSnapshot::GetRegistryDiskSize(AR, Filtered[i].PackageName) / (1024.0 * 1024.0);
+            Item.SizeFactor = 1.0 + FMath::Loge(1.0 + SizeMB) * 0.25;
         }
+        WorkQueue.Remaining = WorkQueue.Items.Num();
 
-        if (bHasCliInclude && !ServerIncludeRaw.IsEmpty())
+        // Queued assets have a record once the queue is done; the others were taken from the journal.
+        auto FinishBatch = [Summary, Journal, Filtered, BatchKey, ShardSuffix, Path, IncludeKeyNames, ExcludeKeyNames, ShardIndex, ShardCount, BatchTotal, BatchStartSec](const AssetSnapshot::FWorkQueue& Queue)
         {
-            TSet<FName> ServerIncludeClasses;
-            TArray<FString> ServerTokens;
-            ParseTokens(ServerIncludeRaw, ServerTokens);
-            for (FString T : ServerTokens)
+            FAssetSnapshotExportSummary Final = Summary;
+            TArray<TSharedPtr<FJsonObject>> Records = Queue.Records;
+            for (int32 i = 0; i < Records.Num(); ++i)
             {
-                T.TrimStartAndEndInline();
-                if (T.IsEmpty())
+                if (!Records[i].IsValid())
                 {
+                    Records[i] = Journal.FinishedRecords.FindRef(Filtered[i].GetObjectPathString());
+                    ++Final.Resumed;
                     continue;
                 }
-                AddClassesForToken(T, ServerIncludeClasses);
+                FString Status;
+                Records[i]->TryGetStringField(TEXT("status"), Status);
+                if (Status == AssetSnapshot::AssetExportStatusToString(AssetSnapshot::EAssetExportStatus::Exported))
+                {
+                    ++Final.Exported;
+                }
+                else if (Status.IsEmpty() || Status == AssetSnapshot::AssetExportStatusToString(AssetSnapshot::EAssetExportStatus::Failed))
+                {
+                    ++Final.Failed;
+                }
+                else
+                {
+                    ++Final.Skipped;
+                }
             }
-            if (ServerIncludeClasses.Num() > 0)
+
+            AssetSnapshot::AppendJsonLine(Journal.Path, AssetSnapshot::MakeBatchEndRecord(Final, FPlatformTime::Seconds() - BatchStartSec));
+            const FString ManifestPath = AssetSnapshot::GetManifestDir() / (BatchKey + ShardSuffix + TEXT(".json"));
+            if (AssetSnapshot::WriteBatchManifest(ManifestPath, BatchKey, Path, IncludeKeyNames, ExcludeKeyNames, ShardIndex, ShardCount, BatchTotal, Records))
             {
-                FilterClasses = FilterClasses.Intersect(ServerIncludeClasses);
+                Final.ManifestPath = ManifestPath;
+                UE_LOG(LogAssetSnapshot, Log, TEXT("Batch manifest: %s"), *ManifestPath);
+            }
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Work queue done. Exported: %d/%d skipped=%d failed=%d resumed=%d"),
+                Final.Exported, Final.Total, Final.Skipped, Final.Failed, Final.Resumed);
+            return Final;
+        };
+
+        if (WorkQueue.Remaining == 0)
+        {
+            Summary = FinishBatch(WorkQueue);
+            if (Options.OnCoordinatorFinished)
+            {
+                Options.OnCoordinatorFinished(Summary);
             }
+            return Summary.Exported;
         }
 
-        // Keep only classes we can export.
-        FilterClasses = FilterClasses.Intersect(AllowedClasses);
-        if (FilterClasses.Num() == 0)
+        int32 Port = Options.CoordinatorPort;
+        if (Port <= 0)
         {
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("Type filter did not match any exportable classes: %s"), *FilterRaw);
-            return 0;
+            const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+            Port = Settings ? Settings->ImportListenPort : 0;
         }
+        Coordinator->OnFinished = [FinishBatch, OnDone = Options.OnCoordinatorFinished](const AssetSnapshot::FWorkQueue& Queue)
+        {
+            const FAssetSnapshotExportSummary Final = FinishBatch(Queue);
+            if (OnDone)
+            {
+                OnDone(Final);
+            }
+        };
+        AssetSnapshot::StartWorkCoordinator(Coordinator, Port);
+        return 0;
     }
 
-    ExcludeRaw.TrimStartAndEndInline();
-    TSet<FName> ExcludeClasses;
-    const bool bHasExclude = !ExcludeRaw.IsEmpty();
-    if (bHasExclude)
+    // Material atlas: static materials already waiting with ready shaders are
+    // staged together with the one about to be exported; each keeps its frame
+    // until its own turn comes.
+    auto CaptureMaterialAtlasWith = [&](int32 Index, UObject* Obj)
     {
-        TArray<FString> Tokens;
-        ParseTokens(ExcludeRaw, Tokens);
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Exclude tokens: %s"), *FString::Join(Tokens, TEXT("|")));
-        for (FString T : Tokens)
+        UMaterialInterface* Mat = Cast<UMaterialInterface>(Obj);
+        const int32 Capacity = AssetSnapshot::GMaterialCaptureContext
+            ? AssetSnapshot::GetMaterialAtlasCapacity(*AssetSnapshot::GMaterialCaptureContext, AssetSnapshot::kTexturePreviewResolution) : 1;
+        if (!Mat || Capacity < 2
+            || AssetSnapshot::HasMaterialAtlasFrame(Mat) || AssetSnapshot::IsMaterialTimeDependent(Mat))
         {
-            T.TrimStartAndEndInline();
-            if (T.IsEmpty())
+            return;
+        }
+        TArray<int32> Candidates;
+        Precompile.Pending.GenerateKeyArray(Candidates);
+        Candidates.Sort();
+        TArray<UMaterialInterface*> Group;
+        Group.Add(Mat);
+        for (const int32 j : Candidates)
+        {
+            if (Group.Num() >= Capacity)
+            {
+                break;
+            }
+            if (j == Index || Processed[j] || IsDoneInJournal(j) || !Precompile.IsReady(j) || !EnsurePlanned(j))
             {
                 continue;
             }
-            AddClassesForToken(T, ExcludeClasses);
+            UMaterialInterface* Other = Precompile.Pending[j].Get();
+            if (Other && !AssetSnapshot::HasMaterialAtlasFrame(Other) && !AssetSnapshot::IsMaterialTimeDependent(Other))
+            {
+                Group.Add(Other);
+            }
         }
-        ExcludeClasses = ExcludeClasses.Intersect(AllowedClasses);
-        if (bHasFilter)
+        if (Group.Num() > 1)
         {
-            ExcludeClasses = ExcludeClasses.Difference(FilterClasses);
+            AssetSnapshot::CaptureMaterialAtlas(*AssetSnapshot::GMaterialCaptureContext, Group, AssetSnapshot::kTexturePreviewResolution);
         }
-        TArray<FString> ExcludeNames;
-        ExcludeNames.Reserve(ExcludeClasses.Num());
-        for (const FName& Name : ExcludeClasses)
+    };
+
+    // Index order, except that precompiled materials are taken as soon as their
+    // shaders are done and passed over while they are still compiling. Instances
+    // sharing the shaders of the instance just captured go first so they reuse its
+    // warmed-up sphere.
+    int32 NextSequential = 0;
+    TWeakObjectPtr<UMaterialInterface> LastInstance;
+    auto PickNext = [&](bool& bOutSequential)
+    {
+        bOutSequential = false;
+        if (Precompile.Pending.Num() > 0)
         {
-            ExcludeNames.Add(Name.ToString());
+            const int32 Sibling = Precompile.FindReadySibling(LastInstance.Get());
+            if (Sibling != INDEX_NONE)
+            {
+                return Sibling;
+            }
+            const int32 Ready = Precompile.FindReady();
+            if (Ready != INDEX_NONE)
+            {
+                return Ready;
+            }
         }
-        ExcludeNames.Sort();
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Export exclude classes: %s"), *FString::Join(ExcludeNames, TEXT(",")));
-    }
+        while (NextSequential < Total && (Processed[NextSequential] || Precompile.IsPending(NextSequential)))
+        {
+            ++NextSequential;
+        }
+        if (NextSequential < Total)
+        {
+            bOutSequential = true;
+            return NextSequential;
+        }
+        return Precompile.FindFirstPending();
+    };
 
-    TArray<FAssetData> Filtered;
-    Filtered.Reserve(Assets.Num());
-    int32 LoggedExcludeChecks = 0;
-    for (const FAssetData& AD : Assets)
+    auto RecordResult = [&](int32 Index, const AssetSnapshot::FAssetExportResult& Result, double LoadSeconds, double ExportSeconds)
     {
-        const FName ClassName = AD.AssetClassPath.GetAssetName();
-        if (bHasExclude
-            && (ClassName == TEXT("Material") || ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
-            && LoggedExcludeChecks < 10)
+        switch (Result.Status)
         {
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Exclude check: class=%s excluded=%s raw='%s'"),
-                *ClassName.ToString(),
-                ExcludeClasses.Contains(ClassName) ? TEXT("yes") : TEXT("no"),
-                *ExcludeRaw);
-            ++LoggedExcludeChecks;
+        case AssetSnapshot::EAssetExportStatus::Exported: ++Exported; break;
+        case AssetSnapshot::EAssetExportStatus::Failed: ++Summary.Failed; break;
+        default: ++Summary.Skipped; break;
         }
-        if (AllowedClasses.Contains(ClassName)
-            && (!bHasFilter || FilterClasses.Contains(ClassName))
-            && (!bHasExclude || !ExcludeClasses.Contains(ClassName)))
+        ManifestRecords[Index] = AssetSnapshot::AppendBatchJournalAsset(Journal, GlobalIndices[Index], Filtered[Index], Result, LoadSeconds, ExportSeconds);
+    };
+
+    // The previous asset's zip is written only once the next one has been captured,
+    // so its encodes run meanwhile; its record is journaled then.
+    struct FInFlightWrite
+    {
+        int32 Index = INDEX_NONE;
+        AssetSnapshot::FAssetExportResult Result;
+        double LoadSeconds = 0.0;
+        double ExportSeconds = 0.0;
+        AssetSnapshot::FPendingAssetWrite Write;
+    };
+    FInFlightWrite InFlight;
+    auto FinishInFlight = [&]()
+    {
+        if (!InFlight.Write.IsSet())
         {
-            Filtered.Add(AD);
+            return;
         }
-    }
+        const double WriteStartSec = FPlatformTime::Seconds();
+        AssetSnapshot::FinishAssetWrite(InFlight.Write, InFlight.Result);
+        RecordResult(InFlight.Index, InFlight.Result, InFlight.LoadSeconds, InFlight.ExportSeconds + (FPlatformTime::Seconds() - WriteStartSec));
+        InFlight = FInFlightWrite();
+    };
 
-    if (Filtered.Num() == 0)
+    GAssetSnapshotExportTotal = Total;
+    for (int32 Step = 0; Step < Total; ++Step)
     {
-        UE_LOG(LogAssetSnapshot, Warning, TEXT("No matching asset types to export for: %s"), *Path);
-        return 0;
-    }
+        FeedPrecompile();
+        bool bSequential = false;
+        const int32 i = PickNext(bSequential);
+        if (i == INDEX_NONE)
+        {
+            break;
+        }
+        Processed[i] = true;
+        LastInstance.Reset();
+        GAssetSnapshotExportCurrent = Step + 1;
+        const int32 Pct = FMath::RoundToInt(((float)(Step + 1) / (float)Total) * 100.0f);
 
-    auto GetSortKey = [](const FAssetData& AD)
-    {
-        const FName ClassName = AD.AssetClassPath.GetAssetName();
-        if (ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
+        if (IsDoneInJournal(i))
         {
-            return 0;
+            ManifestRecords[i] = Journal.FinishedRecords.FindRef(Filtered[i].GetObjectPathString());
+            ++Summary.Resumed;
+            continue;
         }
-        if (ClassName == TEXT("Material"))
+
+        UE_LOG(LogAssetSnapshot, Log, TEXT("[%d/%d] (%d%%) Exporting %s"), Step + 1, Total, Pct, *Filtered[i].ObjectPath.ToString());
+
+        // Decide skip/export from the package file and caches first; only assets
+        // that will actually be captured get loaded.
+        StartServerChecksAhead(i + 1);
+        const bool bExport = EnsurePlanned(i);
+        AssetSnapshot::FAssetExportResult Result = PlanResults[i];
+        AssetSnapshot::FPendingAssetWrite Write;
+        double LoadSeconds = 0.0;
+        double ExportSeconds = 0.0;
+        if (bExport)
         {
-            return 1;
+            // Precompiled materials were loaded (and counted) by FeedPrecompile.
+            const double LoadStartSec = FPlatformTime::Seconds();
+            UObject* Obj = Precompile.IsPending(i) ? Precompile.Pending[i].Get() : nullptr;
+            if (!Obj)
+            {
+                Obj = Prefetcher.Acquire(i, Filtered[i]);
+                GCPolicy.NoteLoaded();
+            }
+            LoadSeconds = FPlatformTime::Seconds() - LoadStartSec;
+
+            // Next packages load while this one is captured.
+            if (bSequential)
+            {
+                FillPrefetch(i);
+            }
+
+            if (!Obj)
+            {
+                Result.Finish(AssetSnapshot::EAssetExportStatus::Failed);
+            }
+            else
+            {
+                const double ExportStartSec = FPlatformTime::Seconds();
+                CaptureMaterialAtlasWith(i, Obj);
+                AssetSnapshot::ExportPlannedAsset(Obj, Plans[i], Result, &Write);
+                LastInstance = Cast<UMaterialInstance>(Obj);
+                ExportSeconds = FPlatformTime::Seconds() - ExportStartSec;
+            }
         }
-        if (ClassName == TEXT("AnimSequence"))
+
+        FinishInFlight();
+        if (Write.IsSet())
         {
-            return 2;
+            InFlight.Index = i;
+            InFlight.Result = MoveTemp(Result);
+            InFlight.LoadSeconds = LoadSeconds;
+            InFlight.ExportSeconds = ExportSeconds;
+            InFlight.Write = MoveTemp(Write);
         }
-        if (ClassName == TEXT("StaticMesh") || ClassName == TEXT("SkeletalMesh"))
+        else
         {
-            return 3;
+            RecordResult(i, Result, LoadSeconds, ExportSeconds);
         }
-        if (ClassName == TEXT("Blueprint"))
+        if (Precompile.IsPending(i))
         {
-            return 4;
+            Precompile.Release(i);
+            if (Precompile.Consumed % 10 == 0 || Precompile.Pending.Num() == 0)
+            {
+                Precompile.LogProgress();
+            }
         }
-        if (ClassName == TEXT("NiagaraSystem"))
+
+        // Keep uploads flowing in the background while the batch runs.
+        AssetSnapshot::PumpOutbox();
+        FHttpModule::Get().GetHttpManager().Tick(0.0f);
+
+#if WITH_EDITOR
+        // Keep RAM in check when batch-exporting (skipped assets were never loaded)
+        GCPolicy.CollectIfNeeded();
+#endif
+    }
+
+    FinishInFlight();
+    Prefetcher.FlushAll();
+    AssetSnapshot::GPackagePrefetcher = nullptr;
+    AssetSnapshot::GMaterialCaptureContext = nullptr;
+    AssetSnapshot::GMaterialAtlasCells.Reset();
+    AssetSnapshot::GCaptureStagePool = nullptr;
+    GCPolicy.LogSummary();
+    GAssetSnapshotExportTotal = 0;
+    GAssetSnapshotExportCurrent = 0;
+
+    const int32 OutboxPending = AssetSnapshot::DrainOutbox(AssetSnapshot::kOutboxBatchDrainSeconds);
+    if (OutboxPending > 0)
+    {
+        UE_LOG(LogAssetSnapshot, Warning, TEXT("Upload outbox: %d entr(ies) still pending; they will be sent when the server is reachable."), OutboxPending);
+    }
+    Summary.Exported = Exported;
+    {
+        TSharedRef<FJsonObject> EndRecord = AssetSnapshot::MakeBatchEndRecord(Summary, FPlatformTime::Seconds() - BatchStartSec);
+        EndRecord->SetNumberField(TEXT("gc_count"), (double)GCPolicy.Collections);
+        EndRecord->SetNumberField(TEXT("gc_seconds"), GCPolicy.TotalSeconds);
+        AssetSnapshot::AppendJsonLine(Journal.Path, EndRecord);
+    }
+
+    const FString ManifestPath = AssetSnapshot::GetManifestDir() / (BatchKey + ShardSuffix + TEXT(".json"));
+    if (AssetSnapshot::WriteBatchManifest(ManifestPath, BatchKey, Path, IncludeKeyNames, ExcludeKeyNames, ShardIndex, ShardCount, BatchTotal, ManifestRecords))
+    {
+        Summary.ManifestPath = ManifestPath;
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Batch manifest: %s"), *ManifestPath);
+    }
+
+    UE_LOG(LogAssetSnapshot, Log, TEXT("Export done. Exported: %d/%d skipped=%d failed=%d resumed=%d (backend circuit: %s)"),
+        Exported, Total, Summary.Skipped, Summary.Failed, Summary.Resumed, *AssetSnapshot::DescribeBackendBreaker());
+    return Exported;
+}
+
+bool AssetSnapshot::GetServerHashCheckTarget(bool bMetadataOnly, FString& OutBaseUrl, FString& OutPathTemplate)
+{
+    // Metadata refreshes do not upload, so the server's copy does not matter.
+    const UAssetSnapshotSettings* Settings = bMetadataOnly ? nullptr : GetDefault<UAssetSnapshotSettings>();
+    if (!Settings || Settings->ImportBaseUrl.IsEmpty())
+    {
+        return false;
+    }
+
+    static int32 LastBatchId = -1;
+    static bool CachedUseServerCheck = false;
+
+    if (LastBatchId != GAssetSnapshotExportBatchId)
+    {
+        const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(Settings->ImportBaseUrl);
+        CachedUseServerCheck = Server.bAvailable ? Server.bSkipExportIfOnServer : false;
+        LastBatchId = GAssetSnapshotExportBatchId;
+
+        if (!Server.bAvailable && !GAssetSnapshotServerWarned)
         {
-            return 5;
+            UE_LOG(LogAssetSnapshot, Warning, TEXT("Export server check disabled: server settings unavailable (baseUrl='%s')"), *Settings->ImportBaseUrl);
+            GAssetSnapshotServerWarned = true;
         }
-        return 5;
-    };
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Export server check: use=%s (serverSetting=%s baseUrl='%s')"),
+            CachedUseServerCheck ? TEXT("true") : TEXT("false"),
+            Server.bAvailable ? (Server.bSkipExportIfOnServer ? TEXT("true") : TEXT("false")) : TEXT("unavailable"),
+            *Settings->ImportBaseUrl);
+    }
+
+    OutBaseUrl = Settings->ImportBaseUrl;
+    if (CachedUseServerCheck)
+    {
+        OutPathTemplate = AssetSnapshot::GetServerSettingsCached(Settings->ImportBaseUrl).ExportCheckPathTemplate;
+    }
+    else
+    {
+        // Fallback endpoint when the server did not enable the configured check.
+        OutPathTemplate = TEXT("/assets/exists?hash={hash}&hash_type=blake3");
+    }
+    return true;
+}
+
+bool AssetSnapshot::BeginPlanServerCheck(const FString& PackageName, bool bMetadataOnly)
+{
+    FString BaseUrl;
+    FString PathTemplate;
+    if (!PackageName.StartsWith(TEXT("/Game/")) || !AssetSnapshot::GetServerHashCheckTarget(bMetadataOnly, BaseUrl, PathTemplate))
+    {
+        return false;
+    }
+    FString MainFileAbs;
+    FString HashMain;
+    AssetSnapshot::PackageToMainFileAbs(PackageName, MainFileAbs);
+    if (!AssetSnapshot::Blake3HashFileCached(MainFileAbs, HashMain))
+    {
+        return false;
+    }
+    const TSharedPtr<AssetSnapshot::FServerHashCheck, ESPMode::ThreadSafe> Check = AssetSnapshot::BeginServerHashCheck(BaseUrl, PathTemplate, HashMain, true);
+    return Check.IsValid() && !Check->bDone.Load();
+}
 
-    Filtered.Sort([&](const FAssetData& A, const FAssetData& B)
+bool AssetSnapshot::PlanAssetExport(const FString& PackageName, AssetSnapshot::FAssetExportPlan& OutPlan, AssetSnapshot::FAssetExportResult& OutResult, bool bMetadataOnly)
+{
+    OutPlan.PackageName = PackageName;
+    OutPlan.bMetadataOnly = bMetadataOnly;
+    if (!PackageName.StartsWith(TEXT("/Game/")))
     {
-        const int32 KeyA = GetSortKey(A);
-        const int32 KeyB = GetSortKey(B);
-        if (KeyA != KeyB)
-        {
-            return KeyA < KeyB;
-        }
-        return A.ObjectPath.ToString() < B.ObjectPath.ToString();
-    });
+        UE_LOG(LogAssetSnapshot, Warning, TEXT("Skipping non-/Game asset: %s"), *PackageName);
+        // Final, not an error: journaled as skipped so --resume does not retry it.
+        OutResult.Finish(AssetSnapshot::EAssetExportStatus::Skipped);
+        return false;
+    }
 
-    bool bHasMaterials = false;
-    for (const FAssetData& AD : Filtered)
+    // The zip name and the server lookup only depend on the main package file,
+    // so this runs before the asset (and its textures/shaders) is loaded.
+    AssetSnapshot::PackageToMainFileAbs(PackageName, OutPlan.MainFileAbs);
+    if (!AssetSnapshot::Blake3HashFileCached(OutPlan.MainFileAbs, OutPlan.HashMain))
     {
-        const FName ClassName = AD.AssetClassPath.GetAssetName();
-        if (ClassName == TEXT("Material") || ClassName == TEXT("MaterialInstance") || ClassName == TEXT("MaterialInstanceConstant"))
-        {
-            bHasMaterials = true;
-            break;
-        }
+        UE_LOG(LogAssetSnapshot, Error, TEXT("Failed to hash main file: %s"), *OutPlan.MainFileAbs);
+        OutResult.Finish(AssetSnapshot::EAssetExportStatus::Failed);
+        return false;
     }
+    const FString& HashMain = OutPlan.HashMain;
+    OutResult.HashMain = HashMain;
 
-    AssetSnapshot::FMaterialCaptureContext MaterialCtx;
-    if (bHasMaterials)
+    FString CheckBaseUrl;
+    FString CheckPathTemplate;
+    if (AssetSnapshot::GetServerHashCheckTarget(bMetadataOnly, CheckBaseUrl, CheckPathTemplate))
     {
-        if (AssetSnapshot::InitMaterialCaptureContext(MaterialCtx))
-        {
-            AssetSnapshot::GMaterialCaptureContext = &MaterialCtx;
-        }
-        else
+        bool bExists = false;
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Checking server for hash %s"), *HashMain);
+        if (AssetSnapshot::CheckServerHasHashCached(CheckBaseUrl, CheckPathTemplate, HashMain, bExists) && bExists)
         {
-            UE_LOG(LogAssetSnapshot, Warning, TEXT("Failed to initialize shared material capture context; falling back to per-asset scenes."));
+            UE_LOG(LogAssetSnapshot, Log, TEXT("Server already has hash %s, skipping export."), *HashMain);
+            OutResult.Finish(AssetSnapshot::EAssetExportStatus::SkippedOnServer);
+            return false;
         }
     }
 
-    int32 Exported = 0;
-    const int32 Total = Filtered.Num();
-
-    GAssetSnapshotExportTotal = Total;
-    for (int32 i = 0; i < Total; ++i)
+    // Export target path (skip if already exported)
+    const auto GetExportSubdirFromGamePackage = [](const FString& GamePackageName) -> FString
     {
-        GAssetSnapshotExportCurrent = i + 1;
-        const int32 Pct = FMath::RoundToInt(((float)(i + 1) / (float)Total) * 100.0f);
-        UE_LOG(LogAssetSnapshot, Log, TEXT("[%d/%d] (%d%%) Exporting %s"), i + 1, Total, Pct, *Filtered[i].ObjectPath.ToString());
+        // "/Game/<Top>/..." -> "<Top>"
+        FString Tail = GamePackageName;
+        Tail.RemoveFromStart(TEXT("/Game/"));
 
-        UObject* Obj = Filtered[i].GetAsset();
-        if (!Obj)
+        TArray<FString> Parts;
+        Tail.ParseIntoArray(Parts, TEXT("/"), true);
+        if (Parts.Num() == 0)
         {
-            continue;
+            return Tail;
         }
 
-        if (ExportAssetBuild(Obj))
+        // If you keep vendor namespaces like /Game/byHans1/<Pack>/..., export under <Pack>.
+        if (Parts[0].Equals(TEXT("byHans1"), ESearchCase::IgnoreCase) && Parts.Num() > 1)
         {
-            ++Exported;
+            return Parts[1];
         }
 
-#if WITH_EDITOR
-        // Keep RAM in check when batch-exporting
-        if ((i % 10) == 9)
+        return Parts[0];
+    };
+
+    const FString ExportSubdir = GetExportSubdirFromGamePackage(PackageName);
+    const FString ExportRoot = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() / TEXT("export") / ExportSubdir);
+    OutPlan.ZipPath = ExportRoot / (HashMain + (bMetadataOnly ? TEXT(".meta.json") : TEXT(".zip")));
+    OutResult.ZipPath = OutPlan.ZipPath;
+
+    if (IFileManager::Get().FileExists(*OutPlan.ZipPath))
+    {
+        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
+        const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(Settings ? Settings->ImportBaseUrl : FString());
+        if (!Server.bOverwriteExportZips)
         {
-            CollectGarbage(RF_NoFlags);
+            UE_LOG(LogAssetSnapshot, Log, TEXT("%s already exists, skipping: %s"), bMetadataOnly ? TEXT("Meta") : TEXT("Zip"), *OutPlan.ZipPath);
+            OutResult.Finish(AssetSnapshot::EAssetExportStatus::SkippedExisting);
+            return false;
         }
-#endif
+        OutPlan.bReplaceZip = true;
     }
 
-    AssetSnapshot::GMaterialCaptureContext = nullptr;
-    GAssetSnapshotExportTotal = 0;
-    GAssetSnapshotExportCurrent = 0;
-    UE_LOG(LogAssetSnapshot, Log, TEXT("Export done. Exported: %d/%d"), Exported, Total);
-    return Exported;
+    return true;
 }
 
-bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
+bool AssetSnapshot::ExportAssetBuildWithResult(UObject* Asset, AssetSnapshot::FAssetExportResult& OutResult)
 {
     if (!Asset)
     {
-        return false;
+        return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Failed);
     }
 
-    const FString PackageName = Asset->GetOutermost()->GetName();
-    if (!PackageName.StartsWith(TEXT("/Game/")))
+    AssetSnapshot::FAssetExportPlan Plan;
+    if (!AssetSnapshot::PlanAssetExport(Asset->GetOutermost()->GetName(), Plan, OutResult))
     {
-        UE_LOG(LogAssetSnapshot, Warning, TEXT("Skipping non-/Game asset: %s"), *PackageName);
         return false;
     }
+    return AssetSnapshot::ExportPlannedAsset(Asset, Plan, OutResult);
+}
+
+bool AssetSnapshot::ExportPlannedAsset(UObject* Asset, const AssetSnapshot::FAssetExportPlan& Plan, AssetSnapshot::FAssetExportResult& OutResult, AssetSnapshot::FPendingAssetWrite* OutDeferred)
+{
+    if (!Asset)
+    {
+        return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Failed);
+    }
+
+    // Skip Texture2D assets
+    if (Cast<UTexture2D>(Asset))
+    {
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Skipping Texture2D: %s"), *Asset->GetPathName());
+        return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Skipped);
+    }
+
+    const FString& PackageName = Plan.PackageName;
+    const FString& HashMain = Plan.HashMain;
+    const FString& ZipPath = Plan.ZipPath;
 
     // Dependencies
     TArray<FString> DepPackages;
@@ -3383,108 +8762,20 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
     }
 
     // Hashes
-    FString MainFileAbs;
-    AssetSnapshot::PackageToMainFileAbs(PackageName, MainFileAbs);
-
-    FString HashMain;
     FString HashMainSha256;
-    if (!AssetSnapshot::Blake3HashFile(MainFileAbs, HashMain))
-    {
-        UE_LOG(LogAssetSnapshot, Error, TEXT("Failed to hash main file: %s"), *MainFileAbs);
-        return false;
-    }
-    if (!AssetSnapshot::Sha256HashFile(MainFileAbs, HashMainSha256))
+    if (!AssetSnapshot::Sha256HashFile(Plan.MainFileAbs, HashMainSha256))
     {
         HashMainSha256 = TEXT("");
     }
 
     FString HashFull;
     AssetSnapshot::Blake3HashFiles(FilesAbsSorted, FilesRelSorted, HashFull);
+    OutResult.HashMain = HashMain;
+    OutResult.HashFull = HashFull;
+    OutResult.ZipPath = ZipPath;
 
-    if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
-    {
-        static int32 LastBatchId = -1;
-        static bool CachedUseServerCheck = false;
-        static bool CachedServerSettingKnown = false;
-
-        if (LastBatchId != GAssetSnapshotExportBatchId)
-        {
-            const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(Settings->ImportBaseUrl);
-            CachedServerSettingKnown = Server.bAvailable;
-            CachedUseServerCheck = Server.bAvailable ? Server.bSkipExportIfOnServer : false;
-            LastBatchId = GAssetSnapshotExportBatchId;
-
-            if (!Server.bAvailable && !Settings->ImportBaseUrl.IsEmpty() && !GAssetSnapshotServerWarned)
-            {
-                UE_LOG(LogAssetSnapshot, Warning, TEXT("Export server check disabled: server settings unavailable (baseUrl='%s')"), *Settings->ImportBaseUrl);
-                GAssetSnapshotServerWarned = true;
-            }
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Export server check: use=%s (serverSetting=%s baseUrl='%s')"),
-                CachedUseServerCheck ? TEXT("true") : TEXT("false"),
-                Server.bAvailable ? (Server.bSkipExportIfOnServer ? TEXT("true") : TEXT("false")) : TEXT("unavailable"),
-                *Settings->ImportBaseUrl);
-        }
-
-        if (CachedUseServerCheck && !Settings->ImportBaseUrl.IsEmpty())
-        {
-            bool bExists = false;
-            const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(Settings->ImportBaseUrl);
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Checking server for hash %s"), *HashMain);
-            if (AssetSnapshot::CheckServerHasHash(Settings->ImportBaseUrl, Server.ExportCheckPathTemplate, HashMain, bExists) && bExists)
-            {
-                UE_LOG(LogAssetSnapshot, Log, TEXT("Server already has hash %s, skipping export."), *HashMain);
-                return false;
-            }
-        }
-        else if (!Settings->ImportBaseUrl.IsEmpty())
-        {
-            bool bExists = false;
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Checking server (fallback) for hash %s"), *HashMain);
-            if (AssetSnapshot::CheckServerHasHash(Settings->ImportBaseUrl, TEXT("/assets/exists?hash={hash}&hash_type=blake3"), HashMain, bExists) && bExists)
-            {
-                UE_LOG(LogAssetSnapshot, Log, TEXT("Server already has hash %s, skipping export."), *HashMain);
-                return false;
-            }
-        }
-    }
-
-    // Export target path (skip if already exported)
-    const auto GetExportSubdirFromGamePackage = [](const FString& GamePackageName) -> FString
-    {
-        // "/Game/<Top>/..." -> "<Top>"
-        FString Tail = GamePackageName;
-        Tail.RemoveFromStart(TEXT("/Game/"));
-
-        TArray<FString> Parts;
-        Tail.ParseIntoArray(Parts, TEXT("/"), true);
-        if (Parts.Num() == 0)
-        {
-            return Tail;
-        }
-
-        // If you keep vendor namespaces like /Game/byHans1/<Pack>/..., export under <Pack>.
-        if (Parts[0].Equals(TEXT("byHans1"), ESearchCase::IgnoreCase) && Parts.Num() > 1)
-        {
-            return Parts[1];
-        }
-
-        return Parts[0];
-    };
-
-    const FString ExportSubdir = GetExportSubdirFromGamePackage(PackageName);
-    const FString ExportRoot = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() / TEXT("export") / ExportSubdir);
-    const FString ZipPath = ExportRoot / (HashMain + TEXT(".zip"));
-
-    if (IFileManager::Get().FileExists(*ZipPath))
+    if (Plan.bReplaceZip)
     {
-        const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>();
-        const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(Settings ? Settings->ImportBaseUrl : FString());
-        const bool bOverwrite = Server.bOverwriteExportZips;
-        if (!bOverwrite)
-        {
-            UE_LOG(LogAssetSnapshot, Log, TEXT("Zip already exists, skipping: %s"), *ZipPath);
-            return false;
-        }
         IFileManager::Get().Delete(*ZipPath, false, true, true);
     }
 
@@ -3499,12 +8790,6 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
     float CamDistance = 0.f;
     FString AssetType = Asset->GetClass()->GetName();
 
-    // Skip Texture2D assets
-    if (Cast<UTexture2D>(Asset))
-    {
-        UE_LOG(LogAssetSnapshot, Log, TEXT("Skipping Texture2D: %s"), *Asset->GetPathName());
-        return false;
-    }
 
     // Stats + capture
     TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
@@ -3561,8 +8846,19 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
 
     TArray<TSharedPtr<FJsonValue>> PreviewFiles;
 
+    const bool bCapture = !Plan.bMetadataOnly;
+    AssetSnapshot::FScopedCaptureRig CaptureRig;
+    AssetSnapshot::GCaptureWaitSeconds = 0.0;
+    AssetSnapshot::GCaptureWaitTimedOut = false;
+    AssetSnapshot::GCaptureDuplicateFrames = 0;
+    AssetSnapshot::GCaptureFrameStats.Reset();
+    AssetSnapshot::GCaptureAtlasGrid = 0;
+    AssetSnapshot::GCaptureViaDynamicInstance = false;
+#if WITH_EDITOR
+    // Bounds and stats need the built mesh; only this asset's build is awaited.
+    AssetSnapshot::FinishMeshCompilation(Asset);
+#endif
     bool bCaptured = false;
-    bool bNoPic = false;
     bool bLowQuality = false;
 
     if (UStaticMesh* SM = Cast<UStaticMesh>(Asset))
@@ -3572,14 +8868,10 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
 
         // Multi-frame for animated materials on mesh
         TArray<AssetSnapshot::FZipEntry> Frames;
-        bCaptured = AssetSnapshot::CaptureStaticMeshMultiFrame(SM, Resolution, Frames, CamDistance);
+        bCaptured = bCapture && AssetSnapshot::CaptureStaticMeshMultiFrame(SM, Resolution, Frames, CamDistance);
         if (bCaptured)
         {
-            for (AssetSnapshot::FZipEntry& F : Frames)
-            {
-                PreviewFiles.Add(MakeShared<FJsonValueString>(F.NameInZip));
-                ZipEntries.Add(MoveTemp(F));
-            }
+            AssetSnapshot::AddCapturedFrames(Frames, AssetSnapshot::kCapture360FrameInterval, PreviewFiles, ZipEntries, Root);
         }
     }
     else if (USkeletalMesh* SK = Cast<USkeletalMesh>(Asset))
@@ -3589,63 +8881,64 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
 
         // Multi-frame for animated materials on mesh
         TArray<AssetSnapshot::FZipEntry> Frames;
-        bCaptured = AssetSnapshot::CaptureSkeletalMeshMultiFrame(SK, Resolution, Frames, CamDistance);
+        bCaptured = bCapture && AssetSnapshot::CaptureSkeletalMeshMultiFrame(SK, Resolution, Frames, CamDistance);
         if (bCaptured)
         {
-            for (AssetSnapshot::FZipEntry& F : Frames)
-            {
-                PreviewFiles.Add(MakeShared<FJsonValueString>(F.NameInZip));
-                ZipEntries.Add(MoveTemp(F));
-            }
+            AssetSnapshot::AddCapturedFrames(Frames, AssetSnapshot::kCapture360FrameInterval, PreviewFiles, ZipEntries, Root);
         }
     }
     else if (UMaterialInterface* Mat = Cast<UMaterialInterface>(Asset))
     {
         Resolution = AssetSnapshot::kTexturePreviewResolution;
+        Root->SetBoolField(TEXT("material_time_dependent"), AssetSnapshot::IsMaterialTimeDependent(Mat));
 
         // Single multi-frame capture for animated materials.
         TArray<AssetSnapshot::FZipEntry> Frames;
-        if (AssetSnapshot::GMaterialCaptureContext)
+        if (bCapture && AssetSnapshot::GMaterialCaptureContext)
         {
             bCaptured = AssetSnapshot::CaptureMaterialOnSharedSphereMultiFrame(*AssetSnapshot::GMaterialCaptureContext, Mat, Resolution, Frames, CamDistance, bLowQuality);
         }
-        else
+        else if (bCapture)
         {
             bCaptured = AssetSnapshot::CaptureMaterialOnSphereMultiFrame(Mat, Resolution, Frames, CamDistance, bLowQuality);
         }
         if (bCaptured)
         {
-            for (AssetSnapshot::FZipEntry& F : Frames)
-            {
-                PreviewFiles.Add(MakeShared<FJsonValueString>(F.NameInZip));
-                ZipEntries.Add(MoveTemp(F));
-            }
+            AssetSnapshot::AddCapturedFrames(Frames, AssetSnapshot::kCaptureMaterialFrameInterval, PreviewFiles, ZipEntries, Root);
+        }
+        if (AssetSnapshot::GCaptureAtlasGrid > 0)
+        {
+            Root->SetNumberField(TEXT("material_atlas_grid"), (double)AssetSnapshot::GCaptureAtlasGrid);
+        }
+        if (AssetSnapshot::GCaptureViaDynamicInstance)
+        {
+            Root->SetBoolField(TEXT("material_dynamic_instance"), true);
         }
     }
     else if (UBlueprint* BP = Cast<UBlueprint>(Asset))
     {
         Root->SetStringField(TEXT("class"), TEXT("Blueprint"));
         TArray<AssetSnapshot::FZipEntry> Frames;
-        bCaptured = AssetSnapshot::CaptureBlueprintMultiFrame(BP, Resolution, Frames, CamDistance);
+        bCaptured = bCapture && AssetSnapshot::CaptureBlueprintMultiFrame(BP, Resolution, Frames, CamDistance);
         if (bCaptured)
         {
-            for (AssetSnapshot::FZipEntry& F : Frames)
-            {
-                PreviewFiles.Add(MakeShared<FJsonValueString>(F.NameInZip));
-                ZipEntries.Add(MoveTemp(F));
-            }
+            AssetSnapshot::AddCapturedFrames(Frames, AssetSnapshot::kCapture360FrameInterval, PreviewFiles, ZipEntries, Root);
         }
-        else
+        else if (bCapture)
         {
             TArray<uint8> WebP;
-            bCaptured = AssetSnapshot::CaptureBlueprint(BP, Resolution, WebP, CamDistance);
+            TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe> Pixels;
+            FIntRect Crop;
+            bCaptured = AssetSnapshot::CaptureBlueprint(BP, Resolution, WebP, CamDistance, AssetSnapshot::ShouldKeepFramePixels() ? &Pixels : nullptr, &Crop);
             if (bCaptured)
             {
-                AssetSnapshot::FZipEntry E;
+                AssetSnapshot::FZipEntry& E = Frames.AddDefaulted_GetRef();
                 E.NameInZip = TEXT("0.webp");
                 E.Data = MoveTemp(WebP);
-                PreviewFiles.Add(MakeShared<FJsonValueString>(E.NameInZip));
-                ZipEntries.Add(MoveTemp(E));
+                E.CropRect = Crop;
+                E.SourcePixels = Pixels;
+                E.SourceResolution = Resolution;
+                AssetSnapshot::AddCapturedFrames(Frames, AssetSnapshot::kCapture360FrameInterval, PreviewFiles, ZipEntries, Root);
             }
         }
     }
@@ -3655,14 +8948,19 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
         Root->SetStringField(TEXT("class"), TEXT("NiagaraSystem"));
 
         TArray<uint8> WebP;
-        bCaptured = AssetSnapshot::CaptureNiagara(Sys, Resolution, WebP, CamDistance);
+        TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe> Pixels;
+        FIntRect Crop;
+        bCaptured = bCapture && AssetSnapshot::CaptureNiagara(Sys, Resolution, WebP, CamDistance, AssetSnapshot::ShouldKeepFramePixels() ? &Pixels : nullptr, &Crop);
         if (bCaptured)
         {
-            AssetSnapshot::FZipEntry E;
+            TArray<AssetSnapshot::FZipEntry> Frames;
+            AssetSnapshot::FZipEntry& E = Frames.AddDefaulted_GetRef();
             E.NameInZip = TEXT("0.webp");
             E.Data = MoveTemp(WebP);
-            PreviewFiles.Add(MakeShared<FJsonValueString>(E.NameInZip));
-            ZipEntries.Add(MoveTemp(E));
+            E.CropRect = Crop;
+            E.SourcePixels = Pixels;
+            E.SourceResolution = Resolution;
+            AssetSnapshot::AddCapturedFrames(Frames, AssetSnapshot::kCapture360FrameInterval, PreviewFiles, ZipEntries, Root);
         }
     }
 #endif
@@ -3672,8 +8970,8 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
         float AnimLen = 0.f;
         float AnimLenAttempt = 0.f;
         TArray<AssetSnapshot::FZipEntry> Frames;
-        bCaptured = AssetSnapshot::CaptureAnimSequence(Anim, Resolution, Frames, CamDistance, AnimLenAttempt);
-        AnimLen = AnimLenAttempt;
+        bCaptured = bCapture && AssetSnapshot::CaptureAnimSequence(Anim, Resolution, Frames, CamDistance, AnimLenAttempt);
+        AnimLen = bCapture ? AnimLenAttempt : Anim->GetPlayLength();
         if (bCaptured)
         {
             // Frame metadata for downstream vision / analysis
@@ -3681,7 +8979,7 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
             TArray<TSharedPtr<FJsonValue>> FrameMeta;
 
             const int32 N = Frames.Num();
-            for (AssetSnapshot::FZipEntry& F : Frames)
+            for (const AssetSnapshot::FZipEntry& F : Frames)
             {
                 const int32 FrameIdx = FrameMeta.Num();
                 const double T = (N <= 1 || AnimLen <= 0.f) ? 0.0 : (double)FrameIdx / (double)(N - 1) * (double)AnimLen;
@@ -3690,9 +8988,18 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
                 FrameObj->SetNumberField(TEXT("time_seconds"), T);
                 FrameObj->SetStringField(TEXT("file"), F.NameInZip);
                 FrameMeta.Add(MakeShared<FJsonValueObject>(FrameObj));
+            }
 
-                PreviewFiles.Add(MakeShared<FJsonValueString>(F.NameInZip));
-                ZipEntries.Add(MoveTemp(F));
+            // Animated playback runs at the sampling step of the clip.
+            const float FrameInterval = (N <= 1 || AnimLen <= 0.f) ? 0.1f : AnimLen / (float)(N - 1);
+            AssetSnapshot::AddCapturedFrames(Frames, FrameInterval, PreviewFiles, ZipEntries, Root);
+            if (Root->HasField(TEXT("preview_animated")))
+            {
+                // Only the poster is kept as a still; later frames live in anim.webp.
+                for (int32 FrameIdx = 1; FrameIdx < FrameMeta.Num(); ++FrameIdx)
+                {
+                    FrameMeta[FrameIdx]->AsObject()->SetStringField(TEXT("file"), Root->GetStringField(TEXT("preview_animated")));
+                }
             }
 
             Root->SetArrayField(TEXT("frames"), FrameMeta);
@@ -3704,19 +9011,69 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
         UE_LOG(LogAssetSnapshot, Warning, TEXT("Unsupported asset type for capture: %s (%s)"), *Asset->GetPathName(), *AssetType);
     }
 
-    if (!bCaptured || PreviewFiles.Num() == 0)
+    if (!bCapture)
     {
-        bNoPic = true;
-        AddBlackPreview(PreviewFiles, ZipEntries, AssetSnapshot::kTexturePreviewResolution);
+        // Metadata-only (farm / -nullrhi): hashes, stats and file list, nothing rendered.
+        Root->SetBoolField(TEXT("metadata_only"), true);
+        const FString MetaOnlyStr = AssetSnapshot::SerializeJson(Root);
+        if (!FFileHelper::SaveStringToFile(MetaOnlyStr, *ZipPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+        {
+            UE_LOG(LogAssetSnapshot, Error, TEXT("Failed to write meta: %s"), *ZipPath);
+            return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Failed);
+        }
+        UE_LOG(LogAssetSnapshot, Log, TEXT("Wrote: %s"), *ZipPath);
+        return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Exported);
     }
 
-    Root->SetArrayField(TEXT("preview_files"), PreviewFiles);
-    Root->SetNumberField(TEXT("no_pic"), bNoPic ? 1.0 : 0.0);
     Root->SetNumberField(TEXT("low_quality"), bLowQuality ? 1.0 : 0.0);
+    Root->SetNumberField(TEXT("capture_wait_seconds"), AssetSnapshot::GCaptureWaitSeconds);
+    Root->SetBoolField(TEXT("capture_wait_timed_out"), AssetSnapshot::GCaptureWaitTimedOut);
+    Root->SetNumberField(TEXT("duplicate_frames"), (double)AssetSnapshot::GCaptureDuplicateFrames);
+    if (AssetSnapshot::GCaptureFrameStats.Num() > 0)
+    {
+        Root->SetArrayField(TEXT("frame_stats"), AssetSnapshot::GCaptureFrameStats);
+    }
+    Root->SetStringField(TEXT("webp_preset"), AssetSnapshot::GetWebPEncodeOptions().PresetName);
     Root->SetNumberField(TEXT("capture_resolution"), (double)Resolution);
     Root->SetNumberField(TEXT("capture_fov"), (double)AssetSnapshot::kDefaultFov);
     Root->SetNumberField(TEXT("capture_distance"), (double)CamDistance);
 
+    // Everything past this point waits for the encodes; see FPendingAssetWrite.
+    AssetSnapshot::FPendingAssetWrite Write;
+    Write.Root = Root;
+    Write.PreviewFiles = MoveTemp(PreviewFiles);
+    Write.ZipEntries = MoveTemp(ZipEntries);
+    Write.ZipPath = ZipPath;
+    Write.HashMain = HashMain;
+    Write.UploadEventBody = AssetSnapshot::BuildUploadEventBody(Asset->GetName());
+    Write.UploadResolvePath = AssetSnapshot::GetUploadResolvePath(Asset);
+    Write.bCaptured = bCaptured;
+    if (OutDeferred)
+    {
+        *OutDeferred = MoveTemp(Write);
+        return true;
+    }
+    return AssetSnapshot::FinishAssetWrite(Write, OutResult);
+}
+
+bool AssetSnapshot::FinishAssetWrite(AssetSnapshot::FPendingAssetWrite& Write, AssetSnapshot::FAssetExportResult& OutResult)
+{
+    const TSharedRef<FJsonObject> Root = Write.Root.ToSharedRef();
+    TArray<TSharedPtr<FJsonValue>>& PreviewFiles = Write.PreviewFiles;
+    TArray<AssetSnapshot::FZipEntry>& ZipEntries = Write.ZipEntries;
+    const FString& ZipPath = Write.ZipPath;
+
+    // Failed encodes are dropped here; with nothing left the asset falls back to no_pic.
+    AssetSnapshot::DropFailedPreviews(ZipEntries, PreviewFiles, Root);
+    const bool bNoPic = !Write.bCaptured || PreviewFiles.Num() == 0;
+    if (bNoPic)
+    {
+        AddBlackPreview(PreviewFiles, ZipEntries, AssetSnapshot::kTexturePreviewResolution);
+    }
+
+    Root->SetArrayField(TEXT("preview_files"), PreviewFiles);
+    Root->SetNumberField(TEXT("no_pic"), bNoPic ? 1.0 : 0.0);
+
     const FString MetaStr = AssetSnapshot::SerializeJson(Root);
 
     AssetSnapshot::FZipEntry Meta;
@@ -3728,9 +9085,11 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
 
     // Write zip
     const bool bZipOk = AssetSnapshot::WriteZipStore(ZipPath, ZipEntries);
+    ZipEntries.Empty();
     if (!bZipOk)
     {
-        return false;
+        Write = AssetSnapshot::FPendingAssetWrite();
+        return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Failed);
     }
 
     if (const UAssetSnapshotSettings* Settings = GetDefault<UAssetSnapshotSettings>())
@@ -3738,68 +9097,77 @@ bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
         const AssetSnapshot::FServerSettingsCache& Server = AssetSnapshot::GetServerSettingsCached(Settings->ImportBaseUrl);
         if (Server.bUploadAfterExport && !Settings->ImportBaseUrl.IsEmpty())
         {
-            static FString CachedProjectPath;
-            static int32 CachedProjectId = 0;
-            const FString AssetName = Asset ? Asset->GetName() : TEXT("asset");
+            // Journal the upload; the outbox sender delivers it (now or after an outage).
+            AssetSnapshot::FOutboxEntry Upload;
+            Upload.Key = TEXT("upload:") + Write.HashMain;
+            Upload.Kind = AssetSnapshot::EOutboxKind::Upload;
+            Upload.Hash = Write.HashMain;
+            Upload.BaseUrl = Settings->ImportBaseUrl;
+            Upload.ZipPath = ZipPath;
+            Upload.ResolvePath = Write.UploadResolvePath;
+            Upload.UploadPathTemplate = Server.ExportUploadPathTemplate;
+            Upload.EventBody = Write.UploadEventBody;
+            AssetSnapshot::EnqueueOutbox(MoveTemp(Upload));
+            AssetSnapshot::PumpOutbox();
+        }
+    }
 
-            FString ResolvePath = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
-            if (Asset)
-            {
-                const FString AssetPackageName = Asset->GetOutermost() ? Asset->GetOutermost()->GetName() : FString();
-                const FString PackagePath = FPackageName::GetLongPackagePath(AssetPackageName);
-                if (PackagePath.StartsWith(TEXT("/Game/")))
-                {
-                    const FString RelativePath = PackagePath.Mid(6);
-                    FString TopFolder;
-                    FString Remainder;
-                    if (RelativePath.Split(TEXT("/"), &TopFolder, &Remainder))
-                    {
-                        if (!TopFolder.IsEmpty())
-                        {
-                            ResolvePath = FPaths::ConvertRelativePathToFull(
-                                FPaths::Combine(FPaths::ProjectContentDir(), TopFolder));
-                        }
-                    }
-                    else if (!RelativePath.IsEmpty())
-                    {
-                        ResolvePath = FPaths::ConvertRelativePathToFull(
-                            FPaths::Combine(FPaths::ProjectContentDir(), RelativePath));
-                    }
-                }
-            }
+    UE_LOG(LogAssetSnapshot, Log, TEXT("Wrote: %s"), *ZipPath);
+    Write = AssetSnapshot::FPendingAssetWrite();
+    return OutResult.Finish(AssetSnapshot::EAssetExportStatus::Exported);
+}
 
-            if (CachedProjectPath != ResolvePath)
-            {
-                CachedProjectId = 0;
-                AssetSnapshot::ResolveProjectIdFromServer(Settings->ImportBaseUrl, ResolvePath, CachedProjectId);
-                CachedProjectPath = ResolvePath;
-            }
+int32 UAssetSnapshotBPLibrary::RunExportWorkerNative(const FString& CoordinatorUrl, FAssetSnapshotExportSummary* OutSummary)
+{
+    FAssetSnapshotExportSummary LocalSummary;
+    FAssetSnapshotExportSummary& Summary = OutSummary ? *OutSummary : LocalSummary;
+    Summary = FAssetSnapshotExportSummary();
 
-                if (CachedProjectId > 0)
-                {
-                    const bool bUploaded = AssetSnapshot::UploadZipToServer(
-                        Settings->ImportBaseUrl,
-                        Server.ExportUploadPathTemplate,
-                        ZipPath,
-                        CachedProjectId);
-                    if (!bUploaded)
-                    {
-                        UE_LOG(LogAssetSnapshot, Warning, TEXT("Export upload failed for %s"), *ZipPath);
-                    }
-                    else
-                    {
-                        AssetSnapshot::SendUploadEvent(Settings->ImportBaseUrl, AssetName);
-                    }
-                }
-            else
-            {
-                UE_LOG(LogAssetSnapshot, Warning, TEXT("Export upload skipped: project id not resolved."));
-            }
-        }
+    if (CoordinatorUrl.TrimStartAndEnd().IsEmpty())
+    {
+        UE_LOG(LogAssetSnapshot, Error, TEXT("RunExportWorker: empty coordinator url"));
+        return 0;
     }
 
-    UE_LOG(LogAssetSnapshot, Log, TEXT("Wrote: %s"), *ZipPath);
-    return true;
+    ++GAssetSnapshotExportBatchId;
+    GAssetSnapshotServerBatchId = GAssetSnapshotExportBatchId;
+    GAssetSnapshotServerChecked = false;
+    GAssetSnapshotServerAvailable = true;
+    GAssetSnapshotServerWarned = false;
+    GAssetSnapshotServerSkipKnown = false;
+    GAssetSnapshotServerSkipEnabled = true;
+    AssetSnapshot::ResetBackendBreaker();
+
+    const int32 Exported = AssetSnapshot::RunExportWorker(CoordinatorUrl.TrimStartAndEnd(), Summary);
+
+    const int32 OutboxPending = AssetSnapshot::DrainOutbox(AssetSnapshot::kOutboxBatchDrainSeconds);
+    if (OutboxPending > 0)
+    {
+        UE_LOG(LogAssetSnapshot, Warning, TEXT("Upload outbox: %d entr(ies) still pending; they will be sent when the server is reachable."), OutboxPending);
+    }
+    return Exported;
+}
+
+bool UAssetSnapshotBPLibrary::IsWorkCoordinatorRunning()
+{
+    return AssetSnapshot::GWorkCoordinator.IsValid();
+}
+
+int32 UAssetSnapshotBPLibrary::MergeShardManifests(const FString& BatchKey)
+{
+    return AssetSnapshot::MergeShardManifests(BatchKey.TrimStartAndEnd());
+}
+
+int32 UAssetSnapshotBPLibrary::PumpUploadOutbox()
+{
+    AssetSnapshot::PumpOutbox();
+    return AssetSnapshot::GUploadOutbox.Pending.Num();
+}
+
+bool UAssetSnapshotBPLibrary::ExportAssetBuild(UObject* Asset)
+{
+    AssetSnapshot::FAssetExportResult Result;
+    return AssetSnapshot::ExportAssetBuildWithResult(Asset, Result);
 }
 
 bool UAssetSnapshotBPLibrary::ImportSnapshotZip(const FString& ZipPath, EAssetSnapshotImportMode Mode, FString& OutError)
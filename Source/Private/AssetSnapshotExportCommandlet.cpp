@@ -0,0 +1,132 @@
+#include "AssetSnapshotExportCommandlet.h"
+
+#include "AssetSnapshotBPLibrary.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/App.h"
+#include "Misc/Parse.h"
+#include "Modules/ModuleManager.h"
+#include "RHI.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAssetSnapshotCommandlet, Log, All);
+
+UAssetSnapshotExportCommandlet::UAssetSnapshotExportCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+    ShowErrorCount = true;
+}
+
+int32 UAssetSnapshotExportCommandlet::Main(const FString& Params)
+{
+    const TCHAR* Cmd = *Params;
+
+    // -merge[=BatchKey]: combine shard manifests written by earlier -shard runs.
+    FString MergeKey;
+    if (FParse::Value(Cmd, TEXT("-merge="), MergeKey) || FParse::Param(Cmd, TEXT("merge")))
+    {
+        const int32 Merged = UAssetSnapshotBPLibrary::MergeShardManifests(MergeKey);
+        UE_LOG(LogAssetSnapshotCommandlet, Display, TEXT("AssetSnapshotExport: merged %d manifest(s)"), Merged);
+        return Merged > 0 ? 0 : 1;
+    }
+
+    // -worker=http://host:port: pull assets from a coordinator until its queue is done.
+    FString CoordinatorUrl;
+    if (FParse::Value(Cmd, TEXT("-worker="), CoordinatorUrl))
+    {
+        if (!FApp::CanEverRender() || GUsingNullRHI)
+        {
+            // The coordinator decides the mode; a worker that cannot render would fail every capture.
+            UE_LOG(LogAssetSnapshotCommandlet, Warning, TEXT("Worker without rendering (-nullrhi or no -AllowCommandletRendering); captures will fail unless the coordinator runs -metadata."));
+        }
+        IAssetRegistry& AR = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+        AR.SearchAllAssets(true);
+
+        FAssetSnapshotExportSummary Summary;
+        const int32 Exported = UAssetSnapshotBPLibrary::RunExportWorkerNative(CoordinatorUrl, &Summary);
+        UE_LOG(LogAssetSnapshotCommandlet, Display, TEXT("AssetSnapshotExport: worker=%s processed=%d exported=%d skipped=%d failed=%d"),
+            *CoordinatorUrl, Summary.Total, Exported, Summary.Skipped, Summary.Failed);
+        return Summary.Failed > 0 ? 1 : 0;
+    }
+
+    FString Path;
+    FString TypeFilter;
+    FString ExcludeFilter;
+    FParse::Value(Cmd, TEXT("-path="), Path);
+    FParse::Value(Cmd, TEXT("-type="), TypeFilter, false);
+    FParse::Value(Cmd, TEXT("-exclude="), ExcludeFilter, false);
+
+    if (Path.IsEmpty())
+    {
+        UE_LOG(LogAssetSnapshotCommandlet, Error, TEXT("Usage: -run=AssetSnapshotExport -path=/Game/Folder [-type=mesh,material] [-exclude=material] [-resume] [-shard=i/N] [-metadata] [-nullrhi] [-coordinator[=Port]] | -worker=http://host:port | -merge[=BatchKey]"));
+        return 2;
+    }
+
+    FAssetSnapshotExportOptions Options;
+    Options.bResume = FParse::Param(Cmd, TEXT("resume"));
+    Options.bMetadataOnly = FParse::Param(Cmd, TEXT("metadata"));
+    Options.bCoordinator = FParse::Value(Cmd, TEXT("-coordinator="), Options.CoordinatorPort) || FParse::Param(Cmd, TEXT("coordinator"));
+    FString ShardSpec;
+    if (FParse::Value(Cmd, TEXT("-shard="), ShardSpec) && !Options.SetShardFromString(ShardSpec))
+    {
+        UE_LOG(LogAssetSnapshotCommandlet, Error, TEXT("Invalid -shard=%s (expected i/N with 0 <= i < N)."), *ShardSpec);
+        return 2;
+    }
+    // Capturing in a commandlet needs -AllowCommandletRendering and a real RHI.
+    // A coordinator does not capture itself; its workers need the rendering.
+    if (!Options.bMetadataOnly && !Options.bCoordinator && (!FApp::CanEverRender() || GUsingNullRHI))
+    {
+        UE_LOG(LogAssetSnapshotCommandlet, Display, TEXT("No rendering available (-nullrhi or no -AllowCommandletRendering); switching to metadata-only export."));
+        Options.bMetadataOnly = true;
+    }
+
+    // Commandlets start before the registry scan is done; the export resolves assets through it.
+    IAssetRegistry& AR = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+    AR.SearchAllAssets(true);
+
+    FAssetSnapshotExportSummary Summary;
+    if (Options.bCoordinator)
+    {
+        Options.OnCoordinatorFinished = [&Summary](const FAssetSnapshotExportSummary& Final)
+        {
+            Summary = Final;
+        };
+    }
+    UAssetSnapshotBPLibrary::ExportPathBuildsNative(Path, TypeFilter, ExcludeFilter, Options, &Summary);
+
+    // The coordinator serves its queue from the core ticker; a commandlet has no engine loop to run it.
+    double LastTickSec = FPlatformTime::Seconds();
+    while (UAssetSnapshotBPLibrary::IsWorkCoordinatorRunning() && !IsEngineExitRequested())
+    {
+        const double NowSec = FPlatformTime::Seconds();
+        FTSTicker::GetCoreTicker().Tick((float)(NowSec - LastTickSec));
+        LastTickSec = NowSec;
+        FPlatformProcess::Sleep(0.01f);
+    }
+
+    UE_LOG(LogAssetSnapshotCommandlet, Display, TEXT("AssetSnapshotExport: path=%s mode=%s%s shard=%d/%d total=%d exported=%d skipped=%d failed=%d resumed=%d journal=%s manifest=%s"),
+        *Path,
+        Options.bMetadataOnly ? TEXT("metadata") : TEXT("full"),
+        Options.bCoordinator ? TEXT(" (coordinator)") : TEXT(""),
+        Options.ShardIndex,
+        Options.ShardCount,
+        Summary.Total,
+        Summary.Exported,
+        Summary.Skipped,
+        Summary.Failed,
+        Summary.Resumed,
+        *Summary.JournalPath,
+        *Summary.ManifestPath);
+
+    // No manifest means the batch never started (bad path, nothing matched the filters).
+    // An empty shard of a valid batch still writes one.
+    if (Summary.ManifestPath.IsEmpty())
+    {
+        return 2;
+    }
+    return Summary.Failed > 0 ? 1 : 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Containers/Ticker.h"
 #include "HttpRouteHandle.h"
 #include "Modules/ModuleManager.h"
 
@@ -18,4 +19,5 @@ private:
     bool bImportRouteRegistered = false;
     bool bImportOptionsRouteRegistered = false;
     bool bSelectRouteRegistered = false;
+    FTSTicker::FDelegateHandle OutboxTickerHandle;
 };
@@ -7,6 +7,80 @@
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FAssetSnapshotImportResult, bool, bSuccess, const FString&, ErrorMessage);
 DECLARE_DELEGATE_TwoParams(FAssetSnapshotImportResultNative, bool, const FString&);
 
+struct FAssetSnapshotExportSummary;
+
+/** Native-only options for batch exports (console/commandlet entry points). */
+struct FAssetSnapshotExportOptions
+{
+    /**
+     * Continue an interrupted batch: assets already recorded in
+     * <export>/_journal/<batch>.jsonl are skipped without loading them.
+     */
+    bool bResume = false;
+
+    /**
+     * Skip preview capture and write <hash>.meta.json (hashes, stats, file list)
+     * instead of a zip. No upload. Usable without an RHI (-nullrhi).
+     */
+    bool bMetadataOnly = false;
+
+    /** Static shard of the sorted asset list (--shard=i/N). ShardCount 1 exports everything. */
+    int32 ShardIndex = 0;
+    int32 ShardCount = 1;
+
+    /**
+     * Serve the batch as a work queue (POST /work/next, /work/result, /work/heartbeat)
+     * instead of capturing locally; workers started with RunExportWorkerNative pull
+     * assets until the queue is empty. Journal and manifest are written here.
+     */
+    bool bCoordinator = false;
+
+    /** Listen port of the work queue. 0 uses the import listener port from the settings. */
+    int32 CoordinatorPort = 0;
+
+    /**
+     * Coordinator only: the queue is served from the core ticker after ExportPathBuildsNative
+     * returns. Called on the game thread with the final counters and manifest once it is done.
+     */
+    TFunction<void(const FAssetSnapshotExportSummary&)> OnCoordinatorFinished;
+
+    /** Parses "i/N" (0 <= i < N). Returns false and leaves the shard unchanged on bad input. */
+    bool SetShardFromString(const FString& Spec)
+    {
+        FString IndexStr;
+        FString CountStr;
+        if (!Spec.Split(TEXT("/"), &IndexStr, &CountStr) || !IndexStr.IsNumeric() || !CountStr.IsNumeric())
+        {
+            return false;
+        }
+        const int32 Index = FCString::Atoi(*IndexStr);
+        const int32 Count = FCString::Atoi(*CountStr);
+        if (Count < 1 || Index < 0 || Index >= Count)
+        {
+            return false;
+        }
+        ShardIndex = Index;
+        ShardCount = Count;
+        return true;
+    }
+};
+
+/** Native-only result counters of a batch export. */
+struct FAssetSnapshotExportSummary
+{
+    int32 Total = 0;
+    int32 Exported = 0;
+    int32 Skipped = 0;
+    int32 Failed = 0;
+    /** Assets taken over from the journal of a previous run (--resume). */
+    int32 Resumed = 0;
+    FString JournalPath;
+    /** Key shared by all shards of the same batch (path + filters + mode). */
+    FString BatchKey;
+    /** <export>/_manifests/<BatchKey>[.shard-i-of-N].json */
+    FString ManifestPath;
+};
+
 UCLASS()
 class ASSETMETAEXPLORERBRIDGE_API UAssetSnapshotBPLibrary : public UBlueprintFunctionLibrary
 {
@@ -30,10 +104,48 @@ public:
     UFUNCTION(BlueprintCallable, CallInEditor, Category="AssetSnapshot")
     static int32 ExportPathBuilds(const FString& InGamePath, const FString& InTypeFilter = TEXT(""), const FString& InExcludeTypeFilter = TEXT(""));
 
+    /**
+     * Native version for C++ with batch options (resume) and result counters.
+     * With FAssetSnapshotExportOptions::bCoordinator it returns once the queue is listening;
+     * the final summary goes to OnCoordinatorFinished.
+     */
+    static int32 ExportPathBuildsNative(
+        const FString& InGamePath,
+        const FString& InTypeFilter,
+        const FString& InExcludeTypeFilter,
+        const FAssetSnapshotExportOptions& Options,
+        FAssetSnapshotExportSummary* OutSummary = nullptr);
+
+    /**
+     * Pulls assets from a coordinator (http://host:port) started with
+     * FAssetSnapshotExportOptions::bCoordinator and exports them until the queue is done.
+     * Returns: number of exported builds.
+     */
+    static int32 RunExportWorkerNative(const FString& CoordinatorUrl, FAssetSnapshotExportSummary* OutSummary = nullptr);
+
+    /** True while a coordinator started by ExportPathBuildsNative is serving its queue. */
+    static bool IsWorkCoordinatorRunning();
+
+    /**
+     * Combines complete sets of shard manifests (<export>/_manifests/<key>.shard-i-of-N.json)
+     * into <key>.json. Empty BatchKey merges every complete set.
+     * Returns: number of merged manifests written.
+     */
+    UFUNCTION(BlueprintCallable, CallInEditor, Category="AssetSnapshot")
+    static int32 MergeShardManifests(const FString& BatchKey = TEXT(""));
+
     /** Export a single already-loaded asset. Returns true on success. */
     UFUNCTION(BlueprintCallable, CallInEditor, Category="AssetSnapshot")
     static bool ExportAssetBuild(UObject* Asset);
 
+    /**
+     * Starts delivery of pending uploads/events from the on-disk outbox
+     * (<Saved>/AssetSnapshotOutbox/outbox.jsonl). Non-blocking.
+     * Returns: number of entries still pending.
+     */
+    UFUNCTION(BlueprintCallable, CallInEditor, Category="AssetSnapshot")
+    static int32 PumpUploadOutbox();
+
     /** Import all files from a snapshot zip into the project Content directory. */
     UFUNCTION(BlueprintCallable, CallInEditor, Category="AssetSnapshot")
     static bool ImportSnapshotZip(const FString& ZipPath, EAssetSnapshotImportMode Mode, FString& OutError);
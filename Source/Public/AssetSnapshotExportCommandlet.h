@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "AssetSnapshotExportCommandlet.generated.h"
+
+/**
+ * Headless batch export for build/farm nodes.
+ *
+ *   UnrealEditor-Cmd <Project>.uproject -run=AssetSnapshotExport -path=/Game/SomeFolder
+ *       [-type=mesh,material] [-exclude=material] [-resume] [-shard=i/N] [-metadata] [-nullrhi | -AllowCommandletRendering]
+ *   UnrealEditor-Cmd <Project>.uproject -run=AssetSnapshotExport -merge[=BatchKey]
+ *
+ * -metadata (implied when the commandlet cannot render) skips preview capture and writes
+ * <hash>.meta.json files with hashes, stats and file lists.
+ * Returns 0 on success, 1 if any asset failed (or nothing was merged), 2 on bad arguments or when nothing matched.
+ */
+UCLASS()
+class ASSETMETAEXPLORERBRIDGE_API UAssetSnapshotExportCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UAssetSnapshotExportCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -18,4 +18,72 @@ public:
 
     UPROPERTY(EditAnywhere, Config, Category="Import", meta=(ClampMin="1", ClampMax="65535"))
     int32 ImportListenPort = 9090;
+
+    /** Consecutive backend failures (timeouts, connection errors, 5xx) before backend calls are short-circuited for the batch. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="1", ClampMax="100"))
+    int32 BackendFailureThreshold = 3;
+
+    /** Delay before the first probe request once the backend circuit is open. Doubles after every failed probe. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0.1", Units="s"))
+    float BackendProbeBackoffSeconds = 5.0f;
+
+    /** Upper bound for the backend probe delay. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="1.0", Units="s"))
+    float BackendProbeBackoffMaxSeconds = 300.0f;
+
+    /** Capturable assets whose packages are loaded asynchronously ahead of the one being captured (0 disables prefetch). */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0", ClampMax="16"))
+    int32 PrefetchAssetCount = 2;
+
+    /** Upper bound for the on-disk size of packages prefetched but not yet captured. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0", Units="MB"))
+    int32 PrefetchMemoryBudgetMB = 1024;
+
+    /** Resident memory at which batch exports collect garbage and stop prefetching (0 = 75% of physical memory). */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0", Units="MB"))
+    int32 GCMemoryBudgetMB = 0;
+
+    /** Loaded assets after which a batch collects garbage even without memory pressure. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="1", ClampMax="1000"))
+    int32 GCMaxAssetsBetween = 50;
+
+    /** Multi-frame captures read frames back asynchronously while the next one renders. Disable to fall back to one blocking readback per frame. */
+    UPROPERTY(EditAnywhere, Config, Category="Export")
+    bool bPipelinedReadback = true;
+
+    /** Materials of a batch loaded ahead and compiling their shaders at any one time (0 = compile each one when it is captured). */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0"))
+    int32 ShaderPrecompileMaxMaterials = 64;
+
+    /** Batch exports stage up to N x N static, precompiled materials behind one readiness wait and render each from its own camera offset (1 = one capture per material). */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="1", ClampMax="4"))
+    int32 MaterialAtlasGridSize = 1;
+
+    /** Material instances without static permutations are captured through one dynamic instance of their parent, so siblings skip the shader and warmup wait. */
+    UPROPERTY(EditAnywhere, Config, Category="Export")
+    bool bMaterialInstanceFastPath = true;
+
+    /** Pack multi-frame captures into one animated anim.webp (delta-encoded) and keep only frame 0 as a still poster. */
+    UPROPERTY(EditAnywhere, Config, Category="Export")
+    bool bAnimatedPreviews = false;
+
+    /** Extra downscaled copies of every preview frame, written as <frame>_<size>.webp (sizes at or above the capture resolution are skipped). */
+    UPROPERTY(EditAnywhere, Config, Category="Export")
+    TArray<int32> PreviewTierSizes = { 128, 256 };
+
+    /** Turntable and material captures drop frames identical to the previous one and stop after this many in a row (0 = keep every frame). */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0"))
+    int32 DuplicateFrameStopCount = 2;
+
+    /** Encode full-size preview frames cropped to the content bounds (background margins removed); the crop is recorded in meta.json. */
+    UPROPERTY(EditAnywhere, Config, Category="Export")
+    bool bAutoCropPreviews = false;
+
+    /** Margin kept around the content when auto-cropping, in percent of the capture resolution. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(ClampMin="0", ClampMax="50", EditCondition="bAutoCropPreviews"))
+    float AutoCropPaddingPercent = 4.0f;
+
+    /** Widen auto-crops to a square around the content instead of the tight rectangle. */
+    UPROPERTY(EditAnywhere, Config, Category="Export", meta=(EditCondition="bAutoCropPreviews"))
+    bool bAutoCropSquare = false;
 };